@@ -0,0 +1,29 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_BENCH_SRC_BENCH_OPTIONS_H_
+#define NCSTREAMER_REMOTE_BENCH_SRC_BENCH_OPTIONS_H_
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+namespace ncstreamer_remote_bench {
+struct BenchOptions {
+  /// Served by a mock NCStreamer in this process during the benchmarks
+  /// which connect, and the one after it is left unserved.
+  std::uint16_t port;
+
+  std::size_t rounds;
+
+  /// Of the repository, for the headers of the compile benchmark.
+  std::string root;
+};
+}  // namespace ncstreamer_remote_bench
+
+
+#endif  // NCSTREAMER_REMOTE_BENCH_SRC_BENCH_OPTIONS_H_
@@ -0,0 +1,110 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_bench/src/compile_bench.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include "Windows.h"  // NOLINT
+
+#include "ncstreamer_remote_bench/src/samples.h"
+
+
+namespace {
+using ncstreamer_remote_bench::Samples;
+
+
+struct Includer {
+  const char *name;
+
+  /// Empty for none.
+  const char *header;
+};
+
+
+const Includer kIncluders[]{
+  {"empty", ""},
+  {"public", "ncstreamer_remote/ncstreamer_remote.h"},
+  {"pre-pimpl", "ncstreamer_remote_dll/src/ncstreamer_remote_impl.h"},
+};
+
+
+std::string GetEnv(const char *name) {
+  const char *value = std::getenv(name);
+  return value != nullptr ? std::string{value} : std::string{};
+}
+
+
+std::string GetTempDir() {
+  char path[MAX_PATH + 1]{};
+  DWORD length = ::GetTempPathA(MAX_PATH + 1, path);
+  return std::string{path, length};
+}
+
+
+/// @return The path of the source written, or empty on failure.
+std::string WriteSource(const std::string &dir, const Includer &includer) {
+  std::string path{dir + "ncstreamer_remote_bench_" + includer.name + ".cc"};
+  std::ofstream source{path};
+  if (std::string{includer.header}.empty() == false) {
+    source << "#include \"" << includer.header << "\"" << std::endl;
+  }
+  source << "int ncstreamer_remote_bench_includer() { return 0; }"
+         << std::endl;
+  return source.good() == true ? path : std::string{};
+}
+
+
+/// The flags of the projects which include the header.
+std::string ToCommand(
+    const std::string &root,
+    const std::string &dir,
+    const std::string &source_path) {
+  return "cl.exe /nologo /c /EHsc /W3"
+         " /D_WIN32_WINNT=_WIN32_WINNT_WIN7 /DWIN32_LEAN_AND_MEAN"
+         " /D_SCL_SECURE_NO_WARNINGS /D_WINSOCK_DEPRECATED_NO_WARNINGS"
+         " /I\"" + root + "\""
+         " /I\"" + root + "\\ncstreamer_remote_dll\\include\""
+         " /I\"" + GetEnv("BOOST_ROOT") + "\""
+         " /I\"" + GetEnv("WEBSOCKETPP_ROOT") + "\""
+         // dir ends with a backslash; doubled, it keeps the quote closing.
+         " /Fo\"" + dir + "\\\" \"" + source_path + "\" > NUL";
+}
+}  // unnamed namespace
+
+
+namespace ncstreamer_remote_bench {
+bool RunCompileBench(const BenchOptions &options, std::ostream *out) {
+  const std::string &dir = GetTempDir();
+
+  *out << "compile: cl.exe on a translation unit including the header"
+       << std::endl;
+  Samples::WriteHeader(out, "includer");
+  for (const Includer &includer : kIncluders) {
+    const std::string &source_path = WriteSource(dir, includer);
+    if (source_path.empty() == true) {
+      *out << "failed to write a source in " << dir << std::endl;
+      return false;
+    }
+    const std::string &command = ToCommand(options.root, dir, source_path);
+
+    Samples samples{};
+    for (std::size_t r = 0; r < options.rounds; ++r) {
+      std::int64_t begin_ns = Samples::NowNs();
+      int exit_code = std::system(command.c_str());
+      std::int64_t end_ns = Samples::NowNs();
+      if (exit_code != 0) {
+        *out << "failed to compile: " << command << std::endl;
+        return false;
+      }
+      samples.Add(end_ns - begin_ns);
+    }
+    samples.Write(out, includer.name);
+  }
+  return true;
+}
+}  // namespace ncstreamer_remote_bench
@@ -0,0 +1,27 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_BENCH_SRC_COMPILE_BENCH_H_
+#define NCSTREAMER_REMOTE_BENCH_SRC_COMPILE_BENCH_H_
+
+
+#include <ostream>
+
+#include "ncstreamer_remote_bench/src/bench_options.h"
+
+
+namespace ncstreamer_remote_bench {
+/// Times cl.exe compiling a translation unit which includes the public
+/// ncstreamer_remote.h, against an empty one, and against one including
+/// the implementation header, whose dependencies (boost::asio,
+/// property_tree and websocketpp) the public header had before the pimpl.
+/// Run it where cl.exe is on the path, e.g. in a developer command
+/// prompt, with BOOST_ROOT and WEBSOCKETPP_ROOT set as for the build.
+/// @return False if a compilation fails.
+bool RunCompileBench(const BenchOptions &options, std::ostream *out);
+}  // namespace ncstreamer_remote_bench
+
+
+#endif  // NCSTREAMER_REMOTE_BENCH_SRC_COMPILE_BENCH_H_
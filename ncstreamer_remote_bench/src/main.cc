@@ -0,0 +1,95 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "ncstreamer_remote_bench/src/bench_options.h"
+#include "ncstreamer_remote_bench/src/compile_bench.h"
+#include "ncstreamer_remote_bench/src/shutdown_bench.h"
+#include "ncstreamer_remote_bench/src/startup_bench.h"
+
+
+namespace {
+using ncstreamer_remote_bench::BenchOptions;
+
+
+void PrintUsage() {
+  std::cerr
+      << "usage: ncstreamer_remote_bench <benchmark> [options]" << std::endl
+      << "benchmarks:" << std::endl
+      << "  shutdown         latency of Close and of the destruction"
+      << std::endl
+      << "  startup          cost of SetUp and Create to the caller's thread"
+      << std::endl
+      << "  compile          time to compile an includer of the header,"
+      << " with cl.exe" << std::endl
+      << "options:" << std::endl
+      << "  --port=N         port of the mock NCStreamer (9102)"
+      << std::endl
+      << "  --rounds=N       rounds of each measurement (20)" << std::endl
+      << "  --root=PATH      root of the repository, for compile (.)"
+      << std::endl;
+}
+
+
+/// @return False on an unknown option or a bad value.
+bool ParseOption(const std::string &arg, BenchOptions *options) {
+  std::size_t equal = arg.find('=');
+  if (equal == std::string::npos) {
+    return false;
+  }
+  const std::string &key = arg.substr(0, equal);
+  const std::string &value = arg.substr(equal + 1);
+  try {
+    if (key == "--port") {
+      options->port = static_cast<std::uint16_t>(std::stoul(value));
+    } else if (key == "--rounds") {
+      options->rounds = std::stoul(value);
+    } else if (key == "--root") {
+      options->root = value;
+    } else {
+      return false;
+    }
+  } catch (const std::exception &/*e*/) {
+    return false;
+  }
+  return true;
+}
+}  // unnamed namespace
+
+
+int main(int argc, char *argv[]) {
+  BenchOptions options{9102, 20, "."};
+  if (argc < 2) {
+    PrintUsage();
+    return EXIT_FAILURE;
+  }
+  const std::string benchmark{argv[1]};
+  for (int i = 2; i < argc; ++i) {
+    if (ParseOption(argv[i], &options) == false) {
+      PrintUsage();
+      return EXIT_FAILURE;
+    }
+  }
+  if (options.rounds == 0) {
+    PrintUsage();
+    return EXIT_FAILURE;
+  }
+
+  bool succeeded{false};
+  if (benchmark == "shutdown") {
+    succeeded = ncstreamer_remote_bench::RunShutdownBench(options, &std::cout);
+  } else if (benchmark == "startup") {
+    succeeded = ncstreamer_remote_bench::RunStartupBench(options, &std::cout);
+  } else if (benchmark == "compile") {
+    succeeded = ncstreamer_remote_bench::RunCompileBench(options, &std::cout);
+  } else {
+    PrintUsage();
+  }
+  return succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,73 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_bench/src/samples.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iomanip>
+
+#if _MSC_VER >= 1900
+namespace Chrono = std::chrono;
+#else
+#include "boost/chrono/include.hpp"
+namespace Chrono = boost::chrono;
+#endif  // _MSC_VER >= 1900
+
+
+namespace {
+std::int64_t Percentile(
+    const std::vector<std::int64_t> &sorted,
+    std::size_t percent) {
+  if (sorted.empty() == true) {
+    return 0;
+  }
+  return sorted[(sorted.size() - 1) * percent / 100];
+}
+}  // unnamed namespace
+
+
+namespace ncstreamer_remote_bench {
+Samples::Samples()
+    : elapsed_ns_{} {
+}
+
+
+Samples::~Samples() {
+}
+
+
+void Samples::Add(std::int64_t elapsed_ns) {
+  elapsed_ns_.emplace_back(elapsed_ns);
+}
+
+
+void Samples::WriteHeader(std::ostream *out, const char *first_column) {
+  *out << std::left << std::setw(16) << first_column << std::right
+       << std::setw(8) << "rounds"
+       << std::setw(12) << "min_us"
+       << std::setw(12) << "p50_us"
+       << std::setw(12) << "p90_us"
+       << std::setw(12) << "max_us" << std::endl;
+}
+
+
+void Samples::Write(std::ostream *out, const std::string &name) const {
+  std::vector<std::int64_t> sorted{elapsed_ns_};
+  std::sort(sorted.begin(), sorted.end());
+  *out << std::left << std::setw(16) << name << std::right
+       << std::setw(8) << sorted.size()
+       << std::setw(12) << Percentile(sorted, 0) / 1000
+       << std::setw(12) << Percentile(sorted, 50) / 1000
+       << std::setw(12) << Percentile(sorted, 90) / 1000
+       << std::setw(12) << Percentile(sorted, 100) / 1000 << std::endl;
+}
+
+
+std::int64_t Samples::NowNs() {
+  return Chrono::duration_cast<Chrono::nanoseconds>(
+      Chrono::steady_clock::now().time_since_epoch()).count();
+}
+}  // namespace ncstreamer_remote_bench
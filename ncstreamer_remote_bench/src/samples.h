@@ -0,0 +1,39 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_BENCH_SRC_SAMPLES_H_
+#define NCSTREAMER_REMOTE_BENCH_SRC_SAMPLES_H_
+
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+namespace ncstreamer_remote_bench {
+/// Durations of the rounds of one measurement.
+class Samples {
+ public:
+  Samples();
+  virtual ~Samples();
+
+  void Add(std::int64_t elapsed_ns);
+
+  static void WriteHeader(std::ostream *out, const char *first_column);
+
+  /// Writes the count, and the minimum, the percentiles and the maximum
+  /// in microseconds, under the columns of WriteHeader.
+  void Write(std::ostream *out, const std::string &name) const;
+
+  static std::int64_t NowNs();
+
+ private:
+  std::vector<std::int64_t> elapsed_ns_;
+};
+}  // namespace ncstreamer_remote_bench
+
+
+#endif  // NCSTREAMER_REMOTE_BENCH_SRC_SAMPLES_H_
@@ -0,0 +1,132 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_bench/src/shutdown_bench.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ncstreamer_remote/ncstreamer_remote.h"
+#include "ncstreamer_remote/remote_future.h"
+
+#include "ncstreamer_remote_bench/src/samples.h"
+#include "ncstreamer_remote_load/src/mock_server.h"
+
+
+namespace {
+using ncstreamer_remote::ErrorCategory;
+using ncstreamer_remote::NcStreamerRemote;
+using ncstreamer_remote::RemoteFuture;
+using ncstreamer_remote_bench::BenchOptions;
+using ncstreamer_remote_bench::Samples;
+
+
+const std::uint32_t kDeadlineMs{1000};
+const std::size_t kQueuedRequests{8};
+const wchar_t *const kSourceTitle{L"ncstreamer_remote_bench"};
+
+
+struct Scenario {
+  const char *name;
+
+  /// Connects to the mock first, or else to the unserved port.
+  bool connected;
+
+  /// Stop requests made right before Close.
+  std::size_t queued;
+
+  bool flush_urgent;
+};
+
+
+const Scenario kScenarios[]{
+  {"connecting", false, 0, false},
+  {"idle", true, 0, false},
+  {"queued", true, kQueuedRequests, false},
+  {"queued+flush", true, kQueuedRequests, true},
+};
+
+
+/// @return False if the instance isn't connected to the mock.
+bool RunRound(
+    const BenchOptions &options,
+    const Scenario &scenario,
+    Samples *close_samples,
+    Samples *destroy_samples,
+    std::size_t *late_count) {
+  std::uint16_t port = scenario.connected == true ?
+      options.port : static_cast<std::uint16_t>(options.port + 1);
+  std::unique_ptr<NcStreamerRemote> remote{
+      NcStreamerRemote::Create(port, nullptr)};
+
+  if (scenario.connected == true) {
+    auto warm_up = remote->RequestStatus().Get();
+    if (warm_up.error.category != ErrorCategory::kNoCategory) {
+      return false;
+    }
+  } else {
+    remote->RequestStatus();  // starts a connect, and fails at Close.
+  }
+
+  std::vector<RemoteFuture<bool>> queued{};
+  for (std::size_t i = 0; i < scenario.queued; ++i) {
+    queued.emplace_back(remote->RequestStop(kSourceTitle));
+  }
+
+  std::int64_t close_begin_ns = Samples::NowNs();
+  bool closed = remote->Close(kDeadlineMs, scenario.flush_urgent);
+  std::int64_t close_end_ns = Samples::NowNs();
+  remote.reset();
+  std::int64_t destroy_end_ns = Samples::NowNs();
+
+  close_samples->Add(close_end_ns - close_begin_ns);
+  destroy_samples->Add(destroy_end_ns - close_end_ns);
+  if (closed == false) {
+    ++*late_count;
+  }
+  return true;
+}
+}  // unnamed namespace
+
+
+namespace ncstreamer_remote_bench {
+bool RunShutdownBench(const BenchOptions &options, std::ostream *out) {
+  ncstreamer_remote_load::MockServer mock_server{};
+  if (mock_server.Start(options.port) == false) {
+    *out << "mock server failed on port " << options.port << std::endl;
+    return false;
+  }
+
+  *out << "shutdown: Close(" << kDeadlineMs << " ms) and the destruction"
+       << " after it" << std::endl;
+  Samples::WriteHeader(out, "scenario");
+  bool connected{true};
+  for (const Scenario &scenario : kScenarios) {
+    Samples close_samples{};
+    Samples destroy_samples{};
+    std::size_t late_count{0};
+    for (std::size_t r = 0; r < options.rounds && connected == true; ++r) {
+      connected = RunRound(
+          options, scenario, &close_samples, &destroy_samples, &late_count);
+    }
+    if (connected == false) {
+      *out << "no connection to the mock on port " << options.port
+           << std::endl;
+      break;
+    }
+    close_samples.Write(out, std::string{scenario.name} + " close");
+    destroy_samples.Write(out, std::string{scenario.name} + " delete");
+    if (late_count != 0) {
+      *out << late_count << " closes past the deadline" << std::endl;
+    }
+  }
+
+  mock_server.Stop();
+  return connected;
+}
+}  // namespace ncstreamer_remote_bench
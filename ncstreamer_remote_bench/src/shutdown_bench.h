@@ -0,0 +1,24 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_BENCH_SRC_SHUTDOWN_BENCH_H_
+#define NCSTREAMER_REMOTE_BENCH_SRC_SHUTDOWN_BENCH_H_
+
+
+#include <ostream>
+
+#include "ncstreamer_remote_bench/src/bench_options.h"
+
+
+namespace ncstreamer_remote_bench {
+/// Measures NcStreamerRemote::Close and the destruction after it, while
+/// connecting to an unserved port, connected and idle, and connected with
+/// requests queued, flushed or not.
+/// @return False if no connection is made to the mock NCStreamer.
+bool RunShutdownBench(const BenchOptions &options, std::ostream *out);
+}  // namespace ncstreamer_remote_bench
+
+
+#endif  // NCSTREAMER_REMOTE_BENCH_SRC_SHUTDOWN_BENCH_H_
@@ -0,0 +1,107 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_bench/src/startup_bench.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>  // NOLINT
+
+#include "ncstreamer_remote/ncstreamer_remote.h"
+
+#include "ncstreamer_remote_bench/src/samples.h"
+
+
+namespace {
+using ncstreamer_remote::NcStreamerRemote;
+using ncstreamer_remote_bench::Samples;
+
+
+/// Set by the ready handler, on the io thread.
+class Readiness {
+ public:
+  Readiness()
+      : ready_ns_{0},
+        succeeded_{false} {}
+
+  void Set(bool success) {
+    succeeded_ = success;
+    ready_ns_ = Samples::NowNs();
+  }
+
+  /// @return The time it is set at.
+  std::int64_t Wait() const {
+    while (ready_ns_ == 0) {
+      std::this_thread::yield();
+    }
+    return ready_ns_;
+  }
+
+  bool succeeded() const { return succeeded_; }
+
+ private:
+  std::atomic<std::int64_t> ready_ns_;
+  std::atomic_bool succeeded_;
+};
+
+
+void WatchReadiness(NcStreamerRemote *remote, Readiness *readiness) {
+  remote->RegisterReadyHandler([readiness](bool success) {
+    readiness->Set(success);
+  });
+}
+}  // unnamed namespace
+
+
+namespace ncstreamer_remote_bench {
+bool RunStartupBench(const BenchOptions &options, std::ostream *out) {
+  // nothing serves the port, as connecting comes after the readiness.
+  std::uint16_t port = static_cast<std::uint16_t>(options.port + 1);
+
+  Samples setup_caller{};
+  Samples setup_ready{};
+  Samples create_caller{};
+  Samples create_ready{};
+  bool succeeded{true};
+  for (std::size_t r = 0; r < options.rounds && succeeded == true; ++r) {
+    {
+      Readiness readiness{};
+      std::int64_t begin_ns = Samples::NowNs();
+      NcStreamerRemote::SetUp(port);
+      std::int64_t end_ns = Samples::NowNs();
+      WatchReadiness(NcStreamerRemote::Get(), &readiness);
+      setup_caller.Add(end_ns - begin_ns);
+      setup_ready.Add(readiness.Wait() - begin_ns);
+      succeeded = readiness.succeeded();
+      NcStreamerRemote::ShutDown();
+    }
+    {
+      Readiness readiness{};
+      std::int64_t begin_ns = Samples::NowNs();
+      std::unique_ptr<NcStreamerRemote> remote{
+          NcStreamerRemote::Create(port, nullptr)};
+      std::int64_t end_ns = Samples::NowNs();
+      WatchReadiness(remote.get(), &readiness);
+      create_caller.Add(end_ns - begin_ns);
+      create_ready.Add(readiness.Wait() - begin_ns);
+      succeeded = succeeded && readiness.succeeded();
+    }
+  }
+  if (succeeded == false) {
+    *out << "an instance failed to set up" << std::endl;
+    return false;
+  }
+
+  *out << "startup: returning to the caller, and ready on the io thread"
+       << std::endl;
+  Samples::WriteHeader(out, "call");
+  setup_caller.Write(out, "SetUp");
+  setup_ready.Write(out, "SetUp ready");
+  create_caller.Write(out, "Create");
+  create_ready.Write(out, "Create ready");
+  return true;
+}
+}  // namespace ncstreamer_remote_bench
@@ -0,0 +1,24 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_BENCH_SRC_STARTUP_BENCH_H_
+#define NCSTREAMER_REMOTE_BENCH_SRC_STARTUP_BENCH_H_
+
+
+#include <ostream>
+
+#include "ncstreamer_remote_bench/src/bench_options.h"
+
+
+namespace ncstreamer_remote_bench {
+/// Measures what SetUp and Create cost the caller's thread, against
+/// the time until the instance is ready, which is the cost the caller's
+/// thread took before the initialization was moved to the io thread.
+/// @return False if an instance fails to set up.
+bool RunStartupBench(const BenchOptions &options, std::ostream *out);
+}  // namespace ncstreamer_remote_bench
+
+
+#endif  // NCSTREAMER_REMOTE_BENCH_SRC_STARTUP_BENCH_H_
@@ -0,0 +1,42 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_BATCH_ITEM_H_
+#define NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_BATCH_ITEM_H_
+
+
+#include <string>
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/error/error_types.h"
+
+
+namespace ncstreamer_remote {
+/// One request of NcStreamerRemote::RequestBatch.
+struct BatchItem {
+  enum class Type {
+    kQualityUpdate,
+    kStart,
+    kStop,
+    kExit,
+  };
+
+  Type type;
+
+  /// Quality of kQualityUpdate, or title of kStart and kStop.
+  std::wstring param;
+};
+
+
+/// Result of one BatchItem.
+struct BatchResult {
+  /// ErrorCategory::kNoCategory if the request has succeeded.
+  ErrorCategory category;
+  int err_code;
+  std::wstring err_msg;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_BATCH_ITEM_H_
@@ -0,0 +1,24 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_CALLBACK_KIND_H_
+#define NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_CALLBACK_KIND_H_
+
+
+namespace ncstreamer_remote {
+/// User callbacks which NcStreamerRemote calls from its io threads.
+enum class CallbackKind {
+  kReady,
+  kConnect,
+  kDisconnect,
+  kStartEvent,
+  kStopEvent,
+  kResponse,  // every response handler of the requests.
+  kError,  // every error handler of the requests.
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_CALLBACK_KIND_H_
@@ -0,0 +1,77 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_CANCELLATION_TOKEN_H_
+#define NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_CANCELLATION_TOKEN_H_
+
+
+#ifdef NCSTREAMER_REMOTE_DLL_EXPORTS
+#define NCSTREAMER_REMOTE_DLL_API __declspec(dllexport)
+#else
+#define NCSTREAMER_REMOTE_DLL_API __declspec(dllimport)
+#endif
+
+
+#include <memory>
+
+
+namespace ncstreamer_remote {
+/// Withdraws the requests made with it, e.g. when the UI waiting for them
+/// goes away. Copies share one state, and any copy may cancel it, from any
+/// thread. A default constructed token is never cancelled.
+///
+/// The handlers of a cancelled request are released without being called.
+/// A queued request is never sent. A request in flight frees the slot of
+/// NcStreamerRemote at once, and its response is dropped when it arrives.
+class CancellationToken {
+ public:
+  /// Told of the cancellation, e.g. by NcStreamerRemote.
+  class Listener {
+   public:
+    virtual ~Listener() {}
+    virtual void OnCancelled(const CancellationToken &token) = 0;
+  };
+
+  CancellationToken()
+      : state_{} {}
+
+  static NCSTREAMER_REMOTE_DLL_API CancellationToken Create();
+
+  /// Does nothing but for the first call.
+  void NCSTREAMER_REMOTE_DLL_API Cancel() const;
+
+  bool NCSTREAMER_REMOTE_DLL_API IsCancelled() const;
+
+  bool CanBeCancelled() const {
+    return static_cast<bool>(state_);
+  }
+
+  /// Whether both are copies of the same token.
+  bool operator==(const CancellationToken &other) const {
+    return state_ == other.state_;
+  }
+
+  bool operator!=(const CancellationToken &other) const {
+    return state_ != other.state_;
+  }
+
+  /// Adds the listener once, however often it is added.
+  /// @return False if the token is cancelled already, or can't be.
+  bool NCSTREAMER_REMOTE_DLL_API AddListener(
+      const std::shared_ptr<Listener> &listener) const;
+
+ private:
+  /// Defined in the DLL, so that this header stays light.
+  struct State;
+
+  explicit CancellationToken(const std::shared_ptr<State> &state)
+      : state_{state} {}
+
+  std::shared_ptr<State> state_;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_CANCELLATION_TOKEN_H_
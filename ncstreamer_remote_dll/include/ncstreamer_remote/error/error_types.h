@@ -44,6 +44,30 @@ class Error {
 
     /// "the connection to NCStreamer is closed"
     kOnRemoteClose,
+
+    /// "your request is superseded by a newer one"
+    kSuperseded,
+
+    /// "the request queue is full"
+    kQueueFull,
+
+    /// "your request is dropped from the full request queue"
+    kDropped,
+
+    /// "no NCStreamer answers on the candidate ports"
+    kNoNcStreamerPort,
+
+    /// "NCStreamer-Remote is shutting down"
+    kShutDown,
+
+    /// "the request is over the rate limit"
+    kRateLimited,
+
+    /// "the request is cancelled"
+    kCancelled,
+
+    /// "NCStreamer responded with a broken message"
+    kBadResponse,
   };
 
   enum class Start {
@@ -0,0 +1,102 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_IO_POOL_H_
+#define NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_IO_POOL_H_
+
+
+#ifdef NCSTREAMER_REMOTE_DLL_EXPORTS
+#define NCSTREAMER_REMOTE_DLL_API __declspec(dllexport)
+#else
+#define NCSTREAMER_REMOTE_DLL_API __declspec(dllimport)
+#endif
+
+
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "boost/asio/io_service.hpp"
+
+
+namespace ncstreamer_remote {
+/// How the io threads run, to trade power for latency.
+struct IoThreadPolicy {
+  /// CPUs the threads may run on, e.g. away from the render thread.
+  /// Zero leaves the affinity as it is.
+  std::uint64_t affinity_mask;
+
+  /// One of THREAD_PRIORITY_*, e.g. THREAD_PRIORITY_ABOVE_NORMAL.
+  /// Zero is THREAD_PRIORITY_NORMAL.
+  int priority;
+
+  /// How long an idle thread keeps polling for handlers before it sleeps,
+  /// in microseconds. A handler ready while polling skips the kernel
+  /// wakeup, at the cost of a busy CPU. Zero always sleeps.
+  std::uint32_t spin_us;
+};
+
+
+/// Io threads which NcStreamerRemote instances can share,
+/// so that more instances don't mean more threads.
+/// Every instance serializes its own handlers, so a pool of a few threads
+/// serves many instances.
+class IoPool {
+ public:
+  /// @param thread_count At least one thread runs.
+  static NCSTREAMER_REMOTE_DLL_API std::shared_ptr<IoPool> Create(
+      std::size_t thread_count);
+  static NCSTREAMER_REMOTE_DLL_API std::shared_ptr<IoPool> Create(
+      std::size_t thread_count,
+      const IoThreadPolicy &policy);
+
+  /// Creates a pool without threads, whose handlers run only in Poll,
+  /// e.g. to step instances deterministically with a SimulatedClock.
+  static NCSTREAMER_REMOTE_DLL_API std::shared_ptr<IoPool> CreateManual();
+
+  /// Stops the threads. Destroy the instances using the pool first,
+  /// and don't release the last reference from inside a handler.
+  virtual ~IoPool();
+
+  boost::asio::io_service &io_service() { return io_service_; }
+
+  bool RunsInThisThread() const;
+
+  bool IsManual() const { return manual_; }
+
+  /// Runs the handlers ready now on this thread, which counts as
+  /// an io thread meanwhile. Only for a manual pool, from one thread.
+  /// @return The number of handlers run.
+  std::size_t NCSTREAMER_REMOTE_DLL_API Poll();
+
+  void Stop();
+
+ private:
+  IoPool(
+      std::size_t thread_count,
+      const IoThreadPolicy &policy,
+      bool manual);
+
+  void Run();
+  void RunSpinning();
+
+  IoPool(const IoPool &) = delete;
+  IoPool &operator=(const IoPool &) = delete;
+
+  const IoThreadPolicy policy_;
+  const bool manual_;
+  boost::asio::io_service io_service_;
+  std::unique_ptr<boost::asio::io_service::work> io_service_work_;
+  std::vector<std::thread> threads_;
+
+  mutable std::mutex polling_mutex_;
+  std::thread::id polling_thread_id_;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_IO_POOL_H_
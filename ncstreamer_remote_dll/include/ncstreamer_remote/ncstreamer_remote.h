@@ -14,40 +14,38 @@
 #endif
 
 
-#include <atomic>
-#include <fstream>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
-#include <thread>  // NOLINT
 #include <vector>
 
-#include "boost/asio/io_service.hpp"
-#include "boost/asio/steady_timer.hpp"
-#include "boost/property_tree/ptree.hpp"
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/batch_item.h"
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/callback_kind.h"
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/cancellation_token.h"
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/error/error_types.h"
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/port_discovery.h"
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/rate_limit.h"
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/remote_stats.h"
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/replay_stats.h"
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/streamer_status.h"
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/unique_function.h"
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/utf8_event.h"
 
-#ifdef _MSC_VER
-#pragma warning(disable: 4267)
-#endif
-#include "websocketpp/client.hpp"
-#include "websocketpp/config/asio_no_tls_client.hpp"
-#ifdef _MSC_VER
-#pragma warning(default: 4267)
-#endif
 
-#if _MSC_VER >= 1900
-#include <chrono>  // NOLINT
-namespace Chrono = std::chrono;
-#else
-#include "boost/chrono/include.hpp"
-namespace Chrono = boost::chrono;
-#endif  // _MSC_VER >= 1900
+namespace ncstreamer_remote {
+class IoPool;
+class RemoteClock;
 
-#include "ncstreamer_remote_dll/include/ncstreamer_remote/error/error_types.h"
+/// Of remote_future.h, which the callers of the future overloads include.
+template <typename T>
+class RemoteFuture;
+struct StatusResponse;
 
 
-namespace ncstreamer_remote {
 class NcStreamerRemote {
  public:
+  using ReadyHandler = std::function<void(bool success)>;
   using ConnectHandler = std::function<void()>;
   using DisconnectHandler = std::function<void()>;
 
@@ -83,142 +81,359 @@ class NcStreamerRemote {
   using StopEventHandler = std::function<void(
       const std::wstring &source_title)>;
 
+  /// Event handlers taking the UTF-8 fields as received, without any
+  /// conversion to std::wstring, e.g. for bindings to other languages.
+  using Utf8StartEventHandler = std::function<void(
+      const Utf8StartEvent &evt)>;
+  using Utf8StopEventHandler = std::function<void(
+      const Utf8StopEvent &evt)>;
+
+  /// @param results One per BatchItem, in the same order.
+  using BatchResponseHandler = std::function<void(
+      const std::vector<BatchResult> &results)>;
+
+  /// Move-only handlers, for the overloads of Request* which take rvalues.
+  /// Small captures are stored in place without any heap allocation.
+  using UniqueErrorHandler = UniqueFunction<void(
+      ErrorCategory category,
+      int err_code,
+      const std::wstring &err_msg)>;
+  using UniqueSuccessHandler = UniqueFunction<void(
+      bool success)>;
+  using UniqueStatusResponseHandler = UniqueFunction<void(
+      const std::wstring &status,
+      const std::wstring &source_title,
+      const std::wstring &user_name,
+      const std::wstring &quality)>;
+  using UniqueStartResponseHandler = UniqueFunction<void(
+      bool success)>;
+  using UniqueStopResponseHandler = UniqueFunction<void(
+      bool success)>;
+  using UniqueBatchResponseHandler = UniqueFunction<void(
+      const std::vector<BatchResult> &results)>;
+
+  using SlowCallbackHandler = std::function<void(
+      CallbackKind kind,
+      std::uint32_t elapsed_us)>;
+
+  /// What to do with a request when the request queue is full.
+  enum class OverflowPolicy {
+    /// Fails the new request with Error::Connection::kQueueFull.
+    kRejectNewest,
+
+    /// Fails the oldest request of the lowest priority with
+    /// Error::Connection::kDropped, to make room for the new one.
+    /// A request never evicts one of a higher priority.
+    kDropOldest,
+
+    /// Waits for room up to the block timeout, and then fails the new
+    /// request with Error::Connection::kQueueFull.
+    /// Calls from inside the handlers never wait.
+    kBlock,
+  };
+
   static NCSTREAMER_REMOTE_DLL_API void SetUp(uint16_t remote_port);
+  static NCSTREAMER_REMOTE_DLL_API void SetUp(const PortDiscovery &discovery);
+
+  /// @param io_pool Io threads to run on, e.g. made with an IoThreadPolicy,
+  ///     or null for a thread of its own.
+  static NCSTREAMER_REMOTE_DLL_API void SetUp(
+      const PortDiscovery &discovery,
+      const std::shared_ptr<IoPool> &io_pool);
+
+  /// Discovers NCStreamer on the ports from 9002 to 9009.
   static NCSTREAMER_REMOTE_DLL_API void SetUpDefault();
 
   static NCSTREAMER_REMOTE_DLL_API void ShutDown();
+
+  /// Closes the instance of SetUp like Close, and deletes it.
+  static NCSTREAMER_REMOTE_DLL_API void ShutDown(
+      std::uint32_t deadline_ms,
+      bool flush_urgent);
   static NCSTREAMER_REMOTE_DLL_API NcStreamerRemote *Get();
 
+  /// Creates an instance independent of the one of SetUp, e.g. to drive
+  /// several NCStreamers on different ports. Each instance logs to a file
+  /// of its own, ncstreamer_remote_<first port>_<instance number>.log.
+  /// @param io_pool Io threads to share with other instances,
+  ///     or null for a thread of its own.
+  static NCSTREAMER_REMOTE_DLL_API std::unique_ptr<NcStreamerRemote> Create(
+      uint16_t remote_port,
+      const std::shared_ptr<IoPool> &io_pool);
+  static NCSTREAMER_REMOTE_DLL_API std::unique_ptr<NcStreamerRemote> Create(
+      const PortDiscovery &discovery,
+      const std::shared_ptr<IoPool> &io_pool);
+
+  /// @param clock Time of the timeouts and retries, e.g. a SimulatedClock
+  ///     with a manual io pool to run reconnects in tests in no time,
+  ///     or null for the steady clock.
+  static NCSTREAMER_REMOTE_DLL_API std::unique_ptr<NcStreamerRemote> Create(
+      const PortDiscovery &discovery,
+      const std::shared_ptr<IoPool> &io_pool,
+      const std::shared_ptr<RemoteClock> &clock);
+
+  /// Closes the connection, and waits for the handlers running on
+  /// a shared io pool. No handler is called afterwards.
+  virtual NCSTREAMER_REMOTE_DLL_API ~NcStreamerRemote();
+
+  /// Stops taking requests, and fails the queued ones, the waiting ones and
+  /// the one in flight with Error::Connection::kShutDown. With flush_urgent,
+  /// queued exit and stop requests are still sent first. Then closes the
+  /// connection with a close handshake.
+  /// Returns within deadline_ms, unless a callback blocks the io thread.
+  /// @return Whether the connection is closed in time. If not,
+  ///     the destructor gives up the close handshake.
+  bool NCSTREAMER_REMOTE_DLL_API Close(
+      std::uint32_t deadline_ms,
+      bool flush_urgent);
+
+  /// SetUp and Create return at once, and leave opening the log file and
+  /// setting up the network to the io thread. Requests made meanwhile are
+  /// queued. The handler is called once that is done, on the io thread,
+  /// or right away on this thread if it is already done.
+  void NCSTREAMER_REMOTE_DLL_API RegisterReadyHandler(
+      const ReadyHandler &ready_handler);
+
   void NCSTREAMER_REMOTE_DLL_API RegisterConnectHandler(
       const ConnectHandler &connect_handler);
 
   void NCSTREAMER_REMOTE_DLL_API RegisterDisconnectHandler(
       const DisconnectHandler &disconnect_handler);
 
+  /// Start and stop events carry sequence numbers from NCStreamer.
+  /// On reconnect, the handshake asks NCStreamer to replay the events
+  /// after the last one seen, so that they reach the handlers once each
+  /// and no status request is needed. If NCStreamer can't replay them,
+  /// the status is requested again as before.
   void NCSTREAMER_REMOTE_DLL_API RegisterStartEventHandler(
       const StartEventHandler &start_event_handler);
 
   void NCSTREAMER_REMOTE_DLL_API RegisterStopEventHandler(
       const StopEventHandler &stop_event_handler);
 
+  /// Called along with the handlers above, if any.
+  /// The fields are converted only for the std::wstring handlers.
+  void NCSTREAMER_REMOTE_DLL_API RegisterUtf8StartEventHandler(
+      const Utf8StartEventHandler &start_event_handler);
+
+  void NCSTREAMER_REMOTE_DLL_API RegisterUtf8StopEventHandler(
+      const Utf8StopEventHandler &stop_event_handler);
+
+  /// RequestStatus calls made while a status request is in flight are
+  /// attached to it, and get the same response.
+  /// With a nonzero window, a status request waits that long before being
+  /// sent, so that more callers can attach to it.
+  void NCSTREAMER_REMOTE_DLL_API SetStatusCoalescingWindow(
+      std::uint32_t window_ms);
+
+  /// With a nonzero window, RequestQualityUpdate calls within the window
+  /// are collapsed into one update of the latest quality.
+  /// Every replaced call gets Error::Connection::kSuperseded.
+  /// Updates are sent one at a time, in the order of the calls.
+  void NCSTREAMER_REMOTE_DLL_API SetQualityUpdateDebounceWindow(
+      std::uint32_t window_ms);
+
+  /// Every callback is timed into RemoteStats::callback_us_histogram.
+  /// The ones longer than budget_us are reported to slow_callback_handler,
+  /// right after they return, on the same thread.
+  /// Once the connect, disconnect, start and stop event callbacks go over
+  /// the budget offload_after times in a row, they are called from
+  /// a thread of their own, in the same order, not to hold up the network.
+  /// The other callbacks always run on the io threads, as they complete
+  /// the requests. A zero budget_us turns this off, which is the default.
+  /// Calling this again brings offloaded event callbacks back to the io
+  /// threads, once those already offloaded have run.
+  void NCSTREAMER_REMOTE_DLL_API SetCallbackBudget(
+      std::uint32_t budget_us,
+      const SlowCallbackHandler &slow_callback_handler,
+      std::uint32_t offload_after);
+
+  /// Requests are queued and sent one at a time, in priority order:
+  /// exit and stop requests, then start and quality update requests,
+  /// then status requests.
+  /// The default is 16 requests with OverflowPolicy::kRejectNewest.
+  void NCSTREAMER_REMOTE_DLL_API SetRequestQueuePolicy(
+      std::size_t capacity,
+      OverflowPolicy overflow_policy,
+      std::uint32_t block_timeout_ms);
+
+  /// On connect, a handshake agrees on the protocol version and the
+  /// capabilities of NCStreamer. If MessagePack is agreed, messages are
+  /// sent and received as binary frames; otherwise they stay JSON text,
+  /// as with NCStreamer builds that don't know the handshake.
+  /// Enabled by default; a change applies from the next connection.
+  void NCSTREAMER_REMOTE_DLL_API SetBinaryEncodingEnabled(bool enabled);
+
+  /// Limits the requests of the type sent to NCStreamer, e.g. to protect
+  /// its encoder from a caller requesting the status every frame.
+  /// Requests held by kDelay or kMerge still go through the request queue
+  /// once their token comes. Close fails them, except for the exit and
+  /// stop requests kept by flush_urgent, which are queued at once.
+  void NCSTREAMER_REMOTE_DLL_API SetRateLimit(
+      RequestType type,
+      const RateLimit &rate_limit);
+
+  RemoteStats NCSTREAMER_REMOTE_DLL_API GetStats() const;
+
+  /// Records every frame sent and received, and the connection events,
+  /// with steady clock times into an append-only binary file,
+  /// e.g. to reproduce an issue from the field with Replay.
+  /// @return False if the file can't be opened.
+  bool NCSTREAMER_REMOTE_DLL_API StartCapture(const std::string &path);
+  void NCSTREAMER_REMOTE_DLL_API StopCapture();
+
+  /// Feeds the received frames of a capture through the message handling
+  /// and the handlers, as if NCStreamer sent them, and returns once they
+  /// are handled. Sent frames are skipped, and the connection events go to
+  /// the connect and disconnect handlers only.
+  /// Meant for an instance with a PortDiscovery of no ports, which never
+  /// connects. Never call it on the io thread.
+  /// @param recorded_speed Keeps the recorded intervals, or otherwise feeds
+  ///     the frames as fast as possible, e.g. to benchmark the parsing.
+  ReplayStats NCSTREAMER_REMOTE_DLL_API Replay(
+      const std::string &capture_path,
+      bool recorded_speed);
+
   void NCSTREAMER_REMOTE_DLL_API RequestStatus(
       const ErrorHandler &error_handler,
-      const StatusResponseHandler &status_response_handler);
+      const StatusResponseHandler &status_response_handler,
+      const CancellationToken &cancellation_token = CancellationToken{});
 
   void NCSTREAMER_REMOTE_DLL_API RequestStart(
       const std::wstring &title,
       const ErrorHandler &error_handler,
-      const StartResponseHandler &start_response_handler);
+      const StartResponseHandler &start_response_handler,
+      const CancellationToken &cancellation_token = CancellationToken{});
 
   void NCSTREAMER_REMOTE_DLL_API RequestStop(
       const std::wstring &title,
       const ErrorHandler &error_handler,
-      const StopResponseHandler &stop_response_handler);
+      const StopResponseHandler &stop_response_handler,
+      const CancellationToken &cancellation_token = CancellationToken{});
 
   void NCSTREAMER_REMOTE_DLL_API RequestQualityUpdate(
       const std::wstring &quality,
       const ErrorHandler &error_handler,
-      const SuccessHandler &quality_update_response_handler);
+      const SuccessHandler &quality_update_response_handler,
+      const CancellationToken &cancellation_token = CancellationToken{});
 
   void NCSTREAMER_REMOTE_DLL_API RequestExit(
-      const ErrorHandler &error_handler);
+      const ErrorHandler &error_handler,
+      const CancellationToken &cancellation_token = CancellationToken{});
+
+  /// Sends the items in one frame, and calls batch_response_handler once
+  /// with the result of every item.
+  /// error_handler is called instead if the batch as a whole fails,
+  /// e.g. by a lost connection.
+  /// If NCStreamer doesn't answer the first batch in a second, that batch
+  /// and the later ones are sent item by item on this connection.
+  /// NCStreamer doesn't respond to an exit request, so put it last.
+  void NCSTREAMER_REMOTE_DLL_API RequestBatch(
+      const std::vector<BatchItem> &items,
+      const ErrorHandler &error_handler,
+      const BatchResponseHandler &batch_response_handler,
+      const CancellationToken &cancellation_token = CancellationToken{});
+
+  /// Overloads taking rvalues, which don't allocate on the caller's thread
+  /// once warm, as long as the handlers are small and the strings fit in
+  /// the small string buffer. The ones taking const references copy them.
+  /// Allocations which remain on the caller's thread:
+  /// - the first requests, growing the pools of the queue and the tasks.
+  /// - a title or a quality too long for the small string buffer.
+  /// - a status or quality request with a nonzero coalescing or debounce
+  ///   window, arming its timer.
+  /// - a request with a cancellation token, adding a listener to it.
+  /// - a request failing right away, e.g. with Error::Connection::kQueueFull,
+  ///   as its error handler is called on the caller's thread.
+  /// Encoding and sending take place on the io thread.
+  void NCSTREAMER_REMOTE_DLL_API RequestStatus(
+      UniqueErrorHandler &&error_handler,
+      UniqueStatusResponseHandler &&status_response_handler,
+      const CancellationToken &cancellation_token = CancellationToken{});
+
+  /// @return The latest known status of NCStreamer, never null.
+  ///     It is mirrored from start/stop events and refreshed on connect,
+  ///     so this never waits for NCStreamer nor for the io thread.
+  std::shared_ptr<const StreamerStatus>
+      NCSTREAMER_REMOTE_DLL_API GetCachedStatus() const;
+
+  /// Calls status_response_handler on the caller's thread with the cached
+  /// status if it is younger than max_age_ms,
+  /// or falls back to RequestStatus otherwise.
+  void NCSTREAMER_REMOTE_DLL_API RequestCachedStatus(
+      std::uint32_t max_age_ms,
+      const ErrorHandler &error_handler,
+      const StatusResponseHandler &status_response_handler,
+      const CancellationToken &cancellation_token = CancellationToken{});
 
- private:
-  using SteadyTimer = boost::asio::basic_waitable_timer<Chrono::steady_clock>;
-  using AsioClient = websocketpp::config::asio_client;
-  using OpenHandler = std::function<void()>;
-
-  explicit NcStreamerRemote(uint16_t remote_port);
-  virtual ~NcStreamerRemote();
-
-  bool ExistsNcStreamer();
-
-  void KeepConnected();
-
-  void Connect(
-    const ErrorHandler &error_handler,
-    const OpenHandler &open_handler);
-
-  void Connect(
-    const OpenHandler &open_handler);
-
-  void SendStatusRequest();
-  void SendStartRequest(const std::wstring &title);
-  void SendStopRequest(const std::wstring &title);
-  void SendQualityUpdateRequest(const std::wstring &quality);
-  void SendExitRequest();
-
-  void OnRemoteFail(websocketpp::connection_hdl connection);
-  void OnRemoteClose(websocketpp::connection_hdl connection);
-  void OnRemoteMessage(
-      websocketpp::connection_hdl connection,
-      websocketpp::connection<AsioClient>::message_ptr msg);
-
-  void OnRemoteStartEvent(
-      const boost::property_tree::ptree &evt);
-  void OnRemoteStopEvent(
-      const boost::property_tree::ptree &evt);
-
-  void OnRemoteStatusResponse(
-      const boost::property_tree::ptree &response);
-  void OnRemoteStartResponse(
-      const boost::property_tree::ptree &response);
-  void OnRemoteStopResponse(
-      const boost::property_tree::ptree &response);
-  void OnRemoteQualityUpdateResponse(
-      const boost::property_tree::ptree &response);
-
-  void HandleDisconnect(
-      Error::Connection err_code);
-  void HandleConnectionError(
-      Error::Connection err_code,
-      const ErrorHandler &err_handler);
-
-  void HandleError(
-      Error::Connection err_code,
-      const websocketpp::lib::error_code &ec,
-      const ErrorHandler &err_handler);
-  void HandleError(
-      Error::Connection err_code,
-      const websocketpp::lib::error_code &ec);
-  void HandleError(
-      Error::Connection err_code,
-      const std::string &err_msg,
-      const ErrorHandler &err_handler);
-  void HandleError(
-      Error::Connection err_code,
-      const ErrorHandler &err_handler);
-  void HandleError(
-      Error::Connection err_code);
-
-  void LogWarning(const std::string &warn_msg);
-  void LogError(const std::string &err_msg);
+  void NCSTREAMER_REMOTE_DLL_API RequestStart(
+      std::wstring &&title,
+      UniqueErrorHandler &&error_handler,
+      UniqueStartResponseHandler &&start_response_handler,
+      const CancellationToken &cancellation_token = CancellationToken{});
 
-  static NcStreamerRemote *static_instance;
+  void NCSTREAMER_REMOTE_DLL_API RequestStop(
+      std::wstring &&title,
+      UniqueErrorHandler &&error_handler,
+      UniqueStopResponseHandler &&stop_response_handler,
+      const CancellationToken &cancellation_token = CancellationToken{});
+
+  void NCSTREAMER_REMOTE_DLL_API RequestQualityUpdate(
+      std::wstring &&quality,
+      UniqueErrorHandler &&error_handler,
+      UniqueSuccessHandler &&quality_update_response_handler,
+      const CancellationToken &cancellation_token = CancellationToken{});
+
+  void NCSTREAMER_REMOTE_DLL_API RequestExit(
+      UniqueErrorHandler &&error_handler,
+      const CancellationToken &cancellation_token = CancellationToken{});
+
+  void NCSTREAMER_REMOTE_DLL_API RequestBatch(
+      std::vector<BatchItem> &&items,
+      UniqueErrorHandler &&error_handler,
+      UniqueBatchResponseHandler &&batch_response_handler,
+      const CancellationToken &cancellation_token = CancellationToken{});
+
+  /// Overloads returning a future instead of calling handlers.
+  /// Include remote_future.h to call them; this header only declares them.
+  /// A failed request sets its RemoteError, as passed to error handlers.
+  /// A cancelled one sets Error::Connection::kCancelled, on the thread
+  /// releasing its handlers.
+  RemoteFuture<StatusResponse> NCSTREAMER_REMOTE_DLL_API RequestStatus(
+      const CancellationToken &cancellation_token = CancellationToken{});
+
+  RemoteFuture<bool> NCSTREAMER_REMOTE_DLL_API RequestStart(
+      const std::wstring &title,
+      const CancellationToken &cancellation_token = CancellationToken{});
 
-  boost::asio::io_service io_service_;
-  boost::asio::io_service::work io_service_work_;
-  websocketpp::client<AsioClient> remote_;
-  std::vector<std::thread> remote_threads_;
-  std::ofstream remote_log_;
+  RemoteFuture<bool> NCSTREAMER_REMOTE_DLL_API RequestStop(
+      const std::wstring &title,
+      const CancellationToken &cancellation_token = CancellationToken{});
+
+  RemoteFuture<bool> NCSTREAMER_REMOTE_DLL_API RequestQualityUpdate(
+      const std::wstring &quality,
+      const CancellationToken &cancellation_token = CancellationToken{});
 
-  websocketpp::uri_ptr remote_uri_;
+  RemoteFuture<std::vector<BatchResult>> NCSTREAMER_REMOTE_DLL_API
+      RequestBatch(
+          const std::vector<BatchItem> &items,
+          const CancellationToken &cancellation_token = CancellationToken{});
 
-  websocketpp::connection_hdl remote_connection_;
-  SteadyTimer timer_to_keep_connected_;
+ private:
+  class Impl;
+
+  NcStreamerRemote(
+      const PortDiscovery &discovery,
+      const std::shared_ptr<IoPool> &io_pool,
+      const std::shared_ptr<RemoteClock> &clock,
+      const std::string &log_path);
 
-  std::atomic_bool busy_;
+  NcStreamerRemote(const NcStreamerRemote &) = delete;
+  NcStreamerRemote &operator=(const NcStreamerRemote &) = delete;
 
-  ConnectHandler connect_handler_;
-  DisconnectHandler disconnect_handler_;
-  StartEventHandler start_event_handler_;
-  StopEventHandler stop_event_handler_;
+  static NcStreamerRemote *static_instance;
 
-  ErrorHandler current_error_handler_;
-  StatusResponseHandler current_status_response_handler_;
-  StartResponseHandler current_start_response_handler_;
-  StopResponseHandler current_stop_response_handler_;
-  SuccessHandler current_quality_update_response_handler_;
+  std::unique_ptr<Impl> impl_;
 };
 }  // namespace ncstreamer_remote
 
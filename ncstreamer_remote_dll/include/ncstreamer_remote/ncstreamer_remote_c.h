@@ -0,0 +1,202 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_NCSTREAMER_REMOTE_C_H_
+#define NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_NCSTREAMER_REMOTE_C_H_
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_API
+#ifdef NCSTREAMER_REMOTE_DLL_EXPORTS
+#define NCSTREAMER_REMOTE_DLL_API __declspec(dllexport)
+#else
+#define NCSTREAMER_REMOTE_DLL_API __declspec(dllimport)
+#endif
+#endif
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/**
+ * C interface of NcStreamerRemote, for bindings to other languages.
+ * Strings are UTF-8, passed as pointer and size, and not null terminated.
+ * Strings passed to a callback are valid only during the callback.
+ * Callbacks run on the io thread, like the handlers of NcStreamerRemote.
+ * No C++ exception crosses this interface: failures are told by return
+ * values, or through the error callback of the request.
+ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct NcStreamerRemoteHandle NcStreamerRemoteHandle;
+
+
+typedef struct NcStreamerRemoteString {
+  const char *data;
+  size_t size;
+} NcStreamerRemoteString;
+
+
+typedef struct NcStreamerRemoteStartEvent {
+  NcStreamerRemoteString source_title;
+  NcStreamerRemoteString user_page;
+  NcStreamerRemoteString privacy;
+  NcStreamerRemoteString description;
+  NcStreamerRemoteString mic;
+  NcStreamerRemoteString service_provider;
+  NcStreamerRemoteString stream_url;
+  NcStreamerRemoteString post_url;
+} NcStreamerRemoteStartEvent;
+
+
+typedef struct NcStreamerRemoteStopEvent {
+  NcStreamerRemoteString source_title;
+} NcStreamerRemoteStopEvent;
+
+
+typedef struct NcStreamerRemoteStatus {
+  /** One of ['standby', 'setup', 'starting', 'onAir', 'stopping'] */
+  NcStreamerRemoteString status;
+  NcStreamerRemoteString source_title;
+  NcStreamerRemoteString user_name;
+  NcStreamerRemoteString quality;
+} NcStreamerRemoteStatus;
+
+
+/** category and err_code are those of ErrorCategory and Error. */
+typedef struct NcStreamerRemoteError {
+  int category;
+  int err_code;
+  NcStreamerRemoteString err_msg;
+} NcStreamerRemoteError;
+
+
+typedef void (*NcStreamerRemoteReadyCallback)(
+    int success,
+    void *user_data);
+typedef void (*NcStreamerRemoteConnectionCallback)(
+    void *user_data);
+typedef void (*NcStreamerRemoteStartEventCallback)(
+    const NcStreamerRemoteStartEvent *evt,
+    void *user_data);
+typedef void (*NcStreamerRemoteStopEventCallback)(
+    const NcStreamerRemoteStopEvent *evt,
+    void *user_data);
+
+typedef void (*NcStreamerRemoteErrorCallback)(
+    const NcStreamerRemoteError *err,
+    void *user_data);
+typedef void (*NcStreamerRemoteStatusCallback)(
+    const NcStreamerRemoteStatus *status,
+    void *user_data);
+typedef void (*NcStreamerRemoteSuccessCallback)(
+    int success,
+    void *user_data);
+
+
+/** Like NcStreamerRemote::Create. @return NULL on failure. */
+NCSTREAMER_REMOTE_DLL_API NcStreamerRemoteHandle *NcStreamerRemoteCreate(
+    uint16_t remote_port);
+
+/** Discovers NCStreamer among the candidate ports. */
+NCSTREAMER_REMOTE_DLL_API NcStreamerRemoteHandle *
+    NcStreamerRemoteCreateDiscovering(
+        const uint16_t *candidate_ports,
+        size_t candidate_port_count,
+        uint32_t probe_timeout_ms);
+
+/** No callback is called after this returns. */
+NCSTREAMER_REMOTE_DLL_API void NcStreamerRemoteDestroy(
+    NcStreamerRemoteHandle *remote);
+
+/** Like NcStreamerRemote::Close. @return Nonzero if closed in time. */
+NCSTREAMER_REMOTE_DLL_API int NcStreamerRemoteClose(
+    NcStreamerRemoteHandle *remote,
+    uint32_t deadline_ms,
+    int flush_urgent);
+
+/**
+ * Each callback replaces the previous one of its kind; NULL removes it.
+ * user_data is passed back as is.
+ * @return Zero if the callback couldn't be set, e.g. out of memory.
+ */
+NCSTREAMER_REMOTE_DLL_API int NcStreamerRemoteSetReadyCallback(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteReadyCallback callback,
+    void *user_data);
+
+NCSTREAMER_REMOTE_DLL_API int NcStreamerRemoteSetConnectCallback(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteConnectionCallback callback,
+    void *user_data);
+
+NCSTREAMER_REMOTE_DLL_API int NcStreamerRemoteSetDisconnectCallback(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteConnectionCallback callback,
+    void *user_data);
+
+/**
+ * The event fields are UTF-8 as received, without any wide conversion.
+ * They are valid only during the callback; copy them to keep them.
+ */
+NCSTREAMER_REMOTE_DLL_API int NcStreamerRemoteSetStartEventCallback(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteStartEventCallback callback,
+    void *user_data);
+
+NCSTREAMER_REMOTE_DLL_API int NcStreamerRemoteSetStopEventCallback(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteStopEventCallback callback,
+    void *user_data);
+
+/**
+ * Exactly one of error_callback and the response callback is called,
+ * with user_data. A request which can't be made, e.g. with a string of
+ * invalid UTF-8, is told to error_callback with category kMisc, before
+ * the call returns.
+ */
+NCSTREAMER_REMOTE_DLL_API void NcStreamerRemoteRequestStatus(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteErrorCallback error_callback,
+    NcStreamerRemoteStatusCallback status_callback,
+    void *user_data);
+
+NCSTREAMER_REMOTE_DLL_API void NcStreamerRemoteRequestStart(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteString title,
+    NcStreamerRemoteErrorCallback error_callback,
+    NcStreamerRemoteSuccessCallback start_callback,
+    void *user_data);
+
+NCSTREAMER_REMOTE_DLL_API void NcStreamerRemoteRequestStop(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteString title,
+    NcStreamerRemoteErrorCallback error_callback,
+    NcStreamerRemoteSuccessCallback stop_callback,
+    void *user_data);
+
+NCSTREAMER_REMOTE_DLL_API void NcStreamerRemoteRequestQualityUpdate(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteString quality,
+    NcStreamerRemoteErrorCallback error_callback,
+    NcStreamerRemoteSuccessCallback quality_update_callback,
+    void *user_data);
+
+/** error_callback is called only on failure. */
+NCSTREAMER_REMOTE_DLL_API void NcStreamerRemoteRequestExit(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteErrorCallback error_callback,
+    void *user_data);
+
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_NCSTREAMER_REMOTE_C_H_
@@ -0,0 +1,35 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_PORT_DISCOVERY_H_
+#define NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_PORT_DISCOVERY_H_
+
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace ncstreamer_remote {
+/// Where NcStreamerRemote looks for NCStreamer.
+/// With just one candidate port and no rendezvous file, it connects to
+/// that port directly, without probing. With neither, it never connects,
+/// e.g. to replay a capture.
+struct PortDiscovery {
+  /// Probed in parallel; the first port answering the handshake wins,
+  /// and is reused for reconnects until connecting to it fails.
+  std::vector<std::uint16_t> candidate_ports;
+
+  /// Optional file holding the port of NCStreamer in decimal.
+  /// Its port is probed along with the candidates. Empty for none.
+  std::string rendezvous_file;
+
+  /// How long the probes wait for an answer. Zero for a second.
+  std::uint32_t probe_timeout_ms;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_PORT_DISCOVERY_H_
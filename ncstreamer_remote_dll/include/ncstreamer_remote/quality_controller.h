@@ -0,0 +1,116 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_QUALITY_CONTROLLER_H_
+#define NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_QUALITY_CONTROLLER_H_
+
+
+#ifdef NCSTREAMER_REMOTE_DLL_EXPORTS
+#define NCSTREAMER_REMOTE_DLL_API __declspec(dllexport)
+#else
+#define NCSTREAMER_REMOTE_DLL_API __declspec(dllimport)
+#endif
+
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace ncstreamer_remote {
+class NcStreamerRemote;
+class RemoteClock;
+
+
+/// When QualityController steps the stream quality down and up.
+/// The load is a frame time over the frame budget, or a CPU usage,
+/// smoothed over the samples; 1.0 is no headroom left.
+struct QualityControlPolicy {
+  /// Qualities from the lowest to the highest, as NCStreamer names them.
+  std::vector<std::wstring> levels;
+
+  /// Assumed until NCStreamer tells its quality.
+  std::size_t initial_level;
+
+  std::uint32_t frame_budget_us;
+
+  /// Weight of a new sample in the smoothed load, in (0, 1].
+  double sample_weight;
+
+  /// Frame times or CPU usages not sampled for this long are left out of
+  /// the load, e.g. when the host samples only one of them from then on.
+  std::uint32_t sample_timeout_ms;
+
+  /// Steps down once the load stays at or above step_down_load for
+  /// step_down_after_ms, and up once it stays at or below step_up_load
+  /// for step_up_after_ms. The gap between the two keeps it from
+  /// flapping, so step_up_load must be below step_down_load.
+  double step_down_load;
+  std::uint32_t step_down_after_ms;
+  double step_up_load;
+  std::uint32_t step_up_after_ms;
+
+  /// Least time between two changes, and after a failed one.
+  std::uint32_t min_change_interval_ms;
+};
+
+
+/// Adapts the stream quality to the headroom of the game: steps it down
+/// when the frame time or the CPU usage spikes, and back up when
+/// the headroom returns. Changes go through RequestQualityUpdate,
+/// one at a time.
+/// Samples may come from any thread; the remote must outlive the controller.
+class QualityController {
+ public:
+  /// Steps among "low", "medium" and "high" for 60 frames per second.
+  static NCSTREAMER_REMOTE_DLL_API QualityControlPolicy GetDefaultPolicy();
+
+  /// Asks NCStreamer for its quality first, to start from it.
+  /// @param clock Time of the samples, or null for the steady clock.
+  /// @return Null if the policy has no levels, or thresholds out of order.
+  static NCSTREAMER_REMOTE_DLL_API std::unique_ptr<QualityController> Create(
+      NcStreamerRemote *remote,
+      const QualityControlPolicy &policy,
+      const std::shared_ptr<RemoteClock> &clock);
+
+  /// Withdraws the change in flight, if any, without waiting for it.
+  virtual NCSTREAMER_REMOTE_DLL_API ~QualityController();
+
+  void NCSTREAMER_REMOTE_DLL_API AddFrameTimeSample(
+      std::uint32_t frame_time_us);
+
+  /// @param cpu_usage Of all the cores, from 0.0 to 1.0.
+  void NCSTREAMER_REMOTE_DLL_API AddCpuSample(
+      double cpu_usage);
+
+  /// The level NCStreamer has confirmed last, an index of the levels.
+  std::size_t NCSTREAMER_REMOTE_DLL_API GetLevel() const;
+
+  /// Whether a change or the first status request is in flight.
+  bool NCSTREAMER_REMOTE_DLL_API IsChanging() const;
+
+ private:
+  class State;
+
+  QualityController(
+      NcStreamerRemote *remote,
+      const QualityControlPolicy &policy,
+      const std::shared_ptr<RemoteClock> &clock);
+
+  QualityController(const QualityController &) = delete;
+  QualityController &operator=(const QualityController &) = delete;
+
+  void RequestStatus();
+  void RequestLevel(std::size_t level);
+
+  NcStreamerRemote *const remote_;
+  const std::shared_ptr<State> state_;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_QUALITY_CONTROLLER_H_
@@ -0,0 +1,57 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_RATE_LIMIT_H_
+#define NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_RATE_LIMIT_H_
+
+
+#include <cstdint>
+
+
+namespace ncstreamer_remote {
+/// Types of the requests sent to NCStreamer.
+enum class RequestType {
+  kStatus = 0,
+  kStart,
+  kStop,
+  kQualityUpdate,
+  kExit,
+  kBatch,
+  kRequestTypeCount,
+};
+
+
+/// Token bucket limiting the requests of one type sent to NCStreamer.
+/// Status requests are limited as sent, after coalescing, and quality
+/// updates after debouncing.
+struct RateLimit {
+  /// What to do with a request over the limit.
+  enum class Policy {
+    /// Fails the request with Error::Connection::kRateLimited.
+    kReject,
+
+    /// Holds the request until the bucket has a token for it.
+    kDelay,
+
+    /// Merges the request into a held one of the same type and param,
+    /// whose response goes to both. A quality update replaces a held one
+    /// of any quality, which fails with Error::Connection::kSuperseded.
+    /// The request is delayed if there is nothing to merge into, and
+    /// batch requests are never merged.
+    kMerge,
+  };
+
+  /// Tokens added per second. Zero turns the limit off, which is the default.
+  std::uint32_t rate_per_s;
+
+  /// Tokens the bucket holds, i.e. the requests allowed in a burst.
+  std::uint32_t burst;
+
+  Policy policy;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_RATE_LIMIT_H_
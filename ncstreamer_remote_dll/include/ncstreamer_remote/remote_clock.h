@@ -0,0 +1,59 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_REMOTE_CLOCK_H_
+#define NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_REMOTE_CLOCK_H_
+
+
+#ifdef NCSTREAMER_REMOTE_DLL_EXPORTS
+#define NCSTREAMER_REMOTE_DLL_API __declspec(dllexport)
+#else
+#define NCSTREAMER_REMOTE_DLL_API __declspec(dllimport)
+#endif
+
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "boost/asio/io_service.hpp"
+
+
+namespace ncstreamer_remote {
+/// Time of NcStreamerRemote: its timeouts, retries and deadlines.
+/// The steady clock by default; a SimulatedClock runs hours of reconnects
+/// and retries in milliseconds, e.g. in tests.
+/// Durations measured for RemoteStats always use the steady clock.
+class RemoteClock {
+ public:
+  /// @param expired False if the timer is cancelled or rearmed first.
+  using TimerHandler = std::function<void(bool expired)>;
+
+  /// Like a steady timer of asio: its handlers run through the io service
+  /// it is made for, and calls to it must be serialized.
+  class Timer {
+   public:
+    virtual ~Timer() {}
+
+    /// Cancels the wait in progress, if any.
+    virtual void ExpiresAfter(std::int64_t delay_ns) = 0;
+    virtual void AsyncWait(TimerHandler &&handler) = 0;
+    virtual void Cancel() = 0;
+  };
+
+  static NCSTREAMER_REMOTE_DLL_API std::shared_ptr<RemoteClock> CreateSteady();
+
+  virtual ~RemoteClock() {}
+
+  /// Nanoseconds since an arbitrary epoch, never going backwards.
+  virtual std::int64_t NowNs() const = 0;
+
+  virtual std::unique_ptr<Timer> CreateTimer(
+      boost::asio::io_service *io_service) = 0;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_REMOTE_CLOCK_H_
@@ -0,0 +1,350 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_REMOTE_FUTURE_H_
+#define NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_REMOTE_FUTURE_H_
+
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif  // defined(__cpp_impl_coroutine)
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/error/error_types.h"
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/unique_function.h"
+
+
+namespace ncstreamer_remote {
+/// Error of a request, as passed to the error handlers.
+struct RemoteError {
+  /// ErrorCategory::kNoCategory if the request has succeeded.
+  ErrorCategory category;
+  int err_code;
+  std::wstring err_msg;
+};
+
+
+/// Response to a status request.
+struct StatusResponse {
+  /// One of ['standby', 'setup', 'starting', 'onAir', 'stopping']
+  std::wstring status;
+  std::wstring source_title;
+  std::wstring user_name;
+  std::wstring quality;
+};
+
+
+/// Either the response to a request, or its error.
+template <typename T>
+struct RemoteResult {
+  RemoteError error;
+
+  /// Default constructed if the request has failed.
+  T value;
+};
+
+
+/// Runs a task right away, on the thread completing the request.
+struct InlineExecutor {
+  void operator()(UniqueFunction<void()> &&task) const {
+    task();
+  }
+};
+
+
+template <typename T>
+class RemotePromise;
+
+
+/// Result of a request to come. The promises and the future share one
+/// allocation, and continuations are stored without std::function.
+/// A future is consumed once: by Then, by Get, or by co_await.
+template <typename T>
+class RemoteFuture {
+ public:
+  using Result = RemoteResult<T>;
+  using Continuation = UniqueFunction<void(Result &&result)>;
+
+  RemoteFuture()
+      : state_{} {}
+
+  RemoteFuture(RemoteFuture &&other)
+      : state_{std::move(other.state_)} {}
+
+  RemoteFuture &operator=(RemoteFuture &&other) {
+    state_ = std::move(other.state_);
+    return *this;
+  }
+
+  bool IsValid() const {
+    return static_cast<bool>(state_);
+  }
+
+  /// False for a future without a request, e.g. default constructed.
+  bool IsReady() const {
+    return state_ && state_->IsReady();
+  }
+
+  /// Calls the continuation on the io thread as soon as the result is
+  /// set, or right away on this thread if it is already set.
+  void Then(Continuation &&continuation) {
+    state_->SetContinuation(std::move(continuation));
+  }
+
+  /// Calls the continuation through the executor, e.g. one posting it
+  /// to the thread of the caller.
+  /// @param executor Callable with a UniqueFunction<void()> task.
+  template <typename Executor>
+  void Then(const Executor &executor, Continuation &&continuation) {
+    state_->SetContinuation(Continuation{
+        ResumeOn<Executor>{executor, std::move(continuation)}});
+  }
+
+  /// Blocks until the result is set. Never call it on the io thread,
+  /// e.g. from a handler, as the result would never come.
+  Result Get() {
+    return state_->Wait();
+  }
+
+#if defined(__cpp_impl_coroutine)
+  template <typename Executor>
+  class Awaiter {
+   public:
+    Awaiter(RemoteFuture *future, const Executor &executor)
+        : future_{future},
+          executor_{executor},
+          suspended_{false},
+          result_{} {}
+
+    /// A result already set is taken without suspending.
+    bool await_ready() const {
+      return future_->IsReady();
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+      suspended_ = true;
+      future_->Then(executor_, Continuation{[this, handle](Result &&result) {
+        result_ = std::move(result);
+        handle.resume();
+      }});
+    }
+
+    Result await_resume() {
+      if (suspended_ == false) {
+        return future_->Get();  // ready, so it doesn't block.
+      }
+      return std::move(result_);
+    }
+
+   private:
+    RemoteFuture *future_;
+    Executor executor_;
+    bool suspended_;
+    Result result_;
+  };
+
+  /// co_await future.On(executor) resumes the coroutine through
+  /// the executor, instead of on the io thread.
+  template <typename Executor>
+  Awaiter<Executor> On(const Executor &executor) {
+    return Awaiter<Executor>{this, executor};
+  }
+
+  Awaiter<InlineExecutor> operator co_await() {
+    return Awaiter<InlineExecutor>{this, InlineExecutor{}};
+  }
+#endif  // defined(__cpp_impl_coroutine)
+
+ private:
+  friend class RemotePromise<T>;
+
+  class State {
+   public:
+    explicit State(const RemoteError &broken_error)
+        : mutex_{},
+          ready_cv_{},
+          ready_{false},
+          result_{},
+          continuation_{},
+          promise_count_{1},
+          broken_error_(broken_error) {}
+
+    void AddPromise() {
+      ++promise_count_;
+    }
+
+    /// Sets the broken error if the last promise goes away
+    /// without setting the result.
+    void RemovePromise() {
+      if (--promise_count_ == 0) {
+        SetResult(Result{broken_error_, T{}});
+      }
+    }
+
+    bool IsReady() {
+      std::lock_guard<std::mutex> lock{mutex_};
+      return ready_;
+    }
+
+    /// Does nothing but for the first call.
+    void SetResult(Result &&result) {
+      Continuation continuation;
+      {
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (ready_ == true) {
+          return;
+        }
+        result_ = std::move(result);
+        ready_ = true;
+        continuation = std::move(continuation_);
+      }
+      ready_cv_.notify_all();
+      if (continuation) {
+        continuation(std::move(result_));
+      }
+    }
+
+    void SetContinuation(Continuation &&continuation) {
+      {
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (ready_ == false) {
+          continuation_ = std::move(continuation);
+          return;
+        }
+      }
+      continuation(std::move(result_));
+    }
+
+    Result Wait() {
+      std::unique_lock<std::mutex> lock{mutex_};
+      ready_cv_.wait(lock, [this]() {
+        return ready_;
+      });
+      return std::move(result_);
+    }
+
+   private:
+    std::mutex mutex_;
+    std::condition_variable ready_cv_;
+    bool ready_;
+    Result result_;
+    Continuation continuation_;
+
+    /// The promises count apart from the future, which shares the state.
+    std::atomic<int> promise_count_;
+    const RemoteError broken_error_;
+  };
+
+  template <typename Executor>
+  class ResumeOn {
+   public:
+    ResumeOn(const Executor &executor, Continuation &&continuation)
+        : executor_{executor},
+          continuation_{std::move(continuation)} {}
+
+    ResumeOn(ResumeOn &&other)
+        : executor_{std::move(other.executor_)},
+          continuation_{std::move(other.continuation_)} {}
+
+    void operator()(Result &&result) {
+      executor_(UniqueFunction<void()>{
+          Resume{std::move(continuation_), std::move(result)}});
+    }
+
+   private:
+    Executor executor_;
+    Continuation continuation_;
+  };
+
+  class Resume {
+   public:
+    Resume(Continuation &&continuation, Result &&result)
+        : continuation_{std::move(continuation)},
+          result_(std::move(result)) {}
+
+    Resume(Resume &&other)
+        : continuation_{std::move(other.continuation_)},
+          result_(std::move(other.result_)) {}
+
+    void operator()() {
+      continuation_(std::move(result_));
+    }
+
+   private:
+    Continuation continuation_;
+    Result result_;
+  };
+
+  explicit RemoteFuture(const std::shared_ptr<State> &state)
+      : state_{state} {}
+
+  RemoteFuture(const RemoteFuture &) = delete;
+  RemoteFuture &operator=(const RemoteFuture &) = delete;
+
+  std::shared_ptr<State> state_;
+};
+
+
+/// Sets the result of a RemoteFuture once, from the handlers of a request.
+/// Copies share one result. If the last copy goes away without setting it,
+/// e.g. as the handlers of a cancelled request are released without being
+/// called, the future gets the broken error instead of waiting forever.
+template <typename T>
+class RemotePromise {
+ public:
+  explicit RemotePromise(const RemoteError &broken_error)
+      : state_{std::make_shared<State>(broken_error)} {}
+
+  RemotePromise(const RemotePromise &other)
+      : state_{other.state_} {
+    state_->AddPromise();
+  }
+
+  RemotePromise(RemotePromise &&other)
+      : state_{std::move(other.state_)} {}
+
+  virtual ~RemotePromise() {
+    if (state_) {
+      state_->RemovePromise();
+    }
+  }
+
+  RemoteFuture<T> GetFuture() const {
+    return RemoteFuture<T>{state_};
+  }
+
+  void SetValue(T value) const {
+    state_->SetResult(RemoteResult<T>{
+        RemoteError{ErrorCategory::kNoCategory, 0, std::wstring{}},
+        std::move(value)});
+  }
+
+  void SetError(
+      ErrorCategory category,
+      int err_code,
+      const std::wstring &err_msg) const {
+    state_->SetResult(RemoteResult<T>{
+        RemoteError{category, err_code, err_msg},
+        T{}});
+  }
+
+ private:
+  using State = typename RemoteFuture<T>::State;
+
+  RemotePromise &operator=(const RemotePromise &) = delete;
+  RemotePromise &operator=(RemotePromise &&) = delete;
+
+  std::shared_ptr<State> state_;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_REMOTE_FUTURE_H_
@@ -0,0 +1,124 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_REMOTE_STATS_H_
+#define NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_REMOTE_STATS_H_
+
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace ncstreamer_remote {
+/// Counters of NcStreamerRemote since SetUp.
+struct RemoteStats {
+  /// RequestStatus calls, including the ones served by coalescing.
+  std::uint64_t status_requests;
+
+  /// Status requests actually sent to NCStreamer.
+  std::uint64_t status_requests_sent;
+
+  /// Status requests attached to one already in flight,
+  /// i.e. the number of wire requests saved.
+  std::uint64_t status_requests_coalesced;
+
+  /// RequestQualityUpdate calls.
+  std::uint64_t quality_updates;
+
+  /// Quality updates actually sent to NCStreamer.
+  std::uint64_t quality_updates_sent;
+
+  /// Debounced quality updates replaced by a later one before being sent.
+  std::uint64_t quality_updates_superseded;
+
+  /// Requests accepted into the request queue.
+  std::uint64_t requests_queued;
+
+  /// Requests taken out of the queue to be sent.
+  std::uint64_t requests_dispatched;
+
+  /// Requests refused with Error::Connection::kQueueFull.
+  std::uint64_t requests_rejected;
+
+  /// Queued requests evicted with Error::Connection::kDropped.
+  std::uint64_t requests_dropped;
+
+  /// Requests withdrawn by their CancellationToken, and the responses
+  /// to cancelled requests dropped on arrival.
+  std::uint64_t requests_cancelled;
+  std::uint64_t cancelled_responses_dropped;
+
+  /// Requests over their RateLimit, by what was done with them, and the
+  /// time the delayed ones were held, in microseconds.
+  std::uint64_t requests_throttle_rejected;
+  std::uint64_t requests_throttle_delayed;
+  std::uint64_t requests_throttle_merged;
+  std::uint64_t throttle_delay_us_total;
+
+  /// Requests waiting in the queue now, and the most ever.
+  std::uint64_t queue_depth;
+  std::uint64_t queue_depth_max;
+
+  /// Time spent in the queue by the dispatched requests, in microseconds.
+  /// The average is queue_wait_us_total / requests_dispatched.
+  std::uint64_t queue_wait_us_total;
+  std::uint64_t queue_wait_us_max;
+
+  /// RequestBatch calls.
+  std::uint64_t batch_requests;
+
+  /// Batches sent item by item, as NCStreamer doesn't support batches.
+  std::uint64_t batch_fallbacks;
+
+  /// Frames and their payload bytes, both ways.
+  /// Binary ones are MessagePack, the others JSON.
+  std::uint64_t messages_sent;
+  std::uint64_t binary_messages_sent;
+  std::uint64_t bytes_sent;
+  std::uint64_t messages_received;
+  std::uint64_t binary_messages_received;
+  std::uint64_t bytes_received;
+
+  /// CPU time spent encoding requests, excluding cached payloads,
+  /// and decoding everything received, in nanoseconds.
+  std::uint64_t messages_encoded;
+  std::uint64_t encode_ns_total;
+  std::uint64_t decode_ns_total;
+
+  /// Start/stop events delivered, and replayed ones dropped as duplicates.
+  std::uint64_t events_received;
+  std::uint64_t events_duplicated;
+
+  /// Reconnects that resumed the event stream, and the ones that needed
+  /// a full status request instead.
+  std::uint64_t resumes;
+  std::uint64_t resyncs;
+
+  /// Port discoveries started, and the ones no NCStreamer answered.
+  std::uint64_t port_discoveries;
+  std::uint64_t port_discovery_failures;
+
+  /// Tasks handed over to the io threads, and the time from handing one
+  /// over until it runs, in nanoseconds. This is mostly the wakeup of a
+  /// sleeping io thread, which IoThreadPolicy::spin_us avoids.
+  std::uint64_t io_tasks;
+  std::uint64_t io_task_latency_ns_total;
+  std::uint64_t io_task_latency_ns_max;
+
+  /// User callbacks run, the ones over the budget of SetCallbackBudget,
+  /// and the event callbacks run off the io threads.
+  std::uint64_t callbacks;
+  std::uint64_t callbacks_slow;
+  std::uint64_t callbacks_offloaded;
+
+  /// Durations of the user callbacks: bucket i counts the ones shorter
+  /// than 16 << i microseconds, and the last bucket the longer ones.
+  static const std::size_t kCallbackHistogramSize = 12;
+  std::uint64_t callback_us_histogram[kCallbackHistogramSize];
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_REMOTE_STATS_H_
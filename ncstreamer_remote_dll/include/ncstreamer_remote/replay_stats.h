@@ -0,0 +1,35 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_REPLAY_STATS_H_
+#define NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_REPLAY_STATS_H_
+
+
+#include <cstdint>
+
+
+namespace ncstreamer_remote {
+/// Outcome of NcStreamerRemote::Replay.
+struct ReplayStats {
+  /// False if the file is not a capture.
+  bool succeeded;
+
+  /// Received frames fed through the handlers, and their payload bytes.
+  std::uint64_t frames;
+  std::uint64_t bytes;
+
+  /// Sent frames, which are only recorded.
+  std::uint64_t frames_skipped;
+
+  /// Opens, fails and closes of the connection.
+  std::uint64_t connection_events;
+
+  /// From feeding the first record until the last one is handled.
+  std::uint64_t elapsed_ns;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_REPLAY_STATS_H_
@@ -0,0 +1,80 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_SIMULATED_CLOCK_H_
+#define NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_SIMULATED_CLOCK_H_
+
+
+#ifdef NCSTREAMER_REMOTE_DLL_EXPORTS
+#define NCSTREAMER_REMOTE_DLL_API __declspec(dllexport)
+#else
+#define NCSTREAMER_REMOTE_DLL_API __declspec(dllimport)
+#endif
+
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/remote_clock.h"
+
+
+namespace ncstreamer_remote {
+class IoPool;
+
+
+/// Clock which moves only when told to, for deterministic tests.
+/// Timers expire in the order of their deadlines, and of their arming
+/// for equal deadlines. Expired handlers are posted to their io services,
+/// so run them, e.g. with IoPool::Poll of a manual pool, before moving on.
+class SimulatedClock : public RemoteClock {
+ public:
+  static NCSTREAMER_REMOTE_DLL_API std::shared_ptr<SimulatedClock> Create();
+
+  virtual NCSTREAMER_REMOTE_DLL_API ~SimulatedClock();
+
+  std::int64_t NCSTREAMER_REMOTE_DLL_API NowNs() const override;
+
+  std::unique_ptr<Timer> NCSTREAMER_REMOTE_DLL_API CreateTimer(
+      boost::asio::io_service *io_service) override;
+
+  /// Moves the time on through the deadlines due meanwhile, one at a time.
+  /// The timers due at a deadline expire with the time set to it, and
+  /// their handlers run before the next one, so that a handler arming
+  /// a timer again sees the time of its own deadline.
+  /// This one waits for the threads of the io pools to run the handlers,
+  /// so never call it with timers of a manual pool.
+  void NCSTREAMER_REMOTE_DLL_API AdvanceBy(std::int64_t duration_ns);
+
+  /// Like the above, for the timers of a manual pool,
+  /// whose handlers are run with IoPool::Poll on this thread.
+  void NCSTREAMER_REMOTE_DLL_API AdvanceBy(
+      std::int64_t duration_ns,
+      IoPool *manual_pool);
+
+  /// Moves the time to the first deadline, and expires the timers due then.
+  /// @return False if no timer is armed.
+  bool NCSTREAMER_REMOTE_DLL_API AdvanceToNextTimer();
+
+  /// Timers armed now, and timers expired so far, i.e. the wakeups
+  /// a steady clock would have taken.
+  std::size_t NCSTREAMER_REMOTE_DLL_API GetArmedTimerCount() const;
+  std::uint64_t NCSTREAMER_REMOTE_DLL_API GetExpiredTimerCount() const;
+
+ private:
+  class SimulatedTimer;
+  class State;
+
+  SimulatedClock();
+
+  SimulatedClock(const SimulatedClock &) = delete;
+  SimulatedClock &operator=(const SimulatedClock &) = delete;
+
+  std::shared_ptr<State> state_;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_SIMULATED_CLOCK_H_
@@ -0,0 +1,36 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_STREAMER_STATUS_H_
+#define NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_STREAMER_STATUS_H_
+
+
+#include <cstdint>
+#include <string>
+
+
+namespace ncstreamer_remote {
+/// Snapshot of the NCStreamer state, mirrored from status responses and
+/// from start/stop events.
+struct StreamerStatus {
+  /// Increases on every change. 0 means never refreshed.
+  std::uint64_t version;
+
+  /// Steady clock milliseconds of the last refresh.
+  std::int64_t updated_at_ms;
+
+  /// One of ['standby', 'setup', 'starting', 'onAir', 'stopping'],
+  /// or empty while the state is unknown, e.g. disconnected.
+  std::wstring status;
+  std::wstring source_title;
+  std::wstring user_name;
+  std::wstring quality;
+  std::wstring stream_url;
+  std::wstring post_url;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_STREAMER_STATUS_H_
@@ -0,0 +1,192 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_UNIQUE_FUNCTION_H_
+#define NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_UNIQUE_FUNCTION_H_
+
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace ncstreamer_remote {
+template <typename Signature>
+class UniqueFunction;
+
+
+/// Move-only counterpart of std::function.
+/// Callables up to kInlineSize bytes, including a whole std::function,
+/// are stored in place, so that no heap allocation happens for them.
+template <typename R, typename... Args>
+class UniqueFunction<R(Args...)> {
+ public:
+  static const std::size_t kInlineSize{
+      sizeof(std::function<R(Args...)>) > 8 * sizeof(void *) ?
+      sizeof(std::function<R(Args...)>) : 8 * sizeof(void *)};
+
+  UniqueFunction()
+      : ops_{nullptr},
+        storage_{} {}
+
+  UniqueFunction(std::nullptr_t)  // NOLINT
+      : ops_{nullptr},
+        storage_{} {}
+
+  template <typename F,
+            typename = typename std::enable_if<!std::is_same<
+                typename std::decay<F>::type, UniqueFunction>::value>::type>
+  explicit UniqueFunction(F &&f)
+      : ops_{nullptr},
+        storage_{} {
+    using Callable = typename std::decay<F>::type;
+    if (IsEmpty(f) == true) {
+      return;
+    }
+    Construct<Callable>(std::forward<F>(f), IsInlined<Callable>{});
+  }
+
+  UniqueFunction(UniqueFunction &&other)
+      : ops_{nullptr},
+        storage_{} {
+    MoveFrom(&other);
+  }
+
+  ~UniqueFunction() {
+    Reset();
+  }
+
+  UniqueFunction &operator=(UniqueFunction &&other) {
+    if (this != &other) {
+      Reset();
+      MoveFrom(&other);
+    }
+    return *this;
+  }
+
+  UniqueFunction &operator=(std::nullptr_t) {
+    Reset();
+    return *this;
+  }
+
+  explicit operator bool() const {
+    return ops_ != nullptr;
+  }
+
+  R operator()(Args... args) const {
+    return ops_->invoke(&storage_, std::forward<Args>(args)...);
+  }
+
+  void Reset() {
+    if (ops_) {
+      ops_->destroy(&storage_);
+      ops_ = nullptr;
+    }
+  }
+
+ private:
+  using Storage = typename std::aligned_storage<kInlineSize>::type;
+
+  struct Ops {
+    R (*invoke)(Storage *storage, Args &&...args);
+    void (*move)(Storage *to, Storage *from);
+    void (*destroy)(Storage *storage);
+  };
+
+  template <typename Callable>
+  using IsInlined = std::integral_constant<bool,
+      sizeof(Callable) <= sizeof(Storage) &&
+      std::alignment_of<Storage>::value %
+          std::alignment_of<Callable>::value == 0 &&
+      std::is_nothrow_move_constructible<Callable>::value>;
+
+  template <typename Callable>
+  struct InlinedOps {
+    static Callable *Get(Storage *storage) {
+      return reinterpret_cast<Callable *>(storage);
+    }
+    static R Invoke(Storage *storage, Args &&...args) {
+      return (*Get(storage))(std::forward<Args>(args)...);
+    }
+    static void Move(Storage *to, Storage *from) {
+      ::new (to) Callable(std::move(*Get(from)));
+      Get(from)->~Callable();
+    }
+    static void Destroy(Storage *storage) {
+      Get(storage)->~Callable();
+    }
+    static const Ops *Table() {
+      static const Ops kOps{&Invoke, &Move, &Destroy};
+      return &kOps;
+    }
+  };
+
+  template <typename Callable>
+  struct AllocatedOps {
+    static Callable *&Get(Storage *storage) {
+      return *reinterpret_cast<Callable **>(storage);
+    }
+    static R Invoke(Storage *storage, Args &&...args) {
+      return (*Get(storage))(std::forward<Args>(args)...);
+    }
+    static void Move(Storage *to, Storage *from) {
+      ::new (to) Callable *{Get(from)};
+    }
+    static void Destroy(Storage *storage) {
+      delete Get(storage);
+    }
+    static const Ops *Table() {
+      static const Ops kOps{&Invoke, &Move, &Destroy};
+      return &kOps;
+    }
+  };
+
+  template <typename Callable, typename F>
+  void Construct(F &&f, std::true_type /*inlined*/) {
+    ::new (&storage_) Callable(std::forward<F>(f));
+    ops_ = InlinedOps<Callable>::Table();
+  }
+
+  template <typename Callable, typename F>
+  void Construct(F &&f, std::false_type /*inlined*/) {
+    ::new (&storage_) Callable *{new Callable(std::forward<F>(f))};
+    ops_ = AllocatedOps<Callable>::Table();
+  }
+
+  template <typename F>
+  static bool IsEmpty(const F &/*f*/) {
+    return false;
+  }
+
+  template <typename Signature>
+  static bool IsEmpty(const std::function<Signature> &f) {
+    return !f;
+  }
+
+  template <typename T>
+  static bool IsEmpty(T *f) {
+    return f == nullptr;
+  }
+
+  void MoveFrom(UniqueFunction *other) {
+    if (other->ops_) {
+      other->ops_->move(&storage_, &other->storage_);
+      ops_ = other->ops_;
+      other->ops_ = nullptr;
+    }
+  }
+
+  UniqueFunction(const UniqueFunction &) = delete;
+  UniqueFunction &operator=(const UniqueFunction &) = delete;
+
+  const Ops *ops_;
+  mutable Storage storage_;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_UNIQUE_FUNCTION_H_
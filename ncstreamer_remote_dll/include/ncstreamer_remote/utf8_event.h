@@ -0,0 +1,40 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_UTF8_EVENT_H_
+#define NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_UTF8_EVENT_H_
+
+
+#include <cstddef>
+
+
+namespace ncstreamer_remote {
+/// UTF-8 bytes as NCStreamer sent them, not null terminated.
+/// Valid only during the handler it is passed to.
+struct Utf8View {
+  const char *data;
+  std::size_t size;
+};
+
+
+struct Utf8StartEvent {
+  Utf8View source_title;
+  Utf8View user_page;
+  Utf8View privacy;
+  Utf8View description;
+  Utf8View mic;
+  Utf8View service_provider;
+  Utf8View stream_url;
+  Utf8View post_url;
+};
+
+
+struct Utf8StopEvent {
+  Utf8View source_title;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_INCLUDE_NCSTREAMER_REMOTE_UTF8_EVENT_H_
@@ -0,0 +1,136 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/src/callback_watchdog.h"
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/io_pool.h"
+
+
+namespace ncstreamer_remote {
+CallbackWatchdog::CallbackWatchdog(StatsRecorder *stats)
+    : stats_{stats},
+      budget_us_{0},
+      offload_after_{0},
+      slow_callback_handler_mutex_{},
+      slow_callback_handler_{},
+      event_overruns_in_row_{0},
+      events_offloaded_{false},
+      events_inline_requested_{false},
+      events_offloaded_pending_{0},
+      offload_pool_{} {
+}
+
+
+CallbackWatchdog::~CallbackWatchdog() {
+  Stop();
+}
+
+
+void CallbackWatchdog::SetBudget(
+    std::uint32_t budget_us,
+    const SlowCallbackHandler &slow_callback_handler,
+    std::uint32_t offload_after) {
+  {
+    std::lock_guard<std::mutex> lock{slow_callback_handler_mutex_};
+    slow_callback_handler_ = slow_callback_handler;
+  }
+  offload_after_ = offload_after;
+  budget_us_ = budget_us;
+  event_overruns_in_row_ = 0;
+  if (events_offloaded_ == true) {
+    events_inline_requested_ = true;
+  }
+}
+
+
+void CallbackWatchdog::RunEvent(
+    CallbackKind kind,
+    const std::function<void()> &callback) {
+  // only the io threads come here, one at a time.
+  if (events_offloaded_ == true &&
+      events_inline_requested_ == true &&
+      events_offloaded_pending_ == 0) {
+    // the offloaded ones have run, so this one keeps the order.
+    events_inline_requested_ = false;
+    events_offloaded_ = false;
+  }
+  if (events_offloaded_ == false) {
+    Run(kind, callback);
+    return;
+  }
+
+  if (!offload_pool_) {
+    offload_pool_ = IoPool::Create(1);
+  }
+  StatsRecorder::Increase(&stats_->callbacks_offloaded);
+  ++events_offloaded_pending_;
+  offload_pool_->io_service().post([this, kind, callback]() {
+    Run(kind, callback);
+    --events_offloaded_pending_;
+  });
+}
+
+
+void CallbackWatchdog::Stop() {
+  if (offload_pool_) {
+    offload_pool_->Stop();
+  }
+}
+
+
+void CallbackWatchdog::Record(CallbackKind kind, std::int64_t begin_ns) {
+  std::int64_t elapsed_ns = StatsRecorder::NowNs() - begin_ns;
+  std::uint64_t elapsed_us =
+      elapsed_ns > 0 ? static_cast<std::uint64_t>(elapsed_ns) / 1000 : 0;
+
+  std::size_t bucket{0};
+  while (bucket + 1 < RemoteStats::kCallbackHistogramSize &&
+         elapsed_us >= (16ULL << bucket)) {
+    ++bucket;
+  }
+  StatsRecorder::Increase(&stats_->callbacks);
+  StatsRecorder::Increase(&stats_->callback_us_histogram[bucket]);
+
+  std::uint32_t budget_us = budget_us_;
+  if (budget_us == 0) {
+    return;
+  }
+  if (elapsed_us <= budget_us) {
+    if (IsEvent(kind) == true) {
+      event_overruns_in_row_ = 0;
+    }
+    return;
+  }
+
+  StatsRecorder::Increase(&stats_->callbacks_slow);
+  std::uint32_t offload_after = offload_after_;
+  if (IsEvent(kind) == true &&
+      ++event_overruns_in_row_ >= offload_after &&
+      offload_after != 0) {
+    events_inline_requested_ = false;
+    events_offloaded_ = true;
+  }
+
+  SlowCallbackHandler slow_callback_handler{};
+  {
+    std::lock_guard<std::mutex> lock{slow_callback_handler_mutex_};
+    slow_callback_handler = slow_callback_handler_;
+  }
+  if (slow_callback_handler) {
+    slow_callback_handler(
+        kind,
+        elapsed_us > UINT32_MAX ?
+            UINT32_MAX : static_cast<std::uint32_t>(elapsed_us));
+  }
+}
+
+
+bool CallbackWatchdog::IsEvent(CallbackKind kind) {
+  return kind == CallbackKind::kConnect ||
+         kind == CallbackKind::kDisconnect ||
+         kind == CallbackKind::kStartEvent ||
+         kind == CallbackKind::kStopEvent;
+}
+}  // namespace ncstreamer_remote
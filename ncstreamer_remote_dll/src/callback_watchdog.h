@@ -0,0 +1,83 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_SRC_CALLBACK_WATCHDOG_H_
+#define NCSTREAMER_REMOTE_DLL_SRC_CALLBACK_WATCHDOG_H_
+
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/callback_kind.h"
+#include "ncstreamer_remote_dll/src/stats_recorder.h"
+
+
+namespace ncstreamer_remote {
+class IoPool;
+
+
+/// Times the user callbacks, and warns about the ones over the budget.
+/// Event callbacks which keep going over the budget are moved to a thread
+/// of their own, so that they don't hold up the io threads. They stay in
+/// order, as all the event callbacks move together.
+class CallbackWatchdog {
+ public:
+  using SlowCallbackHandler = std::function<void(
+      CallbackKind kind,
+      std::uint32_t elapsed_us)>;
+
+  explicit CallbackWatchdog(StatsRecorder *stats);
+  virtual ~CallbackWatchdog();
+
+  /// May be called from any thread. Offloaded event callbacks come back
+  /// to the io threads, once the ones offloaded so far have run.
+  /// @param budget_us Zero turns the warnings and the offloading off.
+  /// @param offload_after Event callbacks over the budget this many times
+  ///     in a row are offloaded from then on. Zero never offloads.
+  void SetBudget(
+      std::uint32_t budget_us,
+      const SlowCallbackHandler &slow_callback_handler,
+      std::uint32_t offload_after);
+
+  /// Runs the callback here, timing it.
+  template <typename Callback>
+  void Run(CallbackKind kind, const Callback &callback) {
+    std::int64_t begin_ns = StatsRecorder::NowNs();
+    callback();
+    Record(kind, begin_ns);
+  }
+
+  /// Runs an event callback here, or on the offload thread once
+  /// the event callbacks are offloaded.
+  void RunEvent(CallbackKind kind, const std::function<void()> &callback);
+
+  /// Waits for the offloaded callbacks running, and drops the others.
+  void Stop();
+
+ private:
+  void Record(CallbackKind kind, std::int64_t begin_ns);
+
+  static bool IsEvent(CallbackKind kind);
+
+  StatsRecorder *const stats_;
+
+  std::atomic<std::uint32_t> budget_us_;
+  std::atomic<std::uint32_t> offload_after_;
+  std::mutex slow_callback_handler_mutex_;
+  SlowCallbackHandler slow_callback_handler_;
+
+  std::atomic<std::uint32_t> event_overruns_in_row_;
+  std::atomic_bool events_offloaded_;
+  std::atomic_bool events_inline_requested_;  // by SetBudget.
+  std::atomic<std::uint32_t> events_offloaded_pending_;
+  std::shared_ptr<IoPool> offload_pool_;  // made on the first offload.
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_SRC_CALLBACK_WATCHDOG_H_
@@ -0,0 +1,32 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/src/cancellation_relay.h"
+
+
+namespace ncstreamer_remote {
+CancellationRelay::CancellationRelay(const CancelHandler &cancel_handler)
+    : mutex_{},
+      cancel_handler_{cancel_handler} {
+}
+
+
+CancellationRelay::~CancellationRelay() {
+}
+
+
+void CancellationRelay::OnCancelled(const CancellationToken &token) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (cancel_handler_) {
+    cancel_handler_(token);
+  }
+}
+
+
+void CancellationRelay::Detach() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  cancel_handler_ = nullptr;
+}
+}  // namespace ncstreamer_remote
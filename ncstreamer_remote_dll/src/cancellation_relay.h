@@ -0,0 +1,38 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_SRC_CANCELLATION_RELAY_H_
+#define NCSTREAMER_REMOTE_DLL_SRC_CANCELLATION_RELAY_H_
+
+
+#include <functional>
+#include <mutex>  // NOLINT
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/cancellation_token.h"
+
+
+namespace ncstreamer_remote {
+/// Passes the cancellations of tokens to a handler, until detached.
+/// Tokens hold it weakly, so it may outlive its owner for a while.
+class CancellationRelay : public CancellationToken::Listener {
+ public:
+  using CancelHandler = std::function<void(const CancellationToken &token)>;
+
+  explicit CancellationRelay(const CancelHandler &cancel_handler);
+  virtual ~CancellationRelay();
+
+  void OnCancelled(const CancellationToken &token) override;
+
+  /// The handler is never called once this returns.
+  void Detach();
+
+ private:
+  std::mutex mutex_;
+  CancelHandler cancel_handler_;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_SRC_CANCELLATION_RELAY_H_
@@ -0,0 +1,84 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/cancellation_token.h"
+
+#include <algorithm>
+#include <mutex>  // NOLINT
+#include <vector>
+
+
+namespace ncstreamer_remote {
+struct CancellationToken::State {
+  State()
+      : mutex{},
+        cancelled{false},
+        listeners{} {}
+
+  std::mutex mutex;
+  bool cancelled;
+  std::vector<std::weak_ptr<Listener>> listeners;
+};
+
+
+CancellationToken CancellationToken::Create() {
+  return CancellationToken{std::make_shared<State>()};
+}
+
+
+void CancellationToken::Cancel() const {
+  if (!state_) {
+    return;
+  }
+  std::vector<std::weak_ptr<Listener>> listeners{};
+  {
+    std::lock_guard<std::mutex> lock{state_->mutex};
+    if (state_->cancelled == true) {
+      return;
+    }
+    state_->cancelled = true;
+    listeners.swap(state_->listeners);
+  }
+  for (const auto &weak_listener : listeners) {
+    if (auto listener = weak_listener.lock()) {
+      listener->OnCancelled(*this);
+    }
+  }
+}
+
+
+bool CancellationToken::IsCancelled() const {
+  if (!state_) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock{state_->mutex};
+  return state_->cancelled;
+}
+
+
+bool CancellationToken::AddListener(
+    const std::shared_ptr<Listener> &listener) const {
+  if (!state_) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock{state_->mutex};
+  if (state_->cancelled == true) {
+    return false;
+  }
+  auto &listeners = state_->listeners;
+  listeners.erase(std::remove_if(
+      listeners.begin(),
+      listeners.end(),
+      [](const std::weak_ptr<Listener> &l) { return l.expired(); }),
+      listeners.end());
+  for (const auto &l : listeners) {
+    if (l.lock() == listener) {
+      return true;
+    }
+  }
+  listeners.emplace_back(listener);
+  return true;
+}
+}  // namespace ncstreamer_remote
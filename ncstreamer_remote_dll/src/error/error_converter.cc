@@ -5,101 +5,156 @@
 
 #include "ncstreamer_remote_dll/src/error/error_converter.h"
 
-#include <unordered_map>
+#include <cstring>
 
 #include "ncstreamer_remote_dll/src/ncstreamer_remote_message_types.h"
 
 
+namespace {
+using ncstreamer_remote::Error;
+using ncstreamer_remote::ErrorDescription;
+using RemoteError = ncstreamer::RemoteMessage::Error;
+
+
+/// Error IDs are compared in place, as there are only a few of them.
+template <typename ErrorCode>
+struct ErrorEntry {
+  const char *id;
+  ErrorCode err_code;
+  ErrorDescription description;
+};
+
+
+/// In the order of Error::Connection, from kNoNcStreamer.
+const ErrorDescription kConnectionErrors[] = {
+    ErrorDescription{"NCStreamer is not running"},
+    ErrorDescription{"your previous request is not responded yet"},
+    ErrorDescription{
+        "an error occurred while initializing NCStreamer-Remote module"},
+    ErrorDescription{"couldn't try to connect to NCStreamer"},
+    ErrorDescription{"couldn't try to send message to NCStreamer"},
+    ErrorDescription{"failed to connect to NCStreamer"},
+    ErrorDescription{"the connection to NCStreamer is closed"},
+    ErrorDescription{"your request is superseded by a newer one"},
+    ErrorDescription{"the request queue is full"},
+    ErrorDescription{"your request is dropped from the full request queue"},
+    ErrorDescription{"no NCStreamer answers on the candidate ports"},
+    ErrorDescription{"NCStreamer-Remote is shutting down"},
+    ErrorDescription{"the request is over the rate limit"},
+    ErrorDescription{"the request is cancelled"},
+    ErrorDescription{"NCStreamer responded with a broken message"}};
+
+static_assert(
+    sizeof(kConnectionErrors) / sizeof(kConnectionErrors[0]) ==
+        static_cast<int>(Error::Connection::kBadResponse) -
+        static_cast<int>(Error::Connection::kNoNcStreamer) + 1,
+    "a description is missing from kConnectionErrors");
+
+const ErrorDescription kUnknownConnectionError{"unknown error code"};
+
+
+const ErrorEntry<Error::Start> kStartErrors[] = {
+    {RemoteError::Start::kNoUser,
+     Error::Start::kNoUser,
+     ErrorDescription{
+         "you are not logged in to any streaming service provider"}},
+    {RemoteError::Start::kNotStandbySelf,
+     Error::Start::kNotStandbySelf,
+     ErrorDescription{"NCStreamer is already on streaming your source"}},
+    {RemoteError::Start::kNotStandbyOther,
+     Error::Start::kNotStandbyOther,
+     ErrorDescription{"NCStreamer is already on streaming other's source"}},
+    {RemoteError::Start::kUnknownTitle,
+     Error::Start::kUnknownTitle,
+     ErrorDescription{
+         "the source doesn't exist in the available source list"}},
+    {RemoteError::Start::kMePageSelectEmpty,
+     Error::Start::kMePageSelectEmpty,
+     ErrorDescription{
+         "select page type where the live video is posted, please"}},
+    {RemoteError::Start::kPrivacySelectEmpty,
+     Error::Start::kPrivacySelectEmpty,
+     ErrorDescription{
+         "select privacy to whom the live video is visible, please"}},
+    {RemoteError::Start::kOwnPageSelectEmpty,
+     Error::Start::kOwnPageSelectEmpty,
+     ErrorDescription{
+         "select one of your pages where the live video is posted, please"}},
+    {RemoteError::Start::kObsInternal,
+     Error::Start::kObsInternal,
+     ErrorDescription{"an error occurred from OBS module"}}};
+
+
+const ErrorEntry<Error::Stop> kStopErrors[] = {
+    {RemoteError::Stop::kNotOnAir,
+     Error::Stop::kNotOnAir,
+     ErrorDescription{"NCStreamer is not on streaming anything now"}},
+    {RemoteError::Stop::kTitleMismatch,
+     Error::Stop::kTitleMismatch,
+     ErrorDescription{"NCStreamer is not on streaming your source"}}};
+
+
+template <typename ErrorCode, std::size_t kSize>
+const ErrorEntry<ErrorCode> *Find(
+    const ErrorEntry<ErrorCode> (&entries)[kSize],
+    const std::string &error) {
+  for (const auto &entry : entries) {
+    if (std::strcmp(entry.id, error.c_str()) == 0) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+}  // unnamed namespace
+
+
 namespace ncstreamer_remote {
-std::string ErrorConverter::ToConnectionError(
+ErrorDescription::ErrorDescription(const char *text)
+    : narrow{text},
+      wide{narrow.begin(), narrow.end()} {
+}
+
+
+ErrorDescription::~ErrorDescription() {
+}
+
+
+const ErrorDescription &ErrorConverter::ToConnectionError(
     Error::Connection err_code) {
-  using DescriptionMap = std::unordered_map<Error::Connection, std::string>;
-  static const DescriptionMap kDescriptions{
-      {Error::Connection::kNoNcStreamer,
-       "NCStreamer is not running"},
-      {Error::Connection::kBusy,
-       "your previous request is not responded yet"},
-      {Error::Connection::kRemoteInitAsio,
-       "an error occurred while initializing NCStreamer-Remote module"},
-      {Error::Connection::kRemoteConnect,
-       "couldn't try to connect to NCStreamer"},
-      {Error::Connection::kRemoteSend,
-       "couldn't try to send message to NCStreamer"},
-      {Error::Connection::kOnRemoteFail,
-       "failed to connect to NCStreamer"},
-      {Error::Connection::kOnRemoteClose,
-       "the connection to NCStreamer is closed"}};
-
-  auto i = kDescriptions.find(err_code);
-  if (i == kDescriptions.end()) {
-    static const std::string kUnknownCode{"unknown error code"};
-    return kUnknownCode;
+  int index = static_cast<int>(err_code) -
+              static_cast<int>(Error::Connection::kNoNcStreamer);
+  int count = static_cast<int>(
+      sizeof(kConnectionErrors) / sizeof(kConnectionErrors[0]));
+  if (index < 0 || index >= count) {
+    return kUnknownConnectionError;
   }
 
-  return i->second;
+  return kConnectionErrors[index];
 }
 
 
-std::pair<Error::Start, std::string>
+std::pair<Error::Start, const ErrorDescription *>
     ErrorConverter::ToStartError(const std::string &error) {
-  using StartError = std::pair<Error::Start, std::string>;
-  static const std::unordered_map<std::string, StartError> kStartErrors{
-      {ncstreamer::RemoteMessage::Error::Start::kNoUser,
-       {Error::Start::kNoUser,
-        "you are not logged in to any streaming service provider"}},
-      {ncstreamer::RemoteMessage::Error::Start::kNotStandbySelf,
-       {Error::Start::kNotStandbySelf,
-        "NCStreamer is already on streaming your source"}},
-      {ncstreamer::RemoteMessage::Error::Start::kNotStandbyOther,
-       {Error::Start::kNotStandbyOther,
-        "NCStreamer is already on streaming other's source"}},
-      {ncstreamer::RemoteMessage::Error::Start::kUnknownTitle,
-       {Error::Start::kUnknownTitle,
-        "the source doesn't exist in the available source list"}},
-      {ncstreamer::RemoteMessage::Error::Start::kMePageSelectEmpty,
-       {Error::Start::kMePageSelectEmpty,
-        "select page type where the live video is posted, please"}},
-      {ncstreamer::RemoteMessage::Error::Start::kPrivacySelectEmpty,
-       {Error::Start::kPrivacySelectEmpty,
-        "select privacy to whom the live video is visible, please"}},
-      {ncstreamer::RemoteMessage::Error::Start::kOwnPageSelectEmpty,
-       {Error::Start::kOwnPageSelectEmpty,
-        "select one of your pages where the live video is posted, please"}},
-      {ncstreamer::RemoteMessage::Error::Start::kObsInternal,
-       {Error::Start::kObsInternal,
-        "an error occurred from OBS module"}}};
-
-  auto i = kStartErrors.find(error);
-  if (i != kStartErrors.end()) {
-    return i->second;
+  if (const auto *entry = Find(kStartErrors, error)) {
+    return {entry->err_code, &entry->description};
   }
 
-  static const std::string kFacebook{
-      ncstreamer::RemoteMessage::Error::Start::kStreamingServiceFacebookLive};
-  if (error.substr(0, kFacebook.size()) == kFacebook) {
-    return {Error::Start::kStreamingServiceFacebookLive, error};
+  const char *facebook =
+      RemoteError::Start::kStreamingServiceFacebookLive;
+  if (error.compare(0, std::strlen(facebook), facebook) == 0) {
+    return {Error::Start::kStreamingServiceFacebookLive, nullptr};
   }
 
-  return {Error::Start::kUnknownError, error};
+  return {Error::Start::kUnknownError, nullptr};
 }
 
 
-std::pair<Error::Stop, std::string>
+std::pair<Error::Stop, const ErrorDescription *>
     ErrorConverter::ToStopError(const std::string &error) {
-  using StopError = std::pair<Error::Stop, std::string>;
-  static const std::unordered_map<std::string, StopError> kStopErrors{
-      {ncstreamer::RemoteMessage::Error::Stop::kNotOnAir,
-       {Error::Stop::kNotOnAir,
-        "NCStreamer is not on streaming anything now"}},
-      {ncstreamer::RemoteMessage::Error::Stop::kTitleMismatch,
-       {Error::Stop::kTitleMismatch,
-        "NCStreamer is not on streaming your source"}}};
-
-  auto i = kStopErrors.find(error);
-  if (i != kStopErrors.end()) {
-    return i->second;
+  if (const auto *entry = Find(kStopErrors, error)) {
+    return {entry->err_code, &entry->description};
   }
 
-  return {Error::Stop::kUnknownError, error};
+  return {Error::Stop::kUnknownError, nullptr};
 }
 }  // namespace ncstreamer_remote
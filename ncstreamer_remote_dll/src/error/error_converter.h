@@ -14,21 +14,37 @@
 
 
 namespace ncstreamer_remote {
+/// Description of an error, made once at load in both encodings,
+/// so that reporting the error allocates nothing.
+class ErrorDescription {
+ public:
+  /// @param text ASCII only.
+  explicit ErrorDescription(const char *text);
+  virtual ~ErrorDescription();
+
+  const std::string narrow;
+  const std::wstring wide;
+};
+
+
 class ErrorConverter {
  public:
   /// @param error Error code from NCStreamer-Remote.
   /// @return Description of the given error code.
-  static std::string
+  static const ErrorDescription &
       ToConnectionError(Error::Connection err_code);
 
   /// @param error Error ID from NCStreamer.
-  /// @return Pair of error code and description.
-  static std::pair<Error::Start, std::string>
+  /// @return Pair of error code and description. The description is null
+  ///     if the error ID is the description itself, as for the errors of
+  ///     streaming services and the ones unknown to this version.
+  static std::pair<Error::Start, const ErrorDescription *>
       ToStartError(const std::string &error);
 
   /// @param error Error ID from NCStreamer.
-  /// @return Pair of error code and description.
-  static std::pair<Error::Stop, std::string>
+  /// @return Pair of error code and description, which is null for
+  ///     the errors unknown to this version.
+  static std::pair<Error::Stop, const ErrorDescription *>
       ToStopError(const std::string &error);
 };
 }  // namespace ncstreamer_remote
@@ -0,0 +1,56 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/src/handler_memory.h"
+
+#include <new>
+
+
+namespace ncstreamer_remote {
+HandlerMemory::HandlerMemory()
+    : mutex_{},
+      free_blocks_{} {
+  free_blocks_.reserve(kMaxFreeBlocks);
+}
+
+
+HandlerMemory::~HandlerMemory() {
+  for (void *block : free_blocks_) {
+    ::operator delete(block);
+  }
+}
+
+
+void *HandlerMemory::Allocate(std::size_t size) {
+  if (size > kBlockSize) {
+    return ::operator new(size);
+  }
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (free_blocks_.empty() == false) {
+      void *block = free_blocks_.back();
+      free_blocks_.pop_back();
+      return block;
+    }
+  }
+  return ::operator new(kBlockSize);
+}
+
+
+void HandlerMemory::Deallocate(void *block, std::size_t size) {
+  if (size <= kBlockSize) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (free_blocks_.size() < kMaxFreeBlocks) {
+      free_blocks_.push_back(block);  // within the reserved capacity.
+      return;
+    }
+  }
+  ::operator delete(block);
+}
+
+
+const std::size_t HandlerMemory::kBlockSize{256};
+const std::size_t HandlerMemory::kMaxFreeBlocks{64};
+}  // namespace ncstreamer_remote
@@ -0,0 +1,38 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_SRC_HANDLER_MEMORY_H_
+#define NCSTREAMER_REMOTE_DLL_SRC_HANDLER_MEMORY_H_
+
+
+#include <cstddef>
+#include <mutex>  // NOLINT
+#include <vector>
+
+
+namespace ncstreamer_remote {
+/// Recycles the memory asio takes for the handlers posted to the io
+/// threads. asio recycles it by itself only on its own threads, so
+/// posting a request from the caller's thread would allocate every time.
+/// Blocks are of one size; larger handlers go to the heap.
+class HandlerMemory {
+ public:
+  HandlerMemory();
+  virtual ~HandlerMemory();
+
+  void *Allocate(std::size_t size);
+  void Deallocate(void *block, std::size_t size);
+
+ private:
+  static const std::size_t kBlockSize;
+  static const std::size_t kMaxFreeBlocks;
+
+  std::mutex mutex_;
+  std::vector<void *> free_blocks_;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_SRC_HANDLER_MEMORY_H_
@@ -0,0 +1,155 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/io_pool.h"
+
+#if _MSC_VER >= 1900
+#include <chrono>  // NOLINT
+namespace Chrono = std::chrono;
+#else
+#include "boost/chrono/include.hpp"
+namespace Chrono = boost::chrono;
+#endif  // _MSC_VER >= 1900
+
+#include "Windows.h"  // NOLINT
+
+
+namespace ncstreamer_remote {
+std::shared_ptr<IoPool> IoPool::Create(std::size_t thread_count) {
+  return Create(thread_count, IoThreadPolicy{0, 0, 0});
+}
+
+
+std::shared_ptr<IoPool> IoPool::Create(
+    std::size_t thread_count,
+    const IoThreadPolicy &policy) {
+  return std::shared_ptr<IoPool>{new IoPool{thread_count, policy, false}};
+}
+
+
+std::shared_ptr<IoPool> IoPool::CreateManual() {
+  return std::shared_ptr<IoPool>{
+      new IoPool{0, IoThreadPolicy{0, 0, 0}, true}};
+}
+
+
+IoPool::IoPool(
+    std::size_t thread_count,
+    const IoThreadPolicy &policy,
+    bool manual)
+    : policy_(policy),
+      manual_{manual},
+      io_service_{},
+      io_service_work_{new boost::asio::io_service::work{io_service_}},
+      threads_{},
+      polling_mutex_{},
+      polling_thread_id_{} {
+  if (manual_ == true) {
+    return;
+  }
+  if (thread_count == 0) {
+    thread_count = 1;
+  }
+  for (std::size_t i = 0; i < thread_count; ++i) {
+    threads_.emplace_back([this]() {
+      Run();
+    });
+  }
+}
+
+
+IoPool::~IoPool() {
+  Stop();
+}
+
+
+bool IoPool::RunsInThisThread() const {
+  const auto &id = std::this_thread::get_id();
+  if (manual_ == true) {
+    std::lock_guard<std::mutex> lock{polling_mutex_};
+    return polling_thread_id_ == id;
+  }
+  for (const auto &t : threads_) {
+    if (t.get_id() == id) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+std::size_t IoPool::Poll() {
+  {
+    std::lock_guard<std::mutex> lock{polling_mutex_};
+    polling_thread_id_ = std::this_thread::get_id();
+  }
+  std::size_t handler_count = io_service_.poll();
+  {
+    std::lock_guard<std::mutex> lock{polling_mutex_};
+    polling_thread_id_ = std::thread::id{};
+  }
+  return handler_count;
+}
+
+
+void IoPool::Stop() {
+  io_service_work_.reset();
+  io_service_.stop();
+
+  const auto &id = std::this_thread::get_id();
+  for (auto &t : threads_) {
+    if (t.joinable() == false) {
+      continue;
+    }
+    if (t.get_id() == id) {
+      t.detach();  // released by its own handler; can't join itself.
+    } else {
+      t.join();
+    }
+  }
+}
+
+
+void IoPool::Run() {
+  if (policy_.affinity_mask != 0) {
+    ::SetThreadAffinityMask(
+        ::GetCurrentThread(),
+        static_cast<DWORD_PTR>(policy_.affinity_mask));
+  }
+  if (policy_.priority != 0) {
+    ::SetThreadPriority(::GetCurrentThread(), policy_.priority);
+  }
+
+  if (policy_.spin_us == 0) {
+    io_service_.run();
+  } else {
+    RunSpinning();
+  }
+}
+
+
+void IoPool::RunSpinning() {
+  const Chrono::microseconds spin{policy_.spin_us};
+  while (io_service_.stopped() == false) {
+    if (io_service_.poll_one() != 0) {
+      continue;
+    }
+
+    bool polled{false};
+    const auto &spin_end = Chrono::steady_clock::now() + spin;
+    while (Chrono::steady_clock::now() < spin_end &&
+           io_service_.stopped() == false) {
+      if (io_service_.poll_one() != 0) {
+        polled = true;
+        break;
+      }
+      YieldProcessor();  // a macro.
+    }
+    if (polled == false) {
+      io_service_.run_one();  // sleeps till the next handler.
+    }
+  }
+}
+}  // namespace ncstreamer_remote
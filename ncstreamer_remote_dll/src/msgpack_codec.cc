@@ -0,0 +1,432 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/src/msgpack_codec.h"
+
+#include <cstring>
+#include <sstream>
+
+
+namespace {
+/// Indices are the integer keys on the wire; never reorder, only append.
+const char *const kWellKnownKeys[] = {
+  "type",
+  "id",
+  "error",
+  "status",
+  "sourceTitle",
+  "userName",
+  "quality",
+  "title",
+  "source",
+  "userPage",
+  "privacy",
+  "description",
+  "mic",
+  "serviceProvider",
+  "streamUrl",
+  "postUrl",
+  "version",
+  "capabilities",
+  "seq",
+  "epoch",
+  "lastSeq",
+  "resumed",
+};
+
+const std::size_t kWellKnownKeysSize{
+    sizeof(kWellKnownKeys) / sizeof(kWellKnownKeys[0])};
+
+const int kMaxDepth{16};
+
+
+bool FindWellKnownKey(const std::string &key, std::size_t *index) {
+  for (std::size_t i = 0; i < kWellKnownKeysSize; ++i) {
+    if (key == kWellKnownKeys[i]) {
+      *index = i;
+      return true;
+    }
+  }
+  return false;
+}
+}  // unnamed namespace
+
+
+namespace ncstreamer_remote {
+class MsgpackCodec::Reader {
+ public:
+  explicit Reader(const std::string &payload)
+      : data_{reinterpret_cast<const std::uint8_t *>(payload.data())},
+        size_{payload.size()},
+        pos_{0} {}
+
+  bool AtEnd() const { return pos_ == size_; }
+
+  bool ReadNode(int depth, boost::property_tree::ptree *node) {
+    if (depth > kMaxDepth) {
+      return false;
+    }
+
+    std::uint8_t tag{0};
+    if (ReadByte(&tag) == false) {
+      return false;
+    }
+
+    std::size_t size{0};
+    if (IsMap(tag, &size) == true) {
+      for (std::size_t i = 0; i < size; ++i) {
+        std::string key{};
+        boost::property_tree::ptree child{};
+        if (ReadKey(&key) == false || ReadNode(depth + 1, &child) == false) {
+          return false;
+        }
+        node->push_back(std::make_pair(key, child));
+      }
+      return true;
+    }
+    if (IsArray(tag, &size) == true) {
+      for (std::size_t i = 0; i < size; ++i) {
+        boost::property_tree::ptree child{};
+        if (ReadNode(depth + 1, &child) == false) {
+          return false;
+        }
+        node->push_back(std::make_pair(std::string{}, child));
+      }
+      return true;
+    }
+
+    std::string value{};
+    if (ReadScalar(tag, &value) == false) {
+      return false;
+    }
+    node->data() = value;
+    return true;
+  }
+
+ private:
+  bool ReadByte(std::uint8_t *byte) {
+    if (pos_ >= size_) {
+      return false;
+    }
+    *byte = data_[pos_++];
+    return true;
+  }
+
+  bool ReadBigEndian(std::size_t bytes, std::uint64_t *value) {
+    if (size_ - pos_ < bytes) {
+      return false;
+    }
+    *value = 0;
+    for (std::size_t i = 0; i < bytes; ++i) {
+      *value = (*value << 8) | data_[pos_++];
+    }
+    return true;
+  }
+
+  bool ReadBytes(std::size_t bytes, std::string *value) {
+    if (size_ - pos_ < bytes) {
+      return false;
+    }
+    value->assign(reinterpret_cast<const char *>(data_ + pos_), bytes);
+    pos_ += bytes;
+    return true;
+  }
+
+  bool ReadSize(std::size_t bytes, std::size_t *size) {
+    std::uint64_t value{0};
+    if (ReadBigEndian(bytes, &value) == false || value > size_) {
+      return false;  // can't be longer than the whole payload.
+    }
+    *size = static_cast<std::size_t>(value);
+    return true;
+  }
+
+  bool IsMap(std::uint8_t tag, std::size_t *size) {
+    if ((tag & 0xf0) == 0x80) {
+      *size = tag & 0x0f;
+      return true;
+    }
+    if (tag == 0xde) {
+      return ReadSize(2, size);
+    }
+    if (tag == 0xdf) {
+      return ReadSize(4, size);
+    }
+    return false;
+  }
+
+  bool IsArray(std::uint8_t tag, std::size_t *size) {
+    if ((tag & 0xf0) == 0x90) {
+      *size = tag & 0x0f;
+      return true;
+    }
+    if (tag == 0xdc) {
+      return ReadSize(2, size);
+    }
+    if (tag == 0xdd) {
+      return ReadSize(4, size);
+    }
+    return false;
+  }
+
+  bool ReadKey(std::string *key) {
+    std::uint8_t tag{0};
+    if (ReadByte(&tag) == false) {
+      return false;
+    }
+    if (tag < 0x80) {
+      *key = tag < kWellKnownKeysSize ?
+          kWellKnownKeys[tag] : std::to_string(tag);
+      return true;
+    }
+    return ReadScalar(tag, key);
+  }
+
+  bool ReadScalar(std::uint8_t tag, std::string *value) {
+    std::size_t size{0};
+    std::uint64_t integer{0};
+    if (tag < 0x80) {
+      *value = std::to_string(tag);
+      return true;
+    }
+    if (tag >= 0xe0) {
+      *value = std::to_string(static_cast<std::int8_t>(tag));
+      return true;
+    }
+    if ((tag & 0xe0) == 0xa0) {
+      return ReadBytes(tag & 0x1f, value);
+    }
+
+    switch (tag) {
+      case 0xc0: value->clear(); return true;
+      case 0xc2: *value = "false"; return true;
+      case 0xc3: *value = "true"; return true;
+      case 0xc4: case 0xd9:
+        return ReadSize(1, &size) && ReadBytes(size, value);
+      case 0xc5: case 0xda:
+        return ReadSize(2, &size) && ReadBytes(size, value);
+      case 0xc6: case 0xdb:
+        return ReadSize(4, &size) && ReadBytes(size, value);
+      case 0xca: {
+        float f{0};
+        if (ReadBigEndian(4, &integer) == false) {
+          return false;
+        }
+        std::uint32_t bits = static_cast<std::uint32_t>(integer);
+        std::memcpy(&f, &bits, sizeof(f));
+        return ToString(f, value);
+      }
+      case 0xcb: {
+        double d{0};
+        if (ReadBigEndian(8, &integer) == false) {
+          return false;
+        }
+        std::memcpy(&d, &integer, sizeof(d));
+        return ToString(d, value);
+      }
+      case 0xcc: case 0xcd: case 0xce: case 0xcf: {
+        if (ReadBigEndian(std::size_t{1} << (tag - 0xcc), &integer) == false) {
+          return false;
+        }
+        *value = std::to_string(integer);
+        return true;
+      }
+      case 0xd0: case 0xd1: case 0xd2: case 0xd3: {
+        std::size_t bytes = std::size_t{1} << (tag - 0xd0);
+        if (ReadBigEndian(bytes, &integer) == false) {
+          return false;
+        }
+        std::size_t shift = 64 - bytes * 8;
+        std::int64_t signed_integer =
+            static_cast<std::int64_t>(integer << shift) >> shift;
+        *value = std::to_string(signed_integer);
+        return true;
+      }
+      default:
+        return false;  // ext types are not used.
+    }
+  }
+
+  template <typename Float>
+  static bool ToString(Float f, std::string *value) {
+    std::ostringstream ss;
+    ss << f;
+    *value = ss.str();
+    return true;
+  }
+
+  const std::uint8_t *data_;
+  std::size_t size_;
+  std::size_t pos_;
+};
+
+
+std::string MsgpackCodec::Encode(const boost::property_tree::ptree &tree) {
+  std::string out{};
+  out.reserve(64);
+  EncodeNode(tree, &out);
+  return out;
+}
+
+
+bool MsgpackCodec::Decode(
+    const std::string &payload,
+    boost::property_tree::ptree *tree) {
+  Reader reader{payload};
+  return reader.ReadNode(0, tree) == true && reader.AtEnd() == true;
+}
+
+
+void MsgpackCodec::EncodeNode(
+    const boost::property_tree::ptree &node,
+    std::string *out) {
+  if (node.empty() == true) {
+    std::int64_t integer{0};
+    if (ToInteger(node.data(), &integer) == true) {
+      EncodeInteger(integer, out);
+    } else {
+      EncodeString(node.data(), out);
+    }
+    return;
+  }
+
+  bool is_array{true};
+  for (const auto &child : node) {
+    if (child.first.empty() == false) {
+      is_array = false;
+      break;
+    }
+  }
+
+  if (is_array == true) {
+    EncodeHeader(0x90, 15, 0xdc, 0xdd, node.size(), out);
+    for (const auto &child : node) {
+      EncodeNode(child.second, out);
+    }
+    return;
+  }
+
+  EncodeHeader(0x80, 15, 0xde, 0xdf, node.size(), out);
+  for (const auto &child : node) {
+    EncodeKey(child.first, out);
+    EncodeNode(child.second, out);
+  }
+}
+
+
+void MsgpackCodec::EncodeKey(const std::string &key, std::string *out) {
+  std::size_t index{0};
+  if (FindWellKnownKey(key, &index) == true) {
+    out->push_back(static_cast<char>(index));  // positive fixint.
+    return;
+  }
+  EncodeString(key, out);
+}
+
+
+void MsgpackCodec::EncodeString(const std::string &value, std::string *out) {
+  if (value.size() < 32) {
+    out->push_back(static_cast<char>(0xa0 | value.size()));
+  } else if (value.size() <= 0xff) {
+    out->push_back(static_cast<char>(0xd9));
+    EncodeBigEndian(value.size(), 1, out);
+  } else {
+    EncodeHeader(0, 0, 0xda, 0xdb, value.size(), out);
+  }
+  out->append(value);
+}
+
+
+void MsgpackCodec::EncodeInteger(std::int64_t value, std::string *out) {
+  if (value >= 0) {
+    if (value < 0x80) {
+      out->push_back(static_cast<char>(value));
+    } else if (value <= 0xff) {
+      out->push_back(static_cast<char>(0xcc));
+      EncodeBigEndian(value, 1, out);
+    } else if (value <= 0xffff) {
+      out->push_back(static_cast<char>(0xcd));
+      EncodeBigEndian(value, 2, out);
+    } else if (value <= 0xffffffffLL) {
+      out->push_back(static_cast<char>(0xce));
+      EncodeBigEndian(value, 4, out);
+    } else {
+      out->push_back(static_cast<char>(0xcf));
+      EncodeBigEndian(value, 8, out);
+    }
+    return;
+  }
+
+  if (value >= -32) {
+    out->push_back(static_cast<char>(value));  // negative fixint.
+  } else if (value >= -0x80) {
+    out->push_back(static_cast<char>(0xd0));
+    EncodeBigEndian(static_cast<std::uint64_t>(value), 1, out);
+  } else if (value >= -0x8000) {
+    out->push_back(static_cast<char>(0xd1));
+    EncodeBigEndian(static_cast<std::uint64_t>(value), 2, out);
+  } else if (value >= -0x80000000LL) {
+    out->push_back(static_cast<char>(0xd2));
+    EncodeBigEndian(static_cast<std::uint64_t>(value), 4, out);
+  } else {
+    out->push_back(static_cast<char>(0xd3));
+    EncodeBigEndian(static_cast<std::uint64_t>(value), 8, out);
+  }
+}
+
+
+void MsgpackCodec::EncodeHeader(
+    std::uint8_t fix_tag,
+    std::size_t fix_max,
+    std::uint8_t tag16,
+    std::uint8_t tag32,
+    std::size_t size,
+    std::string *out) {
+  if (fix_tag != 0 && size <= fix_max) {
+    out->push_back(static_cast<char>(fix_tag | size));
+  } else if (size <= 0xffff) {
+    out->push_back(static_cast<char>(tag16));
+    EncodeBigEndian(size, 2, out);
+  } else {
+    out->push_back(static_cast<char>(tag32));
+    EncodeBigEndian(size, 4, out);
+  }
+}
+
+
+void MsgpackCodec::EncodeBigEndian(
+    std::uint64_t value,
+    std::size_t bytes,
+    std::string *out) {
+  for (std::size_t i = bytes; i > 0; --i) {
+    out->push_back(static_cast<char>((value >> ((i - 1) * 8)) & 0xff));
+  }
+}
+
+
+bool MsgpackCodec::ToInteger(const std::string &value, std::int64_t *integer) {
+  // only the canonical form, so that decoding gives back the same string.
+  static const std::size_t kMaxDigits{18};
+
+  std::size_t begin = (value.empty() == false && value[0] == '-') ? 1 : 0;
+  std::size_t digits = value.size() - begin;
+  if (digits == 0 || digits > kMaxDigits) {
+    return false;
+  }
+  if (value[begin] == '0' && (digits > 1 || begin == 1)) {
+    return false;
+  }
+
+  std::int64_t result{0};
+  for (std::size_t i = begin; i < value.size(); ++i) {
+    if (value[i] < '0' || value[i] > '9') {
+      return false;
+    }
+    result = result * 10 + (value[i] - '0');
+  }
+  *integer = (begin == 1) ? -result : result;
+  return true;
+}
+}  // namespace ncstreamer_remote
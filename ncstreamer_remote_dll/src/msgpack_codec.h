@@ -0,0 +1,57 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_SRC_MSGPACK_CODEC_H_
+#define NCSTREAMER_REMOTE_DLL_SRC_MSGPACK_CODEC_H_
+
+
+#include <cstdint>
+#include <string>
+
+#include "boost/property_tree/ptree.hpp"
+
+
+namespace ncstreamer_remote {
+/// Converts the ptree of a remote message to and from MessagePack.
+/// Well-known keys like "type" and "streamUrl" are written as small
+/// integers, and decimal values as integers, so that a message shrinks
+/// to a fraction of its JSON text.
+/// Nodes whose children all have empty keys are written as arrays.
+class MsgpackCodec {
+ public:
+  static std::string Encode(const boost::property_tree::ptree &tree);
+
+  /// @return false if the payload is broken.
+  static bool Decode(
+      const std::string &payload,
+      boost::property_tree::ptree *tree);
+
+ private:
+  class Reader;
+
+  static void EncodeNode(
+      const boost::property_tree::ptree &node,
+      std::string *out);
+  static void EncodeKey(const std::string &key, std::string *out);
+  static void EncodeString(const std::string &value, std::string *out);
+  static void EncodeInteger(std::int64_t value, std::string *out);
+  static void EncodeHeader(
+      std::uint8_t fix_tag,
+      std::size_t fix_max,
+      std::uint8_t tag16,
+      std::uint8_t tag32,
+      std::size_t size,
+      std::string *out);
+  static void EncodeBigEndian(
+      std::uint64_t value,
+      std::size_t bytes,
+      std::string *out);
+
+  static bool ToInteger(const std::string &value, std::int64_t *integer);
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_SRC_MSGPACK_CODEC_H_
@@ -5,35 +5,87 @@
 
 #include "ncstreamer_remote_dll/include/ncstreamer_remote/ncstreamer_remote.h"
 
+#include <atomic>
 #include <cassert>
-#include <codecvt>
-#include <locale>
-#include <sstream>
-#include <unordered_map>
-
-#include "boost/algorithm/string.hpp"
-#include "boost/property_tree/json_parser.hpp"
-
-#include "Windows.h"  // NOLINT
+#include <utility>
 
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/remote_future.h"
 #include "ncstreamer_remote_dll/src/error/error_converter.h"
-#include "ncstreamer_remote_dll/src/ncstreamer_remote_message_types.h"
+#include "ncstreamer_remote_dll/src/ncstreamer_remote_impl.h"
 
 
 namespace {
-namespace placeholders = websocketpp::lib::placeholders;
+/// The promise of a request, broken with Error::Connection::kCancelled
+/// if its handlers are released without being called.
+template <typename T>
+ncstreamer_remote::RemotePromise<T> NewPromise() {
+  using ncstreamer_remote::Error;
+  return ncstreamer_remote::RemotePromise<T>{ncstreamer_remote::RemoteError{
+      ncstreamer_remote::ErrorCategory::kConnection,
+      static_cast<int>(Error::Connection::kCancelled),
+      ncstreamer_remote::ErrorConverter::ToConnectionError(
+          Error::Connection::kCancelled).wide}};
+}
+
+
+template <typename T>
+ncstreamer_remote::NcStreamerRemote::UniqueErrorHandler ToErrorHandler(
+    const ncstreamer_remote::RemotePromise<T> &promise) {
+  return ncstreamer_remote::NcStreamerRemote::UniqueErrorHandler{[promise](
+      ncstreamer_remote::ErrorCategory category,
+      int err_code,
+      const std::wstring &err_msg) {
+    promise.SetError(category, err_code, err_msg);
+  }};
+}
+
+
+template <typename Handler>
+Handler ToSuccessHandler(
+    const ncstreamer_remote::RemotePromise<bool> &promise) {
+  return Handler{[promise](bool success) {
+    promise.SetValue(success);
+  }};
+}
+
+
+/// Numbers the instances of Create, so that each writes a log of its own,
+/// even on the same port.
+std::string NewLogPath(std::uint16_t port) {
+  static std::atomic<std::uint32_t> instance_count{0};
+  std::uint32_t instance = ++instance_count;
+  return "ncstreamer_remote_" + std::to_string(port) +
+         "_" + std::to_string(instance) + ".log";
+}
 }  // unnamed namespace
 
 
 namespace ncstreamer_remote {
-void NcStreamerRemote::SetUp(uint16_t remote_port) {
+void NcStreamerRemote::SetUp(
+    uint16_t remote_port) {
+  assert(!static_instance);
+  SetUp(PortDiscovery{{remote_port}, std::string{}, 0});
+}
+
+
+void NcStreamerRemote::SetUp(
+    const PortDiscovery &discovery) {
+  SetUp(discovery, nullptr);
+}
+
+
+void NcStreamerRemote::SetUp(
+    const PortDiscovery &discovery,
+    const std::shared_ptr<IoPool> &io_pool) {
   assert(!static_instance);
-  static_instance = new NcStreamerRemote{remote_port};
+  static_instance = new NcStreamerRemote{
+      discovery, io_pool, nullptr, "ncstreamer_remote.log"};
 }
 
 
 void NcStreamerRemote::SetUpDefault() {
-  SetUp(9002);
+  SetUp(PortDiscovery{
+      {9002, 9003, 9004, 9005, 9006, 9007, 9008, 9009}, std::string{}, 0});
 }
 
 
@@ -44,731 +96,404 @@ void NcStreamerRemote::ShutDown() {
 }
 
 
+void NcStreamerRemote::ShutDown(
+    std::uint32_t deadline_ms,
+    bool flush_urgent) {
+  assert(static_instance);
+  static_instance->Close(deadline_ms, flush_urgent);
+  delete static_instance;
+  static_instance = nullptr;
+}
+
+
 NcStreamerRemote *NcStreamerRemote::Get() {
   assert(static_instance);
   return static_instance;
 }
 
 
+std::unique_ptr<NcStreamerRemote> NcStreamerRemote::Create(
+    uint16_t remote_port,
+    const std::shared_ptr<IoPool> &io_pool) {
+  return Create(PortDiscovery{{remote_port}, std::string{}, 0}, io_pool);
+}
+
+
+std::unique_ptr<NcStreamerRemote> NcStreamerRemote::Create(
+    const PortDiscovery &discovery,
+    const std::shared_ptr<IoPool> &io_pool) {
+  return Create(discovery, io_pool, nullptr);
+}
+
+
+std::unique_ptr<NcStreamerRemote> NcStreamerRemote::Create(
+    const PortDiscovery &discovery,
+    const std::shared_ptr<IoPool> &io_pool,
+    const std::shared_ptr<RemoteClock> &clock) {
+  std::uint16_t log_port = discovery.candidate_ports.empty() == false ?
+      discovery.candidate_ports.front() : 0;
+  return std::unique_ptr<NcStreamerRemote>{new NcStreamerRemote{
+      discovery,
+      io_pool,
+      clock,
+      NewLogPath(log_port)}};
+}
+
+
+NcStreamerRemote::NcStreamerRemote(
+    const PortDiscovery &discovery,
+    const std::shared_ptr<IoPool> &io_pool,
+    const std::shared_ptr<RemoteClock> &clock,
+    const std::string &log_path)
+    : impl_{new Impl{discovery, io_pool, clock, log_path}} {
+}
+
+
+NcStreamerRemote::~NcStreamerRemote() {
+}
+
+
+bool NcStreamerRemote::Close(
+    std::uint32_t deadline_ms,
+    bool flush_urgent) {
+  return impl_->Close(deadline_ms, flush_urgent);
+}
+
+
+void NcStreamerRemote::RegisterReadyHandler(
+    const ReadyHandler &ready_handler) {
+  impl_->RegisterReadyHandler(ready_handler);
+}
+
+
 void NcStreamerRemote::RegisterConnectHandler(
     const ConnectHandler &connect_handler) {
-  connect_handler_ = connect_handler;
+  impl_->RegisterConnectHandler(connect_handler);
 }
 
 
 void NcStreamerRemote::RegisterDisconnectHandler(
     const DisconnectHandler &disconnect_handler) {
-  disconnect_handler_ = disconnect_handler;
+  impl_->RegisterDisconnectHandler(disconnect_handler);
 }
 
 
 void NcStreamerRemote::RegisterStartEventHandler(
     const StartEventHandler &start_event_handler) {
-  start_event_handler_ = start_event_handler;
+  impl_->RegisterStartEventHandler(start_event_handler);
 }
 
 
 void NcStreamerRemote::RegisterStopEventHandler(
     const StopEventHandler &stop_event_handler) {
-  stop_event_handler_ = stop_event_handler;
+  impl_->RegisterStopEventHandler(stop_event_handler);
 }
 
 
-void NcStreamerRemote::RequestStatus(
-    const ErrorHandler &error_handler,
-    const StatusResponseHandler &status_response_handler) {
-  if (busy_ == true) {
-    HandleConnectionError(Error::Connection::kBusy, error_handler);
-    return;
-  }
-  busy_ = true;
-
-  current_error_handler_ = error_handler;
-  current_status_response_handler_ = status_response_handler;
+void NcStreamerRemote::RegisterUtf8StartEventHandler(
+    const Utf8StartEventHandler &start_event_handler) {
+  impl_->RegisterUtf8StartEventHandler(start_event_handler);
+}
 
-  if (!remote_connection_.lock()) {
-    Connect([this]() {
-      SendStatusRequest();
-    });
-    return;
-  }
 
-  SendStatusRequest();
+void NcStreamerRemote::RegisterUtf8StopEventHandler(
+    const Utf8StopEventHandler &stop_event_handler) {
+  impl_->RegisterUtf8StopEventHandler(stop_event_handler);
 }
 
 
-void NcStreamerRemote::RequestStart(
-    const std::wstring &title,
-    const ErrorHandler &error_handler,
-    const StartResponseHandler &start_response_handler) {
-  if (busy_ == true) {
-    HandleConnectionError(Error::Connection::kBusy, error_handler);
-    return;
-  }
-  busy_ = true;
-
-  current_error_handler_ = error_handler;
-  current_start_response_handler_ = start_response_handler;
+void NcStreamerRemote::SetStatusCoalescingWindow(
+    std::uint32_t window_ms) {
+  impl_->SetStatusCoalescingWindow(window_ms);
+}
 
-  if (!remote_connection_.lock()) {
-    Connect([this, title]() {
-      SendStartRequest(title);
-    });
-    return;
-  }
 
-  SendStartRequest(title);
+void NcStreamerRemote::SetQualityUpdateDebounceWindow(
+    std::uint32_t window_ms) {
+  impl_->SetQualityUpdateDebounceWindow(window_ms);
 }
 
 
-void NcStreamerRemote::RequestStop(
-    const std::wstring &title,
-    const ErrorHandler &error_handler,
-    const StopResponseHandler &stop_response_handler) {
-  if (busy_ == true) {
-    HandleConnectionError(Error::Connection::kBusy, error_handler);
-    return;
-  }
-  busy_ = true;
-
-  current_error_handler_ = error_handler;
-  current_stop_response_handler_ = stop_response_handler;
+void NcStreamerRemote::SetCallbackBudget(
+    std::uint32_t budget_us,
+    const SlowCallbackHandler &slow_callback_handler,
+    std::uint32_t offload_after) {
+  impl_->SetCallbackBudget(budget_us, slow_callback_handler, offload_after);
+}
 
-  if (!remote_connection_.lock()) {
-    Connect([this, title]() {
-      SendStopRequest(title);
-    });
-    return;
-  }
 
-  SendStopRequest(title);
+void NcStreamerRemote::SetRequestQueuePolicy(
+    std::size_t capacity,
+    OverflowPolicy overflow_policy,
+    std::uint32_t block_timeout_ms) {
+  impl_->SetRequestQueuePolicy(capacity, overflow_policy, block_timeout_ms);
 }
 
 
-void NcStreamerRemote::RequestQualityUpdate(
-    const std::wstring &quality,
-    const ErrorHandler &error_handler,
-    const SuccessHandler &quality_update_response_handler) {
-  if (busy_ == true) {
-    HandleConnectionError(Error::Connection::kBusy, error_handler);
-    return;
-  }
-  busy_ = true;
-
-  current_error_handler_ = error_handler;
-  current_quality_update_response_handler_ = quality_update_response_handler;
+void NcStreamerRemote::SetBinaryEncodingEnabled(bool enabled) {
+  impl_->SetBinaryEncodingEnabled(enabled);
+}
 
-  if (!remote_connection_.lock()) {
-    Connect([this, quality]() {
-      SendQualityUpdateRequest(quality);
-    });
-    return;
-  }
 
-  SendQualityUpdateRequest(quality);
+void NcStreamerRemote::SetRateLimit(
+    RequestType type,
+    const RateLimit &rate_limit) {
+  impl_->SetRateLimit(type, rate_limit);
 }
 
 
-void NcStreamerRemote::RequestExit(
-    const ErrorHandler &error_handler) {
-  if (busy_ == true) {
-    HandleConnectionError(Error::Connection::kBusy, error_handler);
-    return;
-  }
-  busy_ = true;
-
-  current_error_handler_ = error_handler;
-
-  if (!remote_connection_.lock()) {
-    Connect([this]() {
-      SendExitRequest();
-    });
-    return;
-  }
-
-  SendExitRequest();
-}
-
-
-NcStreamerRemote::NcStreamerRemote(uint16_t remote_port)
-    : remote_uri_{new websocketpp::uri{false, "localhost", remote_port, ""}},
-      io_service_{},
-      io_service_work_{io_service_},
-      remote_{},
-      remote_threads_{},
-      remote_log_{},
-      remote_connection_{},
-      timer_to_keep_connected_{io_service_},
-      busy_{},
-      connect_handler_{},
-      disconnect_handler_{},
-      start_event_handler_{},
-      stop_event_handler_{},
-      current_error_handler_{},
-      current_status_response_handler_{},
-      current_start_response_handler_{},
-      current_stop_response_handler_{},
-      current_quality_update_response_handler_{} {
-  busy_ = false;
-
-  remote_log_.open("ncstreamer_remote.log");
-  remote_.set_access_channels(websocketpp::log::alevel::all);
-  remote_.set_access_channels(websocketpp::log::elevel::all);
-  remote_.get_alog().set_ostream(&remote_log_);
-  remote_.get_elog().set_ostream(&remote_log_);
-
-  websocketpp::lib::error_code ec;
-  remote_.init_asio(&io_service_, ec);
-  if (ec) {
-    HandleError(Error::Connection::kRemoteInitAsio, ec);
-    assert(false);
-    return;
-  }
-
-  remote_.set_fail_handler(websocketpp::lib::bind(
-      &NcStreamerRemote::OnRemoteFail, this, placeholders::_1));
-  remote_.set_close_handler(websocketpp::lib::bind(
-      &NcStreamerRemote::OnRemoteClose, this, placeholders::_1));
-  remote_.set_message_handler(websocketpp::lib::bind(
-      &NcStreamerRemote::OnRemoteMessage, this,
-          placeholders::_1, placeholders::_2));
-
-  static const std::size_t kRemoteThreadsSize{1};  // just one enough.
-  for (std::size_t i = 0; i < kRemoteThreadsSize; ++i) {
-    remote_threads_.emplace_back([this]() {
-      remote_.run();
-    });
-  }
-
-  KeepConnected();
+bool NcStreamerRemote::StartCapture(const std::string &path) {
+  return impl_->StartCapture(path);
 }
 
 
-NcStreamerRemote::~NcStreamerRemote() {
-  remote_.stop();
-  for (auto &t : remote_threads_) {
-    if (t.joinable() == true) {
-      t.join();
-    }
-  }
+void NcStreamerRemote::StopCapture() {
+  impl_->StopCapture();
 }
 
 
-bool NcStreamerRemote::ExistsNcStreamer() {
-  HWND wnd = ::FindWindow(nullptr, ncstreamer::kNcStreamerWindowTitle);
-  return (wnd != NULL);
+ReplayStats NcStreamerRemote::Replay(
+    const std::string &capture_path,
+    bool recorded_speed) {
+  return impl_->Replay(capture_path, recorded_speed);
 }
 
 
-void NcStreamerRemote::KeepConnected() {
-  if (remote_connection_.lock()) {
-    return;
-  }
+RemoteStats NcStreamerRemote::GetStats() const {
+  return impl_->GetStats();
+}
 
-  Connect([this](
-      ErrorCategory err_category,
-      int err_code,
-      const std::wstring &err_msg) {
-    timer_to_keep_connected_.expires_from_now(Chrono::seconds{1});
-    timer_to_keep_connected_.async_wait([this](
-        const boost::system::error_code &ec) {
-      if (ec) {
-        return;
-      }
-      KeepConnected();
-    });
-  }, [this]() {
-    if (connect_handler_) {
-      connect_handler_();
-    }
-  });
+
+void NcStreamerRemote::RequestStatus(
+    const ErrorHandler &error_handler,
+    const StatusResponseHandler &status_response_handler,
+    const CancellationToken &cancellation_token) {
+  impl_->RequestStatus(
+      error_handler,
+      status_response_handler,
+      cancellation_token);
 }
 
 
-void NcStreamerRemote::Connect(
-    const OpenHandler &open_handler) {
-  Connect(current_error_handler_, open_handler);
+void NcStreamerRemote::RequestStart(
+    const std::wstring &title,
+    const ErrorHandler &error_handler,
+    const StartResponseHandler &start_response_handler,
+    const CancellationToken &cancellation_token) {
+  impl_->RequestStart(
+      title,
+      error_handler,
+      start_response_handler,
+      cancellation_token);
 }
 
 
-void NcStreamerRemote::Connect(
+void NcStreamerRemote::RequestStop(
+    const std::wstring &title,
     const ErrorHandler &error_handler,
-    const OpenHandler &open_handler) {
-  if (ExistsNcStreamer() == false) {
-    HandleError(Error::Connection::kNoNcStreamer, error_handler);
-    return;
-  }
-
-  websocketpp::lib::error_code ec;
-  auto connection = remote_.get_connection(remote_uri_, ec);
-  if (ec) {
-    HandleError(Error::Connection::kRemoteConnect, ec, error_handler);
-    return;
-  }
-
-  remote_.connect(connection);
-  connection->set_open_handler([this, open_handler](
-      websocketpp::connection_hdl connection) {
-    remote_connection_ = connection;
-    open_handler();
-  });
-}
-
-
-void NcStreamerRemote::SendStatusRequest() {
-  std::stringstream msg;
-  {
-    boost::property_tree::ptree tree;
-    tree.put("type", static_cast<int>(
-        ncstreamer::RemoteMessage::MessageType::kStreamingStatusRequest));
-    boost::property_tree::write_json(msg, tree, false);
-  }
-
-  websocketpp::lib::error_code ec;
-  remote_.send(
-      remote_connection_, msg.str(), websocketpp::frame::opcode::text, ec);
-  if (ec) {
-    HandleError(Error::Connection::kRemoteSend, ec);
-    return;
-  }
+    const StopResponseHandler &stop_response_handler,
+    const CancellationToken &cancellation_token) {
+  impl_->RequestStop(
+      title,
+      error_handler,
+      stop_response_handler,
+      cancellation_token);
 }
 
 
-void NcStreamerRemote::SendStartRequest(const std::wstring &title) {
-  std::stringstream msg;
-  {
-    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-
-    boost::property_tree::ptree tree;
-    tree.put("type", static_cast<int>(
-        ncstreamer::RemoteMessage::MessageType::kStreamingStartRequest));
-    tree.put("title", converter.to_bytes(title));
-    boost::property_tree::write_json(msg, tree, false);
-  }
-
-  websocketpp::lib::error_code ec;
-  remote_.send(
-      remote_connection_, msg.str(), websocketpp::frame::opcode::text, ec);
-  if (ec) {
-    HandleError(Error::Connection::kRemoteSend, ec);
-    return;
-  }
-}
-
-
-void NcStreamerRemote::SendStopRequest(const std::wstring &title) {
-  std::stringstream msg;
-  {
-    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-
-    boost::property_tree::ptree tree;
-    tree.put("type", static_cast<int>(
-        ncstreamer::RemoteMessage::MessageType::kStreamingStopRequest));
-    tree.put("title", converter.to_bytes(title));
-    boost::property_tree::write_json(msg, tree, false);
-  }
-
-  websocketpp::lib::error_code ec;
-  remote_.send(
-      remote_connection_, msg.str(), websocketpp::frame::opcode::text, ec);
-  if (ec) {
-    HandleError(Error::Connection::kRemoteSend, ec);
-    return;
-  }
-}
-
-
-void NcStreamerRemote::SendQualityUpdateRequest(const std::wstring &quality) {
-  std::stringstream msg;
-  {
-    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-
-    boost::property_tree::ptree tree;
-    tree.put("type", static_cast<int>(
-        ncstreamer::RemoteMessage::MessageType::kSettingsQualityUpdateRequest));
-    tree.put("quality", converter.to_bytes(quality));
-    boost::property_tree::write_json(msg, tree, false);
-  }
-
-  websocketpp::lib::error_code ec;
-  remote_.send(
-      remote_connection_, msg.str(), websocketpp::frame::opcode::text, ec);
-  if (ec) {
-    HandleError(Error::Connection::kRemoteSend, ec);
-    return;
-  }
-}
-
-
-void NcStreamerRemote::SendExitRequest() {
-  std::stringstream msg;
-  {
-    boost::property_tree::ptree tree;
-    tree.put("type", static_cast<int>(
-        ncstreamer::RemoteMessage::MessageType::kNcStreamerExitRequest));
-    boost::property_tree::write_json(msg, tree, false);
-  }
-
-  websocketpp::lib::error_code ec;
-  remote_.send(
-      remote_connection_, msg.str(), websocketpp::frame::opcode::text, ec);
-  if (ec) {
-    HandleError(Error::Connection::kRemoteSend, ec);
-    return;
-  }
-}
-
-
-void NcStreamerRemote::OnRemoteFail(websocketpp::connection_hdl connection) {
-  HandleDisconnect(Error::Connection::kOnRemoteFail);
-}
-
-
-void NcStreamerRemote::OnRemoteClose(websocketpp::connection_hdl connection) {
-  HandleDisconnect(Error::Connection::kOnRemoteClose);
-}
-
-
-void NcStreamerRemote::OnRemoteMessage(
-    websocketpp::connection_hdl connection,
-    websocketpp::connection<AsioClient>::message_ptr msg) {
-  busy_ = false;
-
-  boost::property_tree::ptree response;
-  ncstreamer::RemoteMessage::MessageType msg_type{
-      ncstreamer::RemoteMessage::MessageType::kUndefined};
-
-  std::stringstream ss{msg->get_payload()};
-  try {
-    boost::property_tree::read_json(ss, response);
-    msg_type = static_cast<ncstreamer::RemoteMessage::MessageType>(
-        response.get<int>("type"));
-  } catch (const std::exception &/*e*/) {
-    msg_type = ncstreamer::RemoteMessage::MessageType::kUndefined;
-  }
-
-  using MessageHandler = std::function<void(
-      const boost::property_tree::ptree &/*response*/)>;
-  static const std::unordered_map<ncstreamer::RemoteMessage::MessageType,
-                                  MessageHandler> kMessageHandlers{
-      {ncstreamer::RemoteMessage::MessageType::kStreamingStartEvent,
-       std::bind(&NcStreamerRemote::OnRemoteStartEvent,
-           this, std::placeholders::_1)},
-      {ncstreamer::RemoteMessage::MessageType::kStreamingStopEvent,
-       std::bind(&NcStreamerRemote::OnRemoteStopEvent,
-           this, std::placeholders::_1)},
-      {ncstreamer::RemoteMessage::MessageType::kStreamingStatusResponse,
-       std::bind(&NcStreamerRemote::OnRemoteStatusResponse,
-           this, std::placeholders::_1)},
-      {ncstreamer::RemoteMessage::MessageType::kStreamingStartResponse,
-       std::bind(&NcStreamerRemote::OnRemoteStartResponse,
-           this, std::placeholders::_1)},
-      {ncstreamer::RemoteMessage::MessageType::kStreamingStopResponse,
-       std::bind(&NcStreamerRemote::OnRemoteStopResponse,
-           this, std::placeholders::_1)},
-      {ncstreamer::RemoteMessage::MessageType::kSettingsQualityUpdateResponse,
-       std::bind(&NcStreamerRemote::OnRemoteQualityUpdateResponse,
-           this, std::placeholders::_1)}};
-
-  auto i = kMessageHandlers.find(msg_type);
-  if (i == kMessageHandlers.end()) {
-    LogWarning(
-        "unknown message type: " + std::to_string(static_cast<int>(msg_type)));
-    return;
-  }
-  i->second(response);
-}
-
-
-void NcStreamerRemote::OnRemoteStartEvent(
-    const boost::property_tree::ptree &evt) {
-  if (!start_event_handler_) {
-    return;
-  }
-
-  std::string source{};
-  std::string user_page{};
-  std::string privacy{};
-  std::string description{};
-  std::string mic{};
-  std::string service_provider{};
-  std::string stream_url{};
-  std::string post_url{};
-  try {
-    source = evt.get<std::string>("source");
-    user_page = evt.get<std::string>("userPage");
-    privacy = evt.get<std::string>("privacy");
-    description = evt.get<std::string>("description");
-    mic = evt.get<std::string>("mic");
-    service_provider = evt.get<std::string>("serviceProvider");
-    stream_url = evt.get<std::string>("streamUrl");
-    post_url = evt.get<std::string>("postUrl");
-  } catch (const std::exception &/*e*/) {
-    source.clear();
-    user_page.clear();
-    privacy.clear();
-    description.clear();
-    mic.clear();
-    service_provider.clear();
-    stream_url.clear();
-    post_url.clear();
-  }
-
-  if (source.empty() == true) {
-    LogError("source.empty()");
-    return;
-  }
-
-  std::vector<std::string> tokens{};
-  boost::split(tokens, source, boost::is_any_of(":"));
-  const std::string &source_title = tokens.at(0);
-
-  static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-  start_event_handler_(
-      converter.from_bytes(source_title),
-      converter.from_bytes(user_page),
-      converter.from_bytes(privacy),
-      converter.from_bytes(description),
-      converter.from_bytes(mic),
-      converter.from_bytes(service_provider),
-      converter.from_bytes(stream_url),
-      converter.from_bytes(post_url));
-}
-
-
-void NcStreamerRemote::OnRemoteStopEvent(
-    const boost::property_tree::ptree &evt) {
-  if (!stop_event_handler_) {
-    return;
-  }
-
-  std::string source{};
-  try {
-    source = evt.get<std::string>("source");
-  } catch (const std::exception &/*e*/) {
-    source.clear();
-  }
-
-  if (source.empty() == true) {
-    LogError("source.empty()");
-    return;
-  }
-
-  std::vector<std::string> tokens{};
-  boost::algorithm::split(tokens, source, boost::is_any_of(":"));
-  const std::string &source_title = tokens.at(0);
-
-  static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-  stop_event_handler_(
-      converter.from_bytes(source_title));
-}
-
-
-void NcStreamerRemote::OnRemoteStatusResponse(
-    const boost::property_tree::ptree &response) {
-  std::string status{};
-  std::string source_title{};
-  std::string user_name{};
-  std::string quality{};
-  try {
-    status = response.get<std::string>("status");
-    source_title = response.get<std::string>("sourceTitle");
-    user_name = response.get<std::string>("userName");
-    quality = response.get<std::string>("quality");
-  } catch (const std::exception &/*e*/) {
-    status.clear();
-    source_title.clear();
-  }
-
-  if (status.empty() == true) {
-    LogError("status.empty()");
-    return;
-  }
-  if (quality.empty() == true) {
-    LogError("quality.empty()");
-    return;
-  }
-
-  if (!current_status_response_handler_) {
-    LogError("!current_status_response_handler_");
-    return;
-  }
-
-  static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-  current_status_response_handler_(
-      converter.from_bytes(status),
-      converter.from_bytes(source_title),
-      converter.from_bytes(user_name),
-      converter.from_bytes(quality));
-}
-
-
-void NcStreamerRemote::OnRemoteStartResponse(
-    const boost::property_tree::ptree &response) {
-  bool exception_occurred{false};
-  std::string error{};
-  try {
-    error = response.get<std::string>("error");
-  } catch (const std::exception &/*e*/) {
-    exception_occurred = true;
-  }
-
-  if (exception_occurred == true) {
-    LogError("start response broken");
-    return;
-  }
-
-  if (error.empty() == false) {
-    static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-    const auto &err_info = ErrorConverter::ToStartError(error);
-
-    current_error_handler_(
-        ErrorCategory::kStart,
-        static_cast<int>(err_info.first),
-        converter.from_bytes(err_info.second));
-  } else {
-    current_start_response_handler_(true);
-  }
-}
-
-
-void NcStreamerRemote::OnRemoteStopResponse(
-    const boost::property_tree::ptree &response) {
-  bool exception_occurred{false};
-  std::string error{};
-  try {
-    error = response.get<std::string>("error");
-  } catch (const std::exception &/*e*/) {
-    exception_occurred = true;
-  }
-
-  if (exception_occurred == true) {
-    LogError("stop response broken");
-    return;
-  }
-
-  if (error.empty() == false) {
-    static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-    const auto &err_info = ErrorConverter::ToStopError(error);
-
-    current_error_handler_(
-        ErrorCategory::kStop,
-        static_cast<int>(err_info.first),
-        converter.from_bytes(err_info.second));
-  } else {
-    current_stop_response_handler_(true);
-  }
-}
-
+void NcStreamerRemote::RequestQualityUpdate(
+    const std::wstring &quality,
+    const ErrorHandler &error_handler,
+    const SuccessHandler &quality_update_response_handler,
+    const CancellationToken &cancellation_token) {
+  impl_->RequestQualityUpdate(
+      quality,
+      error_handler,
+      quality_update_response_handler,
+      cancellation_token);
+}
 
-void NcStreamerRemote::OnRemoteQualityUpdateResponse(
-    const boost::property_tree::ptree &response) {
-  bool exception_occurred{false};
-  std::string error{};
-  try {
-    error = response.get<std::string>("error");
-  } catch (const std::exception &/*e*/) {
-    exception_occurred = true;
-  }
 
-  if (exception_occurred == true) {
-    LogError("stop response broken");
-    return;
-  }
+void NcStreamerRemote::RequestExit(
+    const ErrorHandler &error_handler,
+    const CancellationToken &cancellation_token) {
+  impl_->RequestExit(error_handler, cancellation_token);
+}
+
 
-  if (error.empty() == false) {
-    static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-    current_error_handler_(
-        ErrorCategory::kMisc, 0, converter.from_bytes(error));
-  } else {
-    current_quality_update_response_handler_(true);
-  }
+void NcStreamerRemote::RequestBatch(
+    const std::vector<BatchItem> &items,
+    const ErrorHandler &error_handler,
+    const BatchResponseHandler &batch_response_handler,
+    const CancellationToken &cancellation_token) {
+  impl_->RequestBatch(
+      items,
+      error_handler,
+      batch_response_handler,
+      cancellation_token);
 }
 
 
-void NcStreamerRemote::HandleDisconnect(
-    Error::Connection err_code) {
-  remote_connection_.reset();
-  busy_ = false;
-  LogWarning(ErrorConverter::ToConnectionError(err_code));
+void NcStreamerRemote::RequestStatus(
+    UniqueErrorHandler &&error_handler,
+    UniqueStatusResponseHandler &&status_response_handler,
+    const CancellationToken &cancellation_token) {
+  impl_->RequestStatus(
+      std::move(error_handler),
+      std::move(status_response_handler),
+      cancellation_token);
+}
 
-  if (disconnect_handler_) {
-    disconnect_handler_();
-  }
 
-  KeepConnected();
+std::shared_ptr<const StreamerStatus>
+    NcStreamerRemote::GetCachedStatus() const {
+  return impl_->GetCachedStatus();
 }
 
 
-void NcStreamerRemote::HandleConnectionError(
-    Error::Connection err_code,
-    const ErrorHandler &err_handler) {
-  std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+void NcStreamerRemote::RequestCachedStatus(
+    std::uint32_t max_age_ms,
+    const ErrorHandler &error_handler,
+    const StatusResponseHandler &status_response_handler,
+    const CancellationToken &cancellation_token) {
+  impl_->RequestCachedStatus(
+      max_age_ms,
+      error_handler,
+      status_response_handler,
+      cancellation_token);
+}
+
 
-  err_handler(
-      ErrorCategory::kConnection,
-      static_cast<int>(err_code),
-      converter.from_bytes(ErrorConverter::ToConnectionError(err_code)));
+void NcStreamerRemote::RequestStart(
+    std::wstring &&title,
+    UniqueErrorHandler &&error_handler,
+    UniqueStartResponseHandler &&start_response_handler,
+    const CancellationToken &cancellation_token) {
+  impl_->RequestStart(
+      std::move(title),
+      std::move(error_handler),
+      std::move(start_response_handler),
+      cancellation_token);
 }
 
 
-void NcStreamerRemote::HandleError(
-    Error::Connection err_code,
-    const websocketpp::lib::error_code &ec) {
-  HandleError(err_code, ec, current_error_handler_);
+void NcStreamerRemote::RequestStop(
+    std::wstring &&title,
+    UniqueErrorHandler &&error_handler,
+    UniqueStopResponseHandler &&stop_response_handler,
+    const CancellationToken &cancellation_token) {
+  impl_->RequestStop(
+      std::move(title),
+      std::move(error_handler),
+      std::move(stop_response_handler),
+      cancellation_token);
 }
 
 
-void NcStreamerRemote::HandleError(
-    Error::Connection err_code,
-    const websocketpp::lib::error_code &ec,
-    const ErrorHandler &err_handler) {
-  const auto &err_msg = ErrorConverter::ToConnectionError(err_code);
-  std::stringstream ss;
-  ss << err_msg << ": " << ec.message();
-  HandleError(err_code, ss.str(), err_handler);
+void NcStreamerRemote::RequestQualityUpdate(
+    std::wstring &&quality,
+    UniqueErrorHandler &&error_handler,
+    UniqueSuccessHandler &&quality_update_response_handler,
+    const CancellationToken &cancellation_token) {
+  impl_->RequestQualityUpdate(
+      std::move(quality),
+      std::move(error_handler),
+      std::move(quality_update_response_handler),
+      cancellation_token);
 }
 
 
-void NcStreamerRemote::HandleError(
-    Error::Connection err_code) {
-  const auto &err_msg = ErrorConverter::ToConnectionError(err_code);
-  HandleError(err_code, err_msg, current_error_handler_);
+void NcStreamerRemote::RequestExit(
+    UniqueErrorHandler &&error_handler,
+    const CancellationToken &cancellation_token) {
+  impl_->RequestExit(std::move(error_handler), cancellation_token);
 }
 
 
-void NcStreamerRemote::HandleError(
-    Error::Connection err_code,
-    const std::string &err_msg,
-    const ErrorHandler &err_handler) {
-  busy_ = false;
-  LogError(err_msg);
+void NcStreamerRemote::RequestBatch(
+    std::vector<BatchItem> &&items,
+    UniqueErrorHandler &&error_handler,
+    UniqueBatchResponseHandler &&batch_response_handler,
+    const CancellationToken &cancellation_token) {
+  impl_->RequestBatch(
+      std::move(items),
+      std::move(error_handler),
+      std::move(batch_response_handler),
+      cancellation_token);
+}
+
 
-  if (err_handler) {
-    static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
-    err_handler(
-        ErrorCategory::kConnection,
-        static_cast<int>(err_code),
-        converter.from_bytes(err_msg));
-  }
+RemoteFuture<StatusResponse> NcStreamerRemote::RequestStatus(
+    const CancellationToken &cancellation_token) {
+  RemotePromise<StatusResponse> promise{NewPromise<StatusResponse>()};
+  impl_->RequestStatus(
+      ToErrorHandler(promise),
+      UniqueStatusResponseHandler{[promise](
+          const std::wstring &status,
+          const std::wstring &source_title,
+          const std::wstring &user_name,
+          const std::wstring &quality) {
+        promise.SetValue(
+            StatusResponse{status, source_title, user_name, quality});
+      }},
+      cancellation_token);
+  return promise.GetFuture();
 }
 
 
-void NcStreamerRemote::HandleError(
-    Error::Connection err_code,
-    const ErrorHandler &err_handler) {
-  const auto &err_msg = ErrorConverter::ToConnectionError(err_code);
-  HandleError(err_code, err_msg, err_handler);
+RemoteFuture<bool> NcStreamerRemote::RequestStart(
+    const std::wstring &title,
+    const CancellationToken &cancellation_token) {
+  RemotePromise<bool> promise{NewPromise<bool>()};
+  impl_->RequestStart(
+      std::wstring{title},
+      ToErrorHandler(promise),
+      ToSuccessHandler<UniqueStartResponseHandler>(promise),
+      cancellation_token);
+  return promise.GetFuture();
 }
 
 
-void NcStreamerRemote::LogWarning(const std::string &warn_msg) {
-  remote_.get_elog().write(websocketpp::log::elevel::warn, warn_msg);
+RemoteFuture<bool> NcStreamerRemote::RequestStop(
+    const std::wstring &title,
+    const CancellationToken &cancellation_token) {
+  RemotePromise<bool> promise{NewPromise<bool>()};
+  impl_->RequestStop(
+      std::wstring{title},
+      ToErrorHandler(promise),
+      ToSuccessHandler<UniqueStopResponseHandler>(promise),
+      cancellation_token);
+  return promise.GetFuture();
 }
 
 
-void NcStreamerRemote::LogError(const std::string &err_msg) {
-  remote_.get_elog().write(websocketpp::log::elevel::rerror, err_msg);
+RemoteFuture<bool> NcStreamerRemote::RequestQualityUpdate(
+    const std::wstring &quality,
+    const CancellationToken &cancellation_token) {
+  RemotePromise<bool> promise{NewPromise<bool>()};
+  impl_->RequestQualityUpdate(
+      std::wstring{quality},
+      ToErrorHandler(promise),
+      ToSuccessHandler<UniqueSuccessHandler>(promise),
+      cancellation_token);
+  return promise.GetFuture();
+}
+
+
+RemoteFuture<std::vector<BatchResult>> NcStreamerRemote::RequestBatch(
+    const std::vector<BatchItem> &items,
+    const CancellationToken &cancellation_token) {
+  RemotePromise<std::vector<BatchResult>> promise{
+      NewPromise<std::vector<BatchResult>>()};
+  impl_->RequestBatch(
+      std::vector<BatchItem>{items},
+      ToErrorHandler(promise),
+      UniqueBatchResponseHandler{[promise](
+          const std::vector<BatchResult> &results) {
+        promise.SetValue(results);
+      }},
+      cancellation_token);
+  return promise.GetFuture();
 }
 
 
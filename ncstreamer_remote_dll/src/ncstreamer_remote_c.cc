@@ -0,0 +1,378 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/ncstreamer_remote_c.h"
+
+#include <codecvt>
+#include <cstring>
+#include <exception>
+#include <locale>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/ncstreamer_remote.h"
+
+
+struct NcStreamerRemoteHandle {
+  std::unique_ptr<ncstreamer_remote::NcStreamerRemote> remote;
+};
+
+
+namespace {
+using ncstreamer_remote::ErrorCategory;
+using ncstreamer_remote::NcStreamerRemote;
+
+
+NcStreamerRemoteString ToCString(const std::string &str) {
+  return NcStreamerRemoteString{str.data(), str.size()};
+}
+
+
+NcStreamerRemoteString ToCString(const ncstreamer_remote::Utf8View &view) {
+  return NcStreamerRemoteString{view.data, view.size};
+}
+
+
+NcStreamerRemoteString ToCString(const char *str) {
+  return NcStreamerRemoteString{str, std::strlen(str)};
+}
+
+
+/// Reports an exception caught in the C layer through error_callback,
+/// without allocating, as it may be std::bad_alloc.
+void ReportException(
+    const std::exception &e,
+    NcStreamerRemoteErrorCallback error_callback,
+    void *user_data) {
+  if (!error_callback) {
+    return;
+  }
+  const char *err_msg =
+      (dynamic_cast<const std::range_error *>(&e) != nullptr) ?
+          "the string isn't valid UTF-8" :
+          "the request couldn't be made";
+  const NcStreamerRemoteError err{
+      static_cast<int>(ErrorCategory::kMisc), 0, ToCString(err_msg)};
+  error_callback(&err, user_data);
+}
+
+
+/// @throw std::range_error if the string isn't valid UTF-8.
+std::wstring ToWide(const NcStreamerRemoteString &str) {
+  if (str.size == 0) {
+    return std::wstring{};
+  }
+  std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+  return converter.from_bytes(str.data, str.data + str.size);
+}
+
+
+NcStreamerRemote::UniqueErrorHandler ToErrorHandler(
+    NcStreamerRemoteErrorCallback error_callback,
+    void *user_data) {
+  return NcStreamerRemote::UniqueErrorHandler{[error_callback, user_data](
+      ErrorCategory category,
+      int err_code,
+      const std::wstring &err_msg) {
+    if (!error_callback) {
+      return;
+    }
+    std::string utf8_err_msg{};
+    try {
+      std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+      utf8_err_msg = converter.to_bytes(err_msg);
+    } catch (const std::exception &/*e*/) {
+      utf8_err_msg.clear();  // the error is still told, without its message.
+    }
+    const NcStreamerRemoteError err{
+        static_cast<int>(category), err_code, ToCString(utf8_err_msg)};
+    error_callback(&err, user_data);
+  }};
+}
+
+
+NcStreamerRemote::UniqueSuccessHandler ToSuccessHandler(
+    NcStreamerRemoteSuccessCallback success_callback,
+    void *user_data) {
+  return NcStreamerRemote::UniqueSuccessHandler{
+      [success_callback, user_data](bool success) {
+    if (success_callback) {
+      success_callback(success ? 1 : 0, user_data);
+    }
+  }};
+}
+
+
+/// Tells error_callback instead, if the response can't be converted.
+NcStreamerRemote::UniqueStatusResponseHandler ToStatusResponseHandler(
+    NcStreamerRemoteErrorCallback error_callback,
+    NcStreamerRemoteStatusCallback status_callback,
+    void *user_data) {
+  return NcStreamerRemote::UniqueStatusResponseHandler{
+      [error_callback, status_callback, user_data](
+          const std::wstring &status,
+          const std::wstring &source_title,
+          const std::wstring &user_name,
+          const std::wstring &quality) {
+    if (!status_callback) {
+      return;
+    }
+    std::string utf8_status{};
+    std::string utf8_source_title{};
+    std::string utf8_user_name{};
+    std::string utf8_quality{};
+    try {
+      std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+      utf8_status = converter.to_bytes(status);
+      utf8_source_title = converter.to_bytes(source_title);
+      utf8_user_name = converter.to_bytes(user_name);
+      utf8_quality = converter.to_bytes(quality);
+    } catch (const std::exception &e) {
+      ReportException(e, error_callback, user_data);
+      return;
+    }
+    const NcStreamerRemoteStatus c_status{
+        ToCString(utf8_status),
+        ToCString(utf8_source_title),
+        ToCString(utf8_user_name),
+        ToCString(utf8_quality)};
+    status_callback(&c_status, user_data);
+  }};
+}
+
+
+NcStreamerRemoteHandle *NewHandle(
+    const ncstreamer_remote::PortDiscovery &discovery) {
+  try {
+    return new NcStreamerRemoteHandle{
+        NcStreamerRemote::Create(discovery, nullptr)};
+  } catch (const std::exception &/*e*/) {
+    return nullptr;  // no exception crosses the C interface.
+  }
+}
+}  // unnamed namespace
+
+
+NcStreamerRemoteHandle *NcStreamerRemoteCreate(
+    uint16_t remote_port) {
+  return NewHandle(ncstreamer_remote::PortDiscovery{
+      {remote_port}, std::string{}, 0});
+}
+
+
+NcStreamerRemoteHandle *NcStreamerRemoteCreateDiscovering(
+    const uint16_t *candidate_ports,
+    size_t candidate_port_count,
+    uint32_t probe_timeout_ms) {
+  return NewHandle(ncstreamer_remote::PortDiscovery{
+      {candidate_ports, candidate_ports + candidate_port_count},
+      std::string{},
+      probe_timeout_ms});
+}
+
+
+void NcStreamerRemoteDestroy(
+    NcStreamerRemoteHandle *remote) {
+  delete remote;
+}
+
+
+int NcStreamerRemoteClose(
+    NcStreamerRemoteHandle *remote,
+    uint32_t deadline_ms,
+    int flush_urgent) {
+  try {
+    return remote->remote->Close(deadline_ms, flush_urgent != 0) ? 1 : 0;
+  } catch (const std::exception &/*e*/) {
+    return 0;
+  }
+}
+
+
+int NcStreamerRemoteSetReadyCallback(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteReadyCallback callback,
+    void *user_data) {
+  try {
+    if (!callback) {
+      remote->remote->RegisterReadyHandler(nullptr);
+      return 1;
+    }
+    remote->remote->RegisterReadyHandler([callback, user_data](bool success) {
+      callback(success ? 1 : 0, user_data);
+    });
+    return 1;
+  } catch (const std::exception &/*e*/) {
+    return 0;
+  }
+}
+
+
+int NcStreamerRemoteSetConnectCallback(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteConnectionCallback callback,
+    void *user_data) {
+  try {
+    if (!callback) {
+      remote->remote->RegisterConnectHandler(nullptr);
+      return 1;
+    }
+    remote->remote->RegisterConnectHandler([callback, user_data]() {
+      callback(user_data);
+    });
+    return 1;
+  } catch (const std::exception &/*e*/) {
+    return 0;
+  }
+}
+
+
+int NcStreamerRemoteSetDisconnectCallback(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteConnectionCallback callback,
+    void *user_data) {
+  try {
+    if (!callback) {
+      remote->remote->RegisterDisconnectHandler(nullptr);
+      return 1;
+    }
+    remote->remote->RegisterDisconnectHandler([callback, user_data]() {
+      callback(user_data);
+    });
+    return 1;
+  } catch (const std::exception &/*e*/) {
+    return 0;
+  }
+}
+
+
+int NcStreamerRemoteSetStartEventCallback(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteStartEventCallback callback,
+    void *user_data) {
+  try {
+    if (!callback) {
+      remote->remote->RegisterUtf8StartEventHandler(nullptr);
+      return 1;
+    }
+    remote->remote->RegisterUtf8StartEventHandler([callback, user_data](
+        const ncstreamer_remote::Utf8StartEvent &evt) {
+      const NcStreamerRemoteStartEvent c_evt{
+          ToCString(evt.source_title),
+          ToCString(evt.user_page),
+          ToCString(evt.privacy),
+          ToCString(evt.description),
+          ToCString(evt.mic),
+          ToCString(evt.service_provider),
+          ToCString(evt.stream_url),
+          ToCString(evt.post_url)};
+      callback(&c_evt, user_data);
+    });
+    return 1;
+  } catch (const std::exception &/*e*/) {
+    return 0;
+  }
+}
+
+
+int NcStreamerRemoteSetStopEventCallback(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteStopEventCallback callback,
+    void *user_data) {
+  try {
+    if (!callback) {
+      remote->remote->RegisterUtf8StopEventHandler(nullptr);
+      return 1;
+    }
+    remote->remote->RegisterUtf8StopEventHandler([callback, user_data](
+        const ncstreamer_remote::Utf8StopEvent &evt) {
+      const NcStreamerRemoteStopEvent c_evt{ToCString(evt.source_title)};
+      callback(&c_evt, user_data);
+    });
+    return 1;
+  } catch (const std::exception &/*e*/) {
+    return 0;
+  }
+}
+
+
+void NcStreamerRemoteRequestStatus(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteErrorCallback error_callback,
+    NcStreamerRemoteStatusCallback status_callback,
+    void *user_data) {
+  try {
+    remote->remote->RequestStatus(
+        ToErrorHandler(error_callback, user_data),
+        ToStatusResponseHandler(error_callback, status_callback, user_data));
+  } catch (const std::exception &e) {
+    ReportException(e, error_callback, user_data);
+  }
+}
+
+
+void NcStreamerRemoteRequestStart(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteString title,
+    NcStreamerRemoteErrorCallback error_callback,
+    NcStreamerRemoteSuccessCallback start_callback,
+    void *user_data) {
+  try {
+    remote->remote->RequestStart(
+        ToWide(title),
+        ToErrorHandler(error_callback, user_data),
+        ToSuccessHandler(start_callback, user_data));
+  } catch (const std::exception &e) {
+    ReportException(e, error_callback, user_data);
+  }
+}
+
+
+void NcStreamerRemoteRequestStop(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteString title,
+    NcStreamerRemoteErrorCallback error_callback,
+    NcStreamerRemoteSuccessCallback stop_callback,
+    void *user_data) {
+  try {
+    remote->remote->RequestStop(
+        ToWide(title),
+        ToErrorHandler(error_callback, user_data),
+        ToSuccessHandler(stop_callback, user_data));
+  } catch (const std::exception &e) {
+    ReportException(e, error_callback, user_data);
+  }
+}
+
+
+void NcStreamerRemoteRequestQualityUpdate(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteString quality,
+    NcStreamerRemoteErrorCallback error_callback,
+    NcStreamerRemoteSuccessCallback quality_update_callback,
+    void *user_data) {
+  try {
+    remote->remote->RequestQualityUpdate(
+        ToWide(quality),
+        ToErrorHandler(error_callback, user_data),
+        ToSuccessHandler(quality_update_callback, user_data));
+  } catch (const std::exception &e) {
+    ReportException(e, error_callback, user_data);
+  }
+}
+
+
+void NcStreamerRemoteRequestExit(
+    NcStreamerRemoteHandle *remote,
+    NcStreamerRemoteErrorCallback error_callback,
+    void *user_data) {
+  try {
+    remote->remote->RequestExit(ToErrorHandler(error_callback, user_data));
+  } catch (const std::exception &e) {
+    ReportException(e, error_callback, user_data);
+  }
+}
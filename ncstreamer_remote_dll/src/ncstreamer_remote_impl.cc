@@ -0,0 +1,2686 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/src/ncstreamer_remote_impl.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>  // NOLINT
+#include <codecvt>
+#include <future>  // NOLINT
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+
+#include "boost/algorithm/string.hpp"
+#include "boost/property_tree/json_parser.hpp"
+
+#include "Windows.h"  // NOLINT
+
+#include "ncstreamer_remote_dll/src/callback_watchdog.h"
+#include "ncstreamer_remote_dll/src/cancellation_relay.h"
+#include "ncstreamer_remote_dll/src/error/error_converter.h"
+#include "ncstreamer_remote_dll/src/handler_memory.h"
+#include "ncstreamer_remote_dll/src/msgpack_codec.h"
+#include "ncstreamer_remote_dll/src/ncstreamer_remote_message_types.h"
+#include "ncstreamer_remote_dll/src/port_prober.h"
+#include "ncstreamer_remote_dll/src/request_payload_cache.h"
+#include "ncstreamer_remote_dll/src/request_queue.h"
+#include "ncstreamer_remote_dll/src/request_throttle.h"
+#include "ncstreamer_remote_dll/src/stats_recorder.h"
+#include "ncstreamer_remote_dll/src/streamer_status_cache.h"
+#include "ncstreamer_remote_dll/src/traffic_capture.h"
+
+
+namespace {
+using MessageType = ncstreamer::RemoteMessage::MessageType;
+
+
+bool IsInFlight(
+    bool busy,
+    const ncstreamer_remote::QueuedRequest &request,
+    MessageType request_type) {
+  return busy == true && request.type == request_type;
+}
+
+
+/// Sets the category and the code of an error from NCStreamer,
+/// leaving its message.
+/// @return The static description of the error, or null if it is unknown.
+const ncstreamer_remote::ErrorDescription *ToErrorCode(
+    ncstreamer_remote::BatchItem::Type request_type,
+    const std::string &error,
+    ncstreamer_remote::BatchResult *result) {
+  using ncstreamer_remote::BatchItem;
+  using ncstreamer_remote::ErrorCategory;
+  using ncstreamer_remote::ErrorConverter;
+
+  switch (request_type) {
+    case BatchItem::Type::kStart: {
+      const auto &err_info = ErrorConverter::ToStartError(error);
+      result->category = ErrorCategory::kStart;
+      result->err_code = static_cast<int>(err_info.first);
+      return err_info.second;
+    }
+    case BatchItem::Type::kStop: {
+      const auto &err_info = ErrorConverter::ToStopError(error);
+      result->category = ErrorCategory::kStop;
+      result->err_code = static_cast<int>(err_info.first);
+      return err_info.second;
+    }
+    default: {
+      result->category = ErrorCategory::kMisc;
+      return nullptr;
+    }
+  }
+}
+
+
+/// For an error unknown to this version, whose ID is all there is to tell.
+std::wstring ToWide(const std::string &error) {
+  std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+  return converter.from_bytes(error);
+}
+
+
+/// @return The result owning its message, e.g. to keep in a batch.
+ncstreamer_remote::BatchResult ToResult(
+    ncstreamer_remote::BatchItem::Type request_type,
+    const std::string &error) {
+  using ncstreamer_remote::ErrorCategory;
+
+  ncstreamer_remote::BatchResult result{
+      ErrorCategory::kNoCategory, 0, std::wstring{}};
+  if (error.empty() == true) {
+    return result;
+  }
+
+  const ncstreamer_remote::ErrorDescription *description =
+      ToErrorCode(request_type, error, &result);
+  result.err_msg = description ? description->wide : ToWide(error);
+  return result;
+}
+
+
+/// @return kUndefined if no response comes to the request.
+MessageType ToResponseType(MessageType request_type) {
+  switch (request_type) {
+    case MessageType::kStreamingStatusRequest:
+      return MessageType::kStreamingStatusResponse;
+    case MessageType::kStreamingStartRequest:
+      return MessageType::kStreamingStartResponse;
+    case MessageType::kStreamingStopRequest:
+      return MessageType::kStreamingStopResponse;
+    case MessageType::kSettingsQualityUpdateRequest:
+      return MessageType::kSettingsQualityUpdateResponse;
+    case MessageType::kBatchRequest:
+      return MessageType::kBatchResponse;
+    default:
+      return MessageType::kUndefined;
+  }
+}
+
+
+ncstreamer_remote::Utf8View ToUtf8View(const std::string &str) {
+  return ncstreamer_remote::Utf8View{str.data(), str.size()};
+}
+
+
+/// The strings are bound to the handler, so that they outlive
+/// an offloaded call.
+void CallUtf8StartEventHandler(
+    const ncstreamer_remote::NcStreamerRemote::Utf8StartEventHandler &handler,
+    const std::string &source_title,
+    const std::string &user_page,
+    const std::string &privacy,
+    const std::string &description,
+    const std::string &mic,
+    const std::string &service_provider,
+    const std::string &stream_url,
+    const std::string &post_url) {
+  handler(ncstreamer_remote::Utf8StartEvent{
+      ToUtf8View(source_title),
+      ToUtf8View(user_page),
+      ToUtf8View(privacy),
+      ToUtf8View(description),
+      ToUtf8View(mic),
+      ToUtf8View(service_provider),
+      ToUtf8View(stream_url),
+      ToUtf8View(post_url)});
+}
+
+
+void CallUtf8StopEventHandler(
+    const ncstreamer_remote::NcStreamerRemote::Utf8StopEventHandler &handler,
+    const std::string &source_title) {
+  handler(ncstreamer_remote::Utf8StopEvent{ToUtf8View(source_title)});
+}
+}  // unnamed namespace
+
+
+namespace ncstreamer_remote {
+void NcStreamerRemote::Impl::RegisterConnectHandler(
+    const ConnectHandler &connect_handler) {
+  connect_handler_ = connect_handler;
+}
+
+
+void NcStreamerRemote::Impl::RegisterReadyHandler(
+    const ReadyHandler &ready_handler) {
+  bool success{false};
+  {
+    std::lock_guard<std::mutex> lock{ready_mutex_};
+    if (initialized_ == false) {
+      ready_handler_ = ready_handler;
+      return;
+    }
+    success = initialization_succeeded_;
+  }
+  if (ready_handler) {
+    ready_handler(success);
+  }
+}
+
+
+void NcStreamerRemote::Impl::RegisterDisconnectHandler(
+    const DisconnectHandler &disconnect_handler) {
+  disconnect_handler_ = disconnect_handler;
+}
+
+
+void NcStreamerRemote::Impl::RegisterStartEventHandler(
+    const StartEventHandler &start_event_handler) {
+  start_event_handler_ = start_event_handler;
+}
+
+
+void NcStreamerRemote::Impl::RegisterStopEventHandler(
+    const StopEventHandler &stop_event_handler) {
+  stop_event_handler_ = stop_event_handler;
+}
+
+
+void NcStreamerRemote::Impl::RegisterUtf8StartEventHandler(
+    const Utf8StartEventHandler &start_event_handler) {
+  utf8_start_event_handler_ = start_event_handler;
+}
+
+
+void NcStreamerRemote::Impl::RegisterUtf8StopEventHandler(
+    const Utf8StopEventHandler &stop_event_handler) {
+  utf8_stop_event_handler_ = stop_event_handler;
+}
+
+
+void NcStreamerRemote::Impl::SetStatusCoalescingWindow(
+    std::uint32_t window_ms) {
+  status_coalescing_window_ms_ = window_ms;
+}
+
+
+void NcStreamerRemote::Impl::SetQualityUpdateDebounceWindow(
+    std::uint32_t window_ms) {
+  quality_update_debounce_window_ms_ = window_ms;
+}
+
+
+void NcStreamerRemote::Impl::SetCallbackBudget(
+    std::uint32_t budget_us,
+    const SlowCallbackHandler &slow_callback_handler,
+    std::uint32_t offload_after) {
+  callback_watchdog_->SetBudget(
+      budget_us, slow_callback_handler, offload_after);
+}
+
+
+void NcStreamerRemote::Impl::SetRequestQueuePolicy(
+    std::size_t capacity,
+    OverflowPolicy overflow_policy,
+    std::uint32_t block_timeout_ms) {
+  request_queue_->SetPolicy(capacity, overflow_policy, block_timeout_ms);
+}
+
+
+void NcStreamerRemote::Impl::SetBinaryEncodingEnabled(bool enabled) {
+  binary_encoding_enabled_ = enabled;
+}
+
+
+void NcStreamerRemote::Impl::SetRateLimit(
+    RequestType type,
+    const RateLimit &rate_limit) {
+  request_throttle_->SetRateLimit(type, rate_limit);
+}
+
+
+bool NcStreamerRemote::Impl::StartCapture(const std::string &path) {
+  return traffic_capture_->Open(path);
+}
+
+
+void NcStreamerRemote::Impl::StopCapture() {
+  traffic_capture_->Close();
+}
+
+
+ReplayStats NcStreamerRemote::Impl::Replay(
+    const std::string &capture_path,
+    bool recorded_speed) {
+  ReplayStats replay_stats{false, 0, 0, 0, 0, 0};
+  TrafficCaptureReader reader{};
+  if (reader.Open(capture_path) == false) {
+    return replay_stats;
+  }
+  replay_stats.succeeded = true;
+
+  // read up front, to keep the file out of the timing.
+  auto records = std::make_shared<std::vector<TrafficRecord>>();
+  TrafficRecord record{};
+  while (reader.Read(&record) == true) {
+    records->emplace_back(std::move(record));
+  }
+
+  auto done = std::make_shared<std::promise<void>>();
+  std::future<void> replayed = done->get_future();
+  std::int64_t begin_ns = StatsRecorder::NowNs();
+  for (std::size_t i = 0; i < records->size(); ++i) {
+    const TrafficRecord &next = (*records)[i];
+    switch (next.kind) {
+      case TrafficRecord::Kind::kInboundText:
+      case TrafficRecord::Kind::kInboundBinary:
+        ++replay_stats.frames;
+        replay_stats.bytes += next.payload.size();
+        break;
+      case TrafficRecord::Kind::kOutboundText:
+      case TrafficRecord::Kind::kOutboundBinary:
+        ++replay_stats.frames_skipped;
+        continue;
+      default:
+        ++replay_stats.connection_events;
+        break;
+    }
+
+    if (recorded_speed == true) {
+      std::int64_t wait_ns = begin_ns + next.time_ns - StatsRecorder::NowNs();
+      if (wait_ns > 0) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds{wait_ns});
+      }
+    }
+    Post([this, records, i]() {
+      ReplayRecord((*records)[i]);
+    });
+  }
+  Post([done]() {
+    done->set_value();
+  });
+
+  if (io_pool_->IsManual() == true) {
+    while (io_pool_->Poll() != 0) {
+      // runs the records here, as no io thread does.
+    }
+  }
+  replayed.wait();
+  replay_stats.elapsed_ns =
+      static_cast<std::uint64_t>(StatsRecorder::NowNs() - begin_ns);
+  return replay_stats;
+}
+
+
+RemoteStats NcStreamerRemote::Impl::GetStats() const {
+  RemoteStats stats = stats_->Snapshot();
+  stats.queue_depth = request_queue_->size();
+  return stats;
+}
+
+
+void NcStreamerRemote::Impl::RequestStatus(
+    const ErrorHandler &error_handler,
+    const StatusResponseHandler &status_response_handler,
+    const CancellationToken &cancellation_token) {
+  RequestStatus(
+      UniqueErrorHandler{error_handler},
+      UniqueStatusResponseHandler{status_response_handler},
+      cancellation_token);
+}
+
+
+void NcStreamerRemote::Impl::RequestStart(
+    const std::wstring &title,
+    const ErrorHandler &error_handler,
+    const StartResponseHandler &start_response_handler,
+    const CancellationToken &cancellation_token) {
+  RequestStart(
+      std::wstring{title},
+      UniqueErrorHandler{error_handler},
+      UniqueStartResponseHandler{start_response_handler},
+      cancellation_token);
+}
+
+
+void NcStreamerRemote::Impl::RequestStop(
+    const std::wstring &title,
+    const ErrorHandler &error_handler,
+    const StopResponseHandler &stop_response_handler,
+    const CancellationToken &cancellation_token) {
+  RequestStop(
+      std::wstring{title},
+      UniqueErrorHandler{error_handler},
+      UniqueStopResponseHandler{stop_response_handler},
+      cancellation_token);
+}
+
+
+void NcStreamerRemote::Impl::RequestQualityUpdate(
+    const std::wstring &quality,
+    const ErrorHandler &error_handler,
+    const SuccessHandler &quality_update_response_handler,
+    const CancellationToken &cancellation_token) {
+  RequestQualityUpdate(
+      std::wstring{quality},
+      UniqueErrorHandler{error_handler},
+      UniqueSuccessHandler{quality_update_response_handler},
+      cancellation_token);
+}
+
+
+void NcStreamerRemote::Impl::RequestExit(
+    const ErrorHandler &error_handler,
+    const CancellationToken &cancellation_token) {
+  RequestExit(
+      UniqueErrorHandler{error_handler},
+      cancellation_token);
+}
+
+
+void NcStreamerRemote::Impl::RequestBatch(
+    const std::vector<BatchItem> &items,
+    const ErrorHandler &error_handler,
+    const BatchResponseHandler &batch_response_handler,
+    const CancellationToken &cancellation_token) {
+  RequestBatch(
+      std::vector<BatchItem>{items},
+      UniqueErrorHandler{error_handler},
+      UniqueBatchResponseHandler{batch_response_handler},
+      cancellation_token);
+}
+
+
+void NcStreamerRemote::Impl::RequestStatus(
+    UniqueErrorHandler &&error_handler,
+    UniqueStatusResponseHandler &&status_response_handler,
+    const CancellationToken &cancellation_token) {
+  StatsRecorder::Increase(&stats_->status_requests);
+  StartStatusRequest(
+      std::move(error_handler),
+      std::move(status_response_handler),
+      cancellation_token);
+}
+
+
+std::shared_ptr<const StreamerStatus>
+    NcStreamerRemote::Impl::GetCachedStatus() const {
+  return streamer_status_cache_->Get();
+}
+
+
+void NcStreamerRemote::Impl::RequestCachedStatus(
+    std::uint32_t max_age_ms,
+    const ErrorHandler &error_handler,
+    const StatusResponseHandler &status_response_handler,
+    const CancellationToken &cancellation_token) {
+  auto cached = streamer_status_cache_->Get();
+  if (cached->status.empty() == false &&
+      StreamerStatusCache::NowMs() - cached->updated_at_ms <= max_age_ms) {
+    status_response_handler(
+        cached->status,
+        cached->source_title,
+        cached->user_name,
+        cached->quality);
+    return;
+  }
+
+  RequestStatus(error_handler, status_response_handler, cancellation_token);
+}
+
+
+void NcStreamerRemote::Impl::RequestStart(
+    std::wstring &&title,
+    UniqueErrorHandler &&error_handler,
+    UniqueStartResponseHandler &&start_response_handler,
+    const CancellationToken &cancellation_token) {
+  QueuedRequest request{};
+  request.type = MessageType::kStreamingStartRequest;
+  request.param = std::move(title);
+  request.error_handler = std::move(error_handler);
+  request.response_handler = std::move(start_response_handler);
+  request.cancellation_token = cancellation_token;
+  Enqueue(&request);
+}
+
+
+void NcStreamerRemote::Impl::RequestStop(
+    std::wstring &&title,
+    UniqueErrorHandler &&error_handler,
+    UniqueStopResponseHandler &&stop_response_handler,
+    const CancellationToken &cancellation_token) {
+  QueuedRequest request{};
+  request.type = MessageType::kStreamingStopRequest;
+  request.param = std::move(title);
+  request.error_handler = std::move(error_handler);
+  request.response_handler = std::move(stop_response_handler);
+  request.cancellation_token = cancellation_token;
+  Enqueue(&request);
+}
+
+
+void NcStreamerRemote::Impl::RequestQualityUpdate(
+    std::wstring &&quality,
+    UniqueErrorHandler &&error_handler,
+    UniqueSuccessHandler &&quality_update_response_handler,
+    const CancellationToken &cancellation_token) {
+  StatsRecorder::Increase(&stats_->quality_updates);
+  if (closing_ == true) {
+    HandleConnectionError(Error::Connection::kShutDown, error_handler);
+    return;
+  }
+  if (quality_update_debounce_window_ms_ != 0) {
+    DebounceQualityUpdate(
+        std::move(quality),
+        std::move(error_handler),
+        std::move(quality_update_response_handler),
+        cancellation_token);
+    return;
+  }
+
+  StartQualityUpdate(
+      std::move(quality),
+      std::move(error_handler),
+      std::move(quality_update_response_handler),
+      cancellation_token);
+}
+
+
+void NcStreamerRemote::Impl::RequestExit(
+    UniqueErrorHandler &&error_handler,
+    const CancellationToken &cancellation_token) {
+  QueuedRequest request{};
+  request.type = MessageType::kNcStreamerExitRequest;
+  request.error_handler = std::move(error_handler);
+  request.cancellation_token = cancellation_token;
+  Enqueue(&request);
+}
+
+
+void NcStreamerRemote::Impl::RequestBatch(
+    std::vector<BatchItem> &&items,
+    UniqueErrorHandler &&error_handler,
+    UniqueBatchResponseHandler &&batch_response_handler,
+    const CancellationToken &cancellation_token) {
+  StatsRecorder::Increase(&stats_->batch_requests);
+  if (items.empty() == true) {
+    if (batch_response_handler) {
+      batch_response_handler(std::vector<BatchResult>{});
+    }
+    return;
+  }
+
+  QueuedRequest request{};
+  request.type = MessageType::kBatchRequest;
+  request.error_handler = std::move(error_handler);
+  request.batch_items = std::move(items);
+  request.batch_response_handler = std::move(batch_response_handler);
+  request.cancellation_token = cancellation_token;
+  Enqueue(&request);
+}
+
+
+NcStreamerRemote::Impl::StatusWaiter::StatusWaiter(
+    UniqueErrorHandler &&error_handler,
+    UniqueStatusResponseHandler &&response_handler,
+    const CancellationToken &cancellation_token)
+    : error_handler{std::move(error_handler)},
+      response_handler{std::move(response_handler)},
+      cancellation_token{cancellation_token} {
+}
+
+
+NcStreamerRemote::Impl::StatusWaiter::StatusWaiter(StatusWaiter &&other)
+    : error_handler{std::move(other.error_handler)},
+      response_handler{std::move(other.response_handler)},
+      cancellation_token{std::move(other.cancellation_token)} {
+}
+
+
+NcStreamerRemote::Impl::StatusWaiter::~StatusWaiter() {
+}
+
+
+NcStreamerRemote::Impl::StatusWaiter &
+    NcStreamerRemote::Impl::StatusWaiter::operator=(StatusWaiter &&other) {
+  error_handler = std::move(other.error_handler);
+  response_handler = std::move(other.response_handler);
+  cancellation_token = std::move(other.cancellation_token);
+  return *this;
+}
+
+
+NcStreamerRemote::Impl::Impl(
+    const PortDiscovery &discovery,
+    const std::shared_ptr<IoPool> &io_pool,
+    const std::shared_ptr<RemoteClock> &clock,
+    const std::string &log_path)
+    : io_pool_{io_pool ? io_pool : IoPool::Create(1)},
+      owns_io_pool_{!io_pool},
+      clock_{clock ? clock : RemoteClock::CreateSteady()},
+      strand_{io_pool_->io_service()},
+      handler_memory_{std::make_shared<HandlerMemory>()},
+      remote_{},
+      remote_log_{},
+      closing_{false},
+      stopping_{false},
+      close_deadline_ns_{0},
+      ready_mutex_{},
+      initialized_{false},
+      initialization_succeeded_{false},
+      ready_handler_{},
+      outstanding_tasks_{0},
+      drain_mutex_{},
+      drain_cv_{},
+      discovery_{discovery},
+      discovered_port_{0},
+      remote_uri_{},
+      port_prober_{new PortProber{
+          &remote_, [this](std::function<void()> &&task) {
+            Dispatch(std::move(task));
+          }}},
+      timer_to_end_discovery_{clock_->CreateTimer(&io_pool_->io_service())},
+      remote_connection_mutex_{},
+      remote_connection_{},
+      connecting_{false},
+      timer_to_keep_connected_{clock_->CreateTimer(&io_pool_->io_service())},
+      stats_{new StatsRecorder{}},
+      traffic_capture_{new TrafficCaptureWriter{}},
+      callback_watchdog_{new CallbackWatchdog{stats_.get()}},
+      request_payload_cache_{new RequestPayloadCache{stats_.get()}},
+      streamer_status_cache_{new StreamerStatusCache{}},
+      binary_encoding_enabled_{},
+      request_queue_{new RequestQueue{
+          16, OverflowPolicy::kRejectNewest, 0}},
+      request_throttle_{new RequestThrottle{}},
+      timer_to_release_throttled_{clock_->CreateTimer(&io_pool_->io_service())},
+      current_request_{new QueuedRequest{}},
+      busy_{},
+      request_pending_{false},
+      cancellation_relay_{std::make_shared<CancellationRelay>(
+          [this](const CancellationToken &cancellation_token) {
+            Post([this, cancellation_token]() {
+              CancelRequests(cancellation_token);
+            });
+          })},
+      cancelled_responses_{},
+      batch_support_{BatchSupport::kUnknown},
+      batch_sequential_{false},
+      batch_cursor_{0},
+      batch_results_{},
+      timer_to_fall_back_batch_{clock_->CreateTimer(&io_pool_->io_service())},
+      last_event_seq_{0},
+      event_epoch_{},
+      event_epoch_confirmed_{false},
+      resuming_{false},
+      timer_to_resume_{clock_->CreateTimer(&io_pool_->io_service())},
+      connect_handler_{},
+      disconnect_handler_{},
+      start_event_handler_{},
+      stop_event_handler_{},
+      utf8_start_event_handler_{},
+      utf8_stop_event_handler_{},
+      status_waiters_mutex_{},
+      status_in_flight_{false},
+      status_waiters_{},
+      status_coalescing_window_ms_{0},
+      timer_to_coalesce_status_{clock_->CreateTimer(&io_pool_->io_service())},
+      quality_update_mutex_{},
+      debounced_quality_pending_{false},
+      debounced_quality_in_flight_{false},
+      debounced_quality_{},
+      debounced_quality_error_handler_{},
+      debounced_quality_response_handler_{},
+      debounced_quality_cancellation_token_{},
+      quality_in_flight_error_handler_{},
+      quality_in_flight_response_handler_{},
+      quality_in_flight_cancellation_token_{},
+      quality_update_debounce_window_ms_{0},
+      timer_to_debounce_quality_{clock_->CreateTimer(&io_pool_->io_service())} {
+  busy_ = false;
+  binary_encoding_enabled_ = true;
+
+  if (NeedsDiscovery() == false &&
+      discovery_.candidate_ports.empty() == false) {
+    discovered_port_ = discovery_.candidate_ports.front();
+    remote_uri_.reset(new websocketpp::uri{
+        false, "localhost", discovered_port_, ""});
+  }
+
+  static const std::size_t kStatusWaitersCapacity{8};
+  status_waiters_.reserve(kStatusWaitersCapacity);
+
+  // the rest is left to the io thread, not to hold up the caller.
+  const std::string path{log_path};
+  Post([this, path]() {
+    Initialize(path);
+  });
+}
+
+
+void NcStreamerRemote::Impl::Initialize(const std::string &log_path) {
+  remote_log_.open(log_path);
+  remote_.set_access_channels(websocketpp::log::alevel::all);
+  remote_.set_access_channels(websocketpp::log::elevel::all);
+  remote_.get_alog().set_ostream(&remote_log_);
+  remote_.get_elog().set_ostream(&remote_log_);
+
+  websocketpp::lib::error_code ec;
+  remote_.init_asio(&io_pool_->io_service(), ec);
+  if (ec) {
+    HandleError(Error::Connection::kRemoteInitAsio, ec);
+    assert(false);
+    FinishInitialization(false);
+    return;
+  }
+
+  remote_.set_open_handler([this](websocketpp::connection_hdl connection) {
+    Dispatch([this, connection]() {
+      OnRemoteOpen(connection);
+    });
+  });
+  remote_.set_fail_handler([this](websocketpp::connection_hdl connection) {
+    Dispatch([this, connection]() {
+      OnRemoteFail(connection);
+    });
+  });
+  remote_.set_close_handler([this](websocketpp::connection_hdl connection) {
+    Dispatch([this, connection]() {
+      OnRemoteClose(connection);
+    });
+  });
+  remote_.set_message_handler([this](
+      websocketpp::connection_hdl connection,
+      websocketpp::connection<AsioClient>::message_ptr msg) {
+    Dispatch([this, connection, msg]() {
+      OnRemoteMessage(connection, msg);
+    });
+  });
+
+  FinishInitialization(true);
+  KeepConnected();
+}
+
+
+void NcStreamerRemote::Impl::FinishInitialization(bool success) {
+  ReadyHandler ready_handler{};
+  {
+    std::lock_guard<std::mutex> lock{ready_mutex_};
+    initialized_ = true;
+    initialization_succeeded_ = success;
+    ready_handler.swap(ready_handler_);
+  }
+  if (ready_handler) {
+    callback_watchdog_->Run(CallbackKind::kReady, [&]() {
+      ready_handler(success);
+    });
+  }
+}
+
+
+NcStreamerRemote::Impl::~Impl() {
+  cancellation_relay_->Detach();
+  closing_ = true;
+  stopping_ = true;
+  if (owns_io_pool_ == true) {
+    io_pool_->Stop();  // nobody else runs on it; pending handlers are dropped.
+  } else {
+    Post([this]() {
+      Stop();
+    });
+    if (io_pool_->IsManual() == true) {
+      PollUntilDrained(std::numeric_limits<std::int64_t>::max());
+    } else {
+      std::unique_lock<std::mutex> lock{drain_mutex_};
+      drain_cv_.wait(lock, [this]() {
+        return IsDrained();
+      });
+    }
+  }
+  callback_watchdog_->Stop();
+}
+
+
+bool NcStreamerRemote::Impl::Close(
+    std::uint32_t deadline_ms,
+    bool flush_urgent) {
+  close_deadline_ns_ = StatsRecorder::NowNs() +
+      static_cast<std::int64_t>(deadline_ms) * 1000000;
+  closing_ = true;
+  Post([this, flush_urgent]() {
+    BeginClose(flush_urgent);
+  });
+  if (io_pool_->IsManual() == true) {
+    return PollUntilDrained(close_deadline_ns_);
+  }
+
+  std::unique_lock<std::mutex> lock{drain_mutex_};
+  return drain_cv_.wait_for(
+      lock,
+      std::chrono::milliseconds{deadline_ms},
+      [this]() {
+        return IsDrained();
+      });
+}
+
+
+template <typename Task>
+class NcStreamerRemote::Impl::PostedTask {
+ public:
+  PostedTask(Impl *impl, Task task)
+      : impl_{impl},
+        memory_{impl->handler_memory_},
+        task_(std::move(task)),
+        posted_ns_{StatsRecorder::NowNs()} {}
+
+  void operator()() {
+    std::int64_t latency_ns = StatsRecorder::NowNs() - posted_ns_;
+    StatsRecorder::Increase(&impl_->stats_->io_tasks);
+    if (latency_ns > 0) {
+      StatsRecorder::Add(
+          &impl_->stats_->io_task_latency_ns_total,
+          static_cast<std::uint64_t>(latency_ns));
+      StatsRecorder::Maximize(
+          &impl_->stats_->io_task_latency_ns_max,
+          static_cast<std::uint64_t>(latency_ns));
+    }
+    task_();
+    impl_->FinishTask();
+  }
+
+  /// asio takes the memory of the handler through these.
+  friend void *asio_handler_allocate(std::size_t size, PostedTask *task) {
+    return task->memory_->Allocate(size);
+  }
+
+  friend void asio_handler_deallocate(
+      void *block,
+      std::size_t size,
+      PostedTask *task) {
+    task->memory_->Deallocate(block, size);
+  }
+
+ private:
+  Impl *impl_;
+
+  /// Shared, as asio may free the handler after this instance is gone,
+  /// e.g. when a shared io pool drops it.
+  std::shared_ptr<HandlerMemory> memory_;
+
+  Task task_;
+  std::int64_t posted_ns_;
+};
+
+
+template <typename Task>
+void NcStreamerRemote::Impl::Post(Task &&task) {
+  ++outstanding_tasks_;
+  strand_.post(PostedTask<typename std::decay<Task>::type>{
+      this, std::forward<Task>(task)});
+}
+
+
+void NcStreamerRemote::Impl::Dispatch(std::function<void()> &&task) {
+  ++outstanding_tasks_;
+  std::function<void()> counted_task{std::move(task)};
+  strand_.dispatch([this, counted_task]() {
+    counted_task();
+    FinishTask();
+  });
+}
+
+
+void NcStreamerRemote::Impl::AsyncWait(
+    RemoteClock::Timer *timer,
+    std::function<void()> &&on_expired) {
+  ++outstanding_tasks_;
+  std::function<void()> counted_task{std::move(on_expired)};
+  timer->AsyncWait(strand_.wrap([this, counted_task](bool expired) {
+    if (expired == true && stopping_ == false) {
+      counted_task();
+    }
+    FinishTask();
+  }));
+}
+
+
+void NcStreamerRemote::Impl::FinishTask() {
+  --outstanding_tasks_;
+  if (closing_ == true) {
+    std::lock_guard<std::mutex> lock{drain_mutex_};
+    drain_cv_.notify_all();
+  }
+}
+
+
+void NcStreamerRemote::Impl::BeginClose(bool flush_urgent) {
+  FailThrottledRequests(flush_urgent);  // may queue the urgent ones.
+  request_queue_->Close();
+  FailQueuedRequests(flush_urgent);
+  FailDebouncedQualityUpdate();
+  if (busy_ == false && request_queue_->size() == 0) {
+    Stop();
+  }
+  // otherwise, CompleteRequest will stop once the queue is flushed.
+}
+
+
+void NcStreamerRemote::Impl::Stop() {
+  closing_ = true;
+  stopping_ = true;
+  timer_to_keep_connected_->Cancel();
+  timer_to_fall_back_batch_->Cancel();
+  timer_to_resume_->Cancel();
+  timer_to_end_discovery_->Cancel();
+  timer_to_release_throttled_->Cancel();
+  if (port_prober_->Cancel() == true) {
+    // no connect follows the discovery, so nothing else clears connecting_.
+    // a request waiting for the connection is failed below, as busy_.
+    DropPendingRequest();
+  }
+  {
+    std::lock_guard<std::mutex> lock{status_waiters_mutex_};
+    timer_to_coalesce_status_->Cancel();
+  }
+  {
+    std::lock_guard<std::mutex> lock{quality_update_mutex_};
+    timer_to_debounce_quality_->Cancel();
+  }
+
+  websocketpp::connection_hdl connection;
+  {
+    std::lock_guard<std::mutex> lock{remote_connection_mutex_};
+    connection = remote_connection_;
+  }
+  if (busy_ == true) {
+    HandleError(Error::Connection::kShutDown);
+  }
+  FailThrottledRequests(false);
+  request_queue_->Close();
+  FailQueuedRequests(false);
+  FailDebouncedQualityUpdate();
+  FailStatusWaiters(
+      ErrorCategory::kConnection,
+      static_cast<int>(Error::Connection::kShutDown),
+      ErrorConverter::ToConnectionError(Error::Connection::kShutDown).wide);
+
+  if (connection.lock()) {
+    websocketpp::lib::error_code close_ec;
+    auto con = remote_.get_con_from_hdl(connection, close_ec);
+    if (!close_ec) {
+      con->set_close_handshake_timeout(GetCloseTimeoutMs());
+    }
+    remote_.close(
+        connection, websocketpp::close::status::going_away, "", close_ec);
+  }
+}
+
+
+void NcStreamerRemote::Impl::FailQueuedRequests(bool keep_urgent) {
+  QueuedRequest request{};
+  while (request_queue_->PopLeastUrgent(&request, keep_urgent) == true) {
+    HandleConnectionError(Error::Connection::kShutDown, request.error_handler);
+  }
+}
+
+
+void NcStreamerRemote::Impl::FailThrottledRequests(bool keep_urgent) {
+  QueuedRequest request{};
+  while (request_throttle_->PopAny(&request) == true) {
+    if (keep_urgent == true && RequestQueue::IsUrgent(request) == true) {
+      PushRequest(&request);
+      continue;
+    }
+    HandleConnectionError(Error::Connection::kShutDown, request.error_handler);
+  }
+}
+
+
+void NcStreamerRemote::Impl::FailDebouncedQualityUpdate() {
+  UniqueErrorHandler error_handler{};
+  {
+    std::lock_guard<std::mutex> lock{quality_update_mutex_};
+    timer_to_debounce_quality_->Cancel();
+    if (debounced_quality_pending_ == false) {
+      return;
+    }
+    debounced_quality_pending_ = false;
+    error_handler = std::move(debounced_quality_error_handler_);
+    debounced_quality_response_handler_.Reset();
+    debounced_quality_cancellation_token_ = CancellationToken{};
+  }
+  HandleConnectionError(Error::Connection::kShutDown, error_handler);
+}
+
+
+long NcStreamerRemote::Impl::GetCloseTimeoutMs() const {  // NOLINT
+  static const long kDefaultCloseTimeoutMs{1000};  // NOLINT
+  std::int64_t deadline_ns = close_deadline_ns_;
+  if (deadline_ns == 0) {
+    return kDefaultCloseTimeoutMs;
+  }
+  std::int64_t left_ms = (deadline_ns - StatsRecorder::NowNs()) / 1000000;
+  return left_ms > 1 ? static_cast<long>(left_ms) : 1;  // NOLINT
+}
+
+
+bool NcStreamerRemote::Impl::IsDrained() {
+  if (outstanding_tasks_ != 0 || port_prober_->IsIdle() == false) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock{remote_connection_mutex_};
+  return connecting_ == false && remote_connection_.expired() == true;
+}
+
+
+bool NcStreamerRemote::Impl::PollUntilDrained(std::int64_t deadline_ns) {
+  // the deadline is in steady time, as the close handshake is.
+  while (IsDrained() == false) {
+    if (StatsRecorder::NowNs() >= deadline_ns) {
+      return false;
+    }
+    if (io_pool_->Poll() == 0) {
+      std::this_thread::yield();  // e.g. for the socket to be closed.
+    }
+  }
+  return true;
+}
+
+
+bool NcStreamerRemote::Impl::ExistsNcStreamer() {
+  HWND wnd = ::FindWindow(nullptr, ncstreamer::kNcStreamerWindowTitle);
+  return (wnd != NULL);
+}
+
+
+void NcStreamerRemote::Impl::KeepConnected() {
+  if (stopping_ == true) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock{remote_connection_mutex_};
+    if (remote_connection_.lock() || connecting_ == true) {
+      return;
+    }
+    connecting_ = true;
+  }
+
+  Connect();
+}
+
+
+void NcStreamerRemote::Impl::Connect() {
+  if (IsOffline() == true) {
+    if (DropPendingRequest() == true) {
+      HandleError(Error::Connection::kNoNcStreamer);
+    }
+    return;
+  }
+
+  if (ExistsNcStreamer() == false) {
+    HandleConnectFailure(
+        Error::Connection::kNoNcStreamer,
+        websocketpp::lib::error_code{});
+    return;
+  }
+
+  if (discovered_port_ == 0) {
+    Discover();
+    return;
+  }
+
+  websocketpp::lib::error_code ec;
+  auto connection = remote_.get_connection(remote_uri_, ec);
+  if (ec) {
+    HandleConnectFailure(Error::Connection::kRemoteConnect, ec);
+    return;
+  }
+
+  remote_.connect(connection);
+}
+
+
+bool NcStreamerRemote::Impl::NeedsDiscovery() const {
+  return discovery_.candidate_ports.size() > 1 ||
+         discovery_.rendezvous_file.empty() == false;
+}
+
+
+bool NcStreamerRemote::Impl::IsOffline() const {
+  return discovery_.candidate_ports.empty() == true &&
+         discovery_.rendezvous_file.empty() == true;
+}
+
+
+void NcStreamerRemote::Impl::Discover() {
+  std::vector<std::uint16_t> ports{};
+  std::uint16_t rendezvous_port =
+      PortProber::ReadPortFile(discovery_.rendezvous_file);
+  if (rendezvous_port != 0) {
+    ports.emplace_back(rendezvous_port);
+  }
+  for (std::uint16_t port : discovery_.candidate_ports) {
+    if (port != 0 &&
+        std::find(ports.begin(), ports.end(), port) == ports.end()) {
+      ports.emplace_back(port);
+    }
+  }
+  StatsRecorder::Increase(&stats_->port_discoveries);
+
+  static const std::uint32_t kDefaultProbeTimeoutMs{1000};
+  std::uint32_t timeout_ms = (discovery_.probe_timeout_ms != 0) ?
+      discovery_.probe_timeout_ms : kDefaultProbeTimeoutMs;
+  timer_to_end_discovery_->ExpiresAfter(
+      static_cast<std::int64_t>(timeout_ms) * 1000000);
+  AsyncWait(timer_to_end_discovery_.get(), [this]() {
+    if (port_prober_->Cancel() == true) {
+      OnPortDiscovered(0);
+    }
+  });
+
+  port_prober_->Probe(ports, timeout_ms, [this](std::uint16_t port) {
+    OnPortDiscovered(port);
+  });
+}
+
+
+void NcStreamerRemote::Impl::OnPortDiscovered(std::uint16_t port) {
+  timer_to_end_discovery_->Cancel();
+
+  if (port == 0) {
+    StatsRecorder::Increase(&stats_->port_discovery_failures);
+    HandleConnectFailure(
+        Error::Connection::kNoNcStreamerPort,
+        websocketpp::lib::error_code{});
+    return;
+  }
+
+  discovered_port_ = port;
+  remote_uri_.reset(new websocketpp::uri{false, "localhost", port, ""});
+  Connect();
+}
+
+
+void NcStreamerRemote::Impl::WatchCancellation(
+    const CancellationToken &cancellation_token) {
+  if (cancellation_token.CanBeCancelled() == false) {
+    return;
+  }
+  if (cancellation_token.AddListener(cancellation_relay_) == false) {
+    // cancelled meanwhile, so the relay won't be told.
+    Post([this, cancellation_token]() {
+      CancelRequests(cancellation_token);
+    });
+  }
+}
+
+
+void NcStreamerRemote::Impl::CancelRequests(
+    const CancellationToken &cancellation_token) {
+  // runs on the io thread.
+  // the handlers are released at the end, out of the locks, as releasing
+  // them may complete a future, and so run its continuation.
+  std::vector<QueuedRequest> cancelled_requests{};
+  std::vector<StatusWaiter> cancelled_waiters{};
+  UniqueErrorHandler cancelled_error_handlers[2];
+  UniqueSuccessHandler cancelled_response_handlers[2];
+
+  std::size_t cancelled = request_queue_->RemoveCancelled(
+      cancellation_token, &cancelled_requests);
+  cancelled += request_throttle_->RemoveCancelled(
+      cancellation_token, &cancelled_requests);
+
+  {
+    std::lock_guard<std::mutex> lock{status_waiters_mutex_};
+    auto first_cancelled = std::stable_partition(
+        status_waiters_.begin(),
+        status_waiters_.end(),
+        [&cancellation_token](const StatusWaiter &waiter) {
+          return waiter.cancellation_token != cancellation_token;
+        });
+    cancelled += static_cast<std::size_t>(
+        std::distance(first_cancelled, status_waiters_.end()));
+    for (auto i = first_cancelled; i != status_waiters_.end(); ++i) {
+      cancelled_waiters.emplace_back(std::move(*i));
+    }
+    status_waiters_.erase(first_cancelled, status_waiters_.end());
+    // the status request itself goes on, to refresh the cached status.
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{quality_update_mutex_};
+    if (debounced_quality_pending_ == true &&
+        debounced_quality_cancellation_token_ == cancellation_token) {
+      debounced_quality_pending_ = false;  // the timer finds nothing to send.
+      debounced_quality_.clear();
+      cancelled_error_handlers[0] = std::move(debounced_quality_error_handler_);
+      cancelled_response_handlers[0] =
+          std::move(debounced_quality_response_handler_);
+      debounced_quality_cancellation_token_ = CancellationToken{};
+      ++cancelled;
+    }
+    if (debounced_quality_in_flight_ == true &&
+        quality_in_flight_cancellation_token_ == cancellation_token) {
+      cancelled_error_handlers[1] =
+          std::move(quality_in_flight_error_handler_);
+      cancelled_response_handlers[1] =
+          std::move(quality_in_flight_response_handler_);
+      quality_in_flight_cancellation_token_ = CancellationToken{};
+      ++cancelled;
+    }
+  }
+
+  if (busy_ == true &&
+      current_request_->cancellation_token == cancellation_token) {
+    CancelCurrentRequest();
+    ++cancelled;
+  }
+
+  StatsRecorder::Add(&stats_->requests_cancelled, cancelled);
+}
+
+
+void NcStreamerRemote::Impl::CancelCurrentRequest() {
+  bool sent{true};
+  {
+    std::lock_guard<std::mutex> lock{remote_connection_mutex_};
+    if (request_pending_ == true) {
+      request_pending_ = false;  // still waits for the connection.
+      sent = false;
+    }
+  }
+
+  if (sent == true) {
+    MessageType request_type = current_request_->type;
+    if (request_type == MessageType::kBatchRequest &&
+        batch_sequential_ == true) {
+      const std::vector<BatchItem> &items = current_request_->batch_items;
+      request_type = batch_cursor_ < items.size() ?
+          RequestPayloadCache::ToRequestType(items[batch_cursor_].type) :
+          MessageType::kUndefined;
+    }
+    MessageType response_type = ToResponseType(request_type);
+    if (response_type != MessageType::kUndefined) {
+      cancelled_responses_.emplace_back(response_type);
+    }
+  }
+
+  CompleteRequest();
+}
+
+
+bool NcStreamerRemote::Impl::DropCancelledResponse(MessageType msg_type) {
+  if (cancelled_responses_.empty() == true) {
+    return false;
+  }
+  // NCStreamer responds in order, so the first of the type is the one.
+  auto i = std::find(
+      cancelled_responses_.begin(), cancelled_responses_.end(), msg_type);
+  if (i == cancelled_responses_.end()) {
+    return false;
+  }
+  cancelled_responses_.erase(i);
+  StatsRecorder::Increase(&stats_->cancelled_responses_dropped);
+  return true;
+}
+
+
+bool NcStreamerRemote::Impl::IsIoThread() const {
+  return io_pool_->RunsInThisThread();
+}
+
+
+void NcStreamerRemote::Impl::Enqueue(QueuedRequest *request) {
+  if (closing_ == true) {
+    HandleConnectionError(Error::Connection::kShutDown, request->error_handler);
+    return;
+  }
+  if (request->cancellation_token.IsCancelled() == true) {
+    StatsRecorder::Increase(&stats_->requests_cancelled);
+    return;  // its handlers are released with it.
+  }
+
+  const CancellationToken cancellation_token{request->cancellation_token};
+  UniqueErrorHandler superseded{};
+  std::int64_t now_ns = clock_->NowNs();
+  std::int64_t release_at_ns{0};
+  switch (request_throttle_->Admit(
+      now_ns, request, &superseded, &release_at_ns)) {
+    case RequestThrottle::Verdict::kReject: {
+      StatsRecorder::Increase(&stats_->requests_throttle_rejected);
+      HandleConnectionError(
+          Error::Connection::kRateLimited, request->error_handler);
+      return;
+    }
+    case RequestThrottle::Verdict::kHold: {
+      std::int64_t delay_ns = release_at_ns - now_ns;
+      StatsRecorder::Increase(&stats_->requests_throttle_delayed);
+      if (delay_ns > 0) {
+        StatsRecorder::Add(
+            &stats_->throttle_delay_us_total,
+            static_cast<std::uint64_t>(delay_ns / 1000));
+      }
+      WatchCancellation(cancellation_token);
+      Post([this]() {
+        ArmThrottleTimer();
+      });
+      return;
+    }
+    case RequestThrottle::Verdict::kMerge: {
+      StatsRecorder::Increase(&stats_->requests_throttle_merged);
+      if (superseded) {
+        StatsRecorder::Increase(&stats_->quality_updates_superseded);
+        HandleConnectionError(Error::Connection::kSuperseded, superseded);
+      }
+      return;  // merged only with a request of the same token.
+    }
+    default: {
+      break;
+    }
+  }
+
+  PushRequest(request);
+}
+
+
+void NcStreamerRemote::Impl::PushRequest(QueuedRequest *request) {
+  const CancellationToken cancellation_token{request->cancellation_token};
+  QueuedRequest dropped{};
+  bool has_dropped{false};
+  Error::Connection err_code = request_queue_->Push(
+      request, &dropped, &has_dropped, IsIoThread() == false);
+
+  if (has_dropped == true) {
+    StatsRecorder::Increase(&stats_->requests_dropped);
+    HandleConnectionError(Error::Connection::kDropped, dropped.error_handler);
+  }
+  if (err_code != Error::Connection::kNoError) {
+    if (err_code == Error::Connection::kQueueFull) {
+      StatsRecorder::Increase(&stats_->requests_rejected);
+    }
+    HandleConnectionError(err_code, request->error_handler);
+    return;
+  }
+
+  StatsRecorder::Increase(&stats_->requests_queued);
+  StatsRecorder::Maximize(&stats_->queue_depth_max, request_queue_->size());
+  WatchCancellation(cancellation_token);
+
+  Post([this]() {
+    DispatchNextRequest();
+  });
+}
+
+
+void NcStreamerRemote::Impl::ArmThrottleTimer() {
+  // runs on the io thread.
+  if (stopping_ == true) {
+    return;
+  }
+  std::int64_t release_at_ns = request_throttle_->GetNextReleaseNs();
+  if (release_at_ns == 0) {
+    return;
+  }
+  timer_to_release_throttled_->ExpiresAfter(release_at_ns - clock_->NowNs());
+  AsyncWait(timer_to_release_throttled_.get(), [this]() {
+    ReleaseThrottledRequests();
+  });
+}
+
+
+void NcStreamerRemote::Impl::ReleaseThrottledRequests() {
+  // runs on the io thread.
+  QueuedRequest request{};
+  std::int64_t now_ns = clock_->NowNs();
+  while (request_throttle_->PopDue(now_ns, &request) == true) {
+    if (request.cancellation_token.IsCancelled() == true) {
+      request = QueuedRequest{};
+      StatsRecorder::Increase(&stats_->requests_cancelled);
+      continue;
+    }
+    PushRequest(&request);
+  }
+  ArmThrottleTimer();
+}
+
+
+void NcStreamerRemote::Impl::DispatchNextRequest() {
+  // runs on the io thread.
+  if (stopping_ == true) {
+    return;  // the queued requests are discarded with this instance.
+  }
+  if (busy_ == true) {
+    return;  // CompleteRequest will dispatch the next one.
+  }
+  if (request_queue_->Pop(current_request_.get()) == false) {
+    return;
+  }
+  if (current_request_->cancellation_token.IsCancelled() == true) {
+    *current_request_ = QueuedRequest{};  // never hits the wire.
+    StatsRecorder::Increase(&stats_->requests_cancelled);
+    Post([this]() {
+      DispatchNextRequest();
+    });
+    return;
+  }
+  busy_ = true;
+
+  std::int64_t wait_us =
+      RequestQueue::NowUs() - current_request_->enqueued_at_us;
+  std::uint64_t wait = wait_us > 0 ? static_cast<std::uint64_t>(wait_us) : 0;
+  StatsRecorder::Increase(&stats_->requests_dispatched);
+  StatsRecorder::Add(&stats_->queue_wait_us_total, wait);
+  StatsRecorder::Maximize(&stats_->queue_wait_us_max, wait);
+
+  SubmitCurrentRequest();
+}
+
+
+void NcStreamerRemote::Impl::SubmitCurrentRequest() {
+  bool connected{true};
+  bool connect_needed{false};
+  {
+    std::lock_guard<std::mutex> lock{remote_connection_mutex_};
+    if (!remote_connection_.lock()) {
+      connected = false;
+      request_pending_ = true;
+      connect_needed = (connecting_ == false);
+      connecting_ = true;
+    }
+  }
+
+  if (connected == true) {
+    SendCurrentRequest();
+    return;
+  }
+
+  if (connect_needed == true) {
+    Connect();
+  }
+  // otherwise, sent by OnRemoteOpen.
+}
+
+
+void NcStreamerRemote::Impl::SendCurrentRequest() {
+  switch (current_request_->type) {
+    case MessageType::kStreamingStatusRequest: {
+      SendStatusRequest();
+      break;
+    }
+    case MessageType::kStreamingStartRequest: {
+      SendStartRequest(current_request_->param);
+      break;
+    }
+    case MessageType::kStreamingStopRequest: {
+      SendStopRequest(current_request_->param);
+      break;
+    }
+    case MessageType::kSettingsQualityUpdateRequest: {
+      SendQualityUpdateRequest(current_request_->param);
+      break;
+    }
+    case MessageType::kNcStreamerExitRequest: {
+      if (SendExitRequest() == true) {
+        CompleteRequest();  // NCStreamer doesn't respond to this.
+      }
+      break;
+    }
+    case MessageType::kBatchRequest: {
+      SendBatchRequest();
+      break;
+    }
+    default: {
+      assert(false);
+      CompleteRequest();
+      break;
+    }
+  }
+}
+
+
+void NcStreamerRemote::Impl::CompleteRequest() {
+  if (current_request_->type == MessageType::kBatchRequest) {
+    timer_to_fall_back_batch_->Cancel();
+    current_request_->batch_items.clear();
+    current_request_->batch_response_handler.Reset();
+  }
+  current_request_->error_handler.Reset();
+  current_request_->response_handler.Reset();
+  current_request_->cancellation_token = CancellationToken{};
+  busy_ = false;
+
+  if (closing_ == true && stopping_ == false &&
+      request_queue_->size() == 0) {
+    Stop();  // the urgent requests are flushed.
+    return;
+  }
+
+  Post([this]() {
+    DispatchNextRequest();
+  });
+}
+
+
+bool NcStreamerRemote::Impl::SendStatusRequest() {
+  return SendPayload(request_payload_cache_->GetStatusRequest());
+}
+
+
+bool NcStreamerRemote::Impl::SendStartRequest(const std::wstring &title) {
+  return SendPayload(request_payload_cache_->GetStartRequest(title));
+}
+
+
+bool NcStreamerRemote::Impl::SendStopRequest(const std::wstring &title) {
+  return SendPayload(request_payload_cache_->GetStopRequest(title));
+}
+
+
+bool NcStreamerRemote::Impl::SendQualityUpdateRequest(
+    const std::wstring &quality) {
+  return SendPayload(request_payload_cache_->Encode(
+      ncstreamer::RemoteMessage::MessageType::kSettingsQualityUpdateRequest,
+      "quality",
+      quality));
+}
+
+
+bool NcStreamerRemote::Impl::SendExitRequest() {
+  return SendPayload(request_payload_cache_->GetExitRequest());
+}
+
+
+void NcStreamerRemote::Impl::SendBatchRequest() {
+  const std::vector<BatchItem> &items = current_request_->batch_items;
+
+  // exit requests are done once sent, as NCStreamer doesn't respond to them.
+  batch_results_.assign(
+      items.size(), BatchResult{ErrorCategory::kNoCategory, 0, {}});
+  batch_cursor_ = 0;
+
+  if (batch_support_ == BatchSupport::kUnsupported || items.size() == 1) {
+    batch_sequential_ = true;
+    SendNextBatchItem();
+    return;
+  }
+
+  batch_sequential_ = false;
+  if (SendPayload(request_payload_cache_->EncodeBatch(items)) == false) {
+    return;
+  }
+
+  bool response_expected{false};
+  for (const auto &item : items) {
+    if (item.type != BatchItem::Type::kExit) {
+      response_expected = true;
+      break;
+    }
+  }
+  if (response_expected == false) {
+    FinishBatch();
+    return;
+  }
+
+  if (batch_support_ == BatchSupport::kSupported) {
+    return;
+  }
+
+  static const std::int64_t kBatchResponseTimeoutNs{1000000000};
+  timer_to_fall_back_batch_->ExpiresAfter(kBatchResponseTimeoutNs);
+  AsyncWait(timer_to_fall_back_batch_.get(), [this]() {
+    FallBackFromBatch();
+  });
+}
+
+
+void NcStreamerRemote::Impl::SendNextBatchItem() {
+  const std::vector<BatchItem> &items = current_request_->batch_items;
+  while (batch_cursor_ < items.size()) {
+    const BatchItem &item = items[batch_cursor_];
+    switch (item.type) {
+      case BatchItem::Type::kQualityUpdate: {
+        SendQualityUpdateRequest(item.param);
+        return;
+      }
+      case BatchItem::Type::kStart: {
+        SendStartRequest(item.param);
+        return;
+      }
+      case BatchItem::Type::kStop: {
+        SendStopRequest(item.param);
+        return;
+      }
+      case BatchItem::Type::kExit: {
+        if (SendExitRequest() == false) {
+          return;
+        }
+        ++batch_cursor_;
+        break;
+      }
+      default: {
+        assert(false);
+        ++batch_cursor_;
+        break;
+      }
+    }
+  }
+
+  FinishBatch();
+}
+
+
+void NcStreamerRemote::Impl::FallBackFromBatch() {
+  if (IsInFlight(busy_, *current_request_,
+                 MessageType::kBatchRequest) == false ||
+      batch_sequential_ == true ||
+      batch_support_ == BatchSupport::kSupported) {
+    return;  // a slow answer is still to come, if supported.
+  }
+
+  LogWarning("no batch response: sending the items one by one");
+  StatsRecorder::Increase(&stats_->batch_fallbacks);
+  batch_support_ = BatchSupport::kUnsupported;
+  batch_sequential_ = true;
+  batch_cursor_ = 0;
+  SendNextBatchItem();
+}
+
+
+void NcStreamerRemote::Impl::FinishBatch() {
+  std::vector<BatchResult> results{};
+  results.swap(batch_results_);
+  if (current_request_->batch_response_handler) {
+    callback_watchdog_->Run(CallbackKind::kResponse, [this, &results]() {
+      current_request_->batch_response_handler(results);
+    });
+  }
+  CompleteRequest();
+}
+
+
+void NcStreamerRemote::Impl::SendHandshake() {
+  std::string capabilities{ncstreamer::RemoteMessage::Capability::kBatch};
+  capabilities += ',';
+  capabilities += ncstreamer::RemoteMessage::Capability::kResume;
+  if (binary_encoding_enabled_ == true) {
+    capabilities += ',';
+    capabilities += ncstreamer::RemoteMessage::Capability::kMsgpack;
+  }
+
+  // always JSON, as NCStreamer may not know the handshake.
+  std::stringstream msg;
+  {
+    boost::property_tree::ptree tree;
+    tree.put("type", static_cast<int>(
+        ncstreamer::RemoteMessage::MessageType::kRemoteHandshakeRequest));
+    tree.put("version", ncstreamer::kRemoteProtocolVersion);
+    tree.put("capabilities", capabilities);
+    if (last_event_seq_ != 0) {
+      tree.put("epoch", event_epoch_);
+      tree.put("lastSeq", last_event_seq_);
+    }
+    boost::property_tree::write_json(msg, tree, false);
+  }
+  const std::string &payload = msg.str();
+
+  websocketpp::lib::error_code ec;
+  remote_.send(
+      remote_connection_, payload, websocketpp::frame::opcode::text, ec);
+  if (ec) {
+    LogWarning("handshake not sent: " + ec.message());
+    return;
+  }
+  StatsRecorder::Increase(&stats_->messages_sent);
+  StatsRecorder::Add(&stats_->bytes_sent, payload.size());
+  traffic_capture_->Write(TrafficRecord::Kind::kOutboundText, payload);
+}
+
+
+bool NcStreamerRemote::Impl::SendPayload(const std::string &payload) {
+  bool binary = (request_payload_cache_->encoding() ==
+                 RequestPayloadCache::Encoding::kMsgpack);
+
+  websocketpp::lib::error_code ec;
+  remote_.send(
+      remote_connection_,
+      payload,
+      binary ? websocketpp::frame::opcode::binary :
+               websocketpp::frame::opcode::text,
+      ec);
+  if (ec) {
+    HandleError(Error::Connection::kRemoteSend, ec);
+    return false;
+  }
+
+  StatsRecorder::Increase(&stats_->messages_sent);
+  if (binary == true) {
+    StatsRecorder::Increase(&stats_->binary_messages_sent);
+  }
+  StatsRecorder::Add(&stats_->bytes_sent, payload.size());
+  traffic_capture_->Write(
+      binary ? TrafficRecord::Kind::kOutboundBinary :
+               TrafficRecord::Kind::kOutboundText,
+      payload);
+  return true;
+}
+
+
+void NcStreamerRemote::Impl::StartQualityUpdate(
+    std::wstring &&quality,
+    UniqueErrorHandler &&error_handler,
+    UniqueSuccessHandler &&quality_update_response_handler,
+    const CancellationToken &cancellation_token) {
+  StatsRecorder::Increase(&stats_->quality_updates_sent);
+
+  QueuedRequest request{};
+  request.type = MessageType::kSettingsQualityUpdateRequest;
+  request.param = std::move(quality);
+  request.error_handler = std::move(error_handler);
+  request.response_handler = std::move(quality_update_response_handler);
+  request.cancellation_token = cancellation_token;
+  Enqueue(&request);
+}
+
+
+void NcStreamerRemote::Impl::DebounceQualityUpdate(
+    std::wstring &&quality,
+    UniqueErrorHandler &&error_handler,
+    UniqueSuccessHandler &&quality_update_response_handler,
+    const CancellationToken &cancellation_token) {
+  if (cancellation_token.IsCancelled() == true) {
+    StatsRecorder::Increase(&stats_->requests_cancelled);
+    return;
+  }
+
+  UniqueErrorHandler superseded{};
+  bool superseded_pending{false};
+  {
+    std::lock_guard<std::mutex> lock{quality_update_mutex_};
+    superseded_pending = debounced_quality_pending_;
+    superseded = std::move(debounced_quality_error_handler_);
+
+    debounced_quality_ = std::move(quality);
+    debounced_quality_error_handler_ = std::move(error_handler);
+    debounced_quality_response_handler_ =
+        std::move(quality_update_response_handler);
+    debounced_quality_cancellation_token_ = cancellation_token;
+    debounced_quality_pending_ = true;
+
+    if (superseded_pending == false &&
+        debounced_quality_in_flight_ == false) {
+      ArmQualityUpdateTimer();
+    }
+    // otherwise, the timer is already armed,
+    // or FinishQualityUpdate will arm it.
+  }
+
+  if (superseded_pending == true) {
+    StatsRecorder::Increase(&stats_->quality_updates_superseded);
+    HandleConnectionError(Error::Connection::kSuperseded, superseded);
+  }
+  WatchCancellation(cancellation_token);
+}
+
+
+void NcStreamerRemote::Impl::ArmQualityUpdateTimer() {
+  // quality_update_mutex_ is locked by the caller.
+  timer_to_debounce_quality_->ExpiresAfter(static_cast<std::int64_t>(
+      quality_update_debounce_window_ms_.load()) * 1000000);
+  AsyncWait(timer_to_debounce_quality_.get(), [this]() {
+    FlushQualityUpdate();
+  });
+}
+
+
+void NcStreamerRemote::Impl::FlushQualityUpdate() {
+  std::wstring quality{};
+  {
+    std::lock_guard<std::mutex> lock{quality_update_mutex_};
+    if (debounced_quality_pending_ == false ||
+        debounced_quality_in_flight_ == true) {
+      return;
+    }
+
+    quality = std::move(debounced_quality_);
+    quality_in_flight_response_handler_ =
+        std::move(debounced_quality_response_handler_);
+    quality_in_flight_error_handler_ =
+        std::move(debounced_quality_error_handler_);
+    quality_in_flight_cancellation_token_ =
+        std::move(debounced_quality_cancellation_token_);
+    debounced_quality_cancellation_token_ = CancellationToken{};
+    debounced_quality_pending_ = false;
+    debounced_quality_in_flight_ = true;
+  }
+
+  StartQualityUpdate(
+      std::move(quality),
+      UniqueErrorHandler{[this](
+          ErrorCategory category,
+          int err_code,
+          const std::wstring &err_msg) {
+        FinishQualityUpdate(category, err_code, err_msg);
+      }},
+      UniqueSuccessHandler{[this](bool /*success*/) {
+        FinishQualityUpdate(ErrorCategory::kNoCategory, 0, std::wstring{});
+      }},
+      CancellationToken{});
+}
+
+
+void NcStreamerRemote::Impl::FinishQualityUpdate(
+    ErrorCategory category,
+    int err_code,
+    const std::wstring &err_msg) {
+  UniqueErrorHandler error_handler{};
+  UniqueSuccessHandler quality_update_response_handler{};
+  {
+    std::lock_guard<std::mutex> lock{quality_update_mutex_};
+    if (debounced_quality_in_flight_ == false) {
+      return;
+    }
+    debounced_quality_in_flight_ = false;
+    error_handler = std::move(quality_in_flight_error_handler_);
+    quality_update_response_handler =
+        std::move(quality_in_flight_response_handler_);
+    quality_in_flight_cancellation_token_ = CancellationToken{};
+    if (debounced_quality_pending_ == true) {
+      ArmQualityUpdateTimer();
+    }
+  }
+
+  if (category == ErrorCategory::kNoCategory) {
+    if (quality_update_response_handler) {
+      callback_watchdog_->Run(CallbackKind::kResponse, [&]() {
+        quality_update_response_handler(true);
+      });
+    }
+  } else if (error_handler) {
+    callback_watchdog_->Run(CallbackKind::kError, [&]() {
+      error_handler(category, err_code, err_msg);
+    });
+  }
+}
+
+
+void NcStreamerRemote::Impl::RefreshStatus() {
+  StartStatusRequest(
+      UniqueErrorHandler{}, UniqueStatusResponseHandler{}, CancellationToken{});
+}
+
+
+void NcStreamerRemote::Impl::StartStatusRequest(
+    UniqueErrorHandler &&error_handler,
+    UniqueStatusResponseHandler &&status_response_handler,
+    const CancellationToken &cancellation_token) {
+  if (closing_ == true) {
+    HandleConnectionError(Error::Connection::kShutDown, error_handler);
+    return;
+  }
+  if (cancellation_token.IsCancelled() == true) {
+    StatsRecorder::Increase(&stats_->requests_cancelled);
+    return;
+  }
+  WatchCancellation(cancellation_token);
+
+  bool in_flight{false};
+  {
+    std::lock_guard<std::mutex> lock{status_waiters_mutex_};
+    in_flight = status_in_flight_;
+    status_in_flight_ = true;
+    status_waiters_.emplace_back(
+        std::move(error_handler),
+        std::move(status_response_handler),
+        cancellation_token);
+  }
+
+  if (in_flight == true) {
+    StatsRecorder::Increase(&stats_->status_requests_coalesced);
+    return;
+  }
+
+  StatsRecorder::Increase(&stats_->status_requests_sent);
+
+  std::uint32_t window_ms = status_coalescing_window_ms_;
+  if (window_ms == 0) {
+    EnqueueStatusRequest();
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock{status_waiters_mutex_};
+  timer_to_coalesce_status_->ExpiresAfter(
+      static_cast<std::int64_t>(window_ms) * 1000000);
+  AsyncWait(timer_to_coalesce_status_.get(), [this]() {
+    EnqueueStatusRequest();
+  });
+}
+
+
+void NcStreamerRemote::Impl::EnqueueStatusRequest() {
+  QueuedRequest request{};
+  request.type = MessageType::kStreamingStatusRequest;
+  request.error_handler = UniqueErrorHandler{[this](
+      ErrorCategory category,
+      int err_code,
+      const std::wstring &err_msg) {
+    FailStatusWaiters(category, err_code, err_msg);
+  }};
+  Enqueue(&request);
+}
+
+
+void NcStreamerRemote::Impl::FailStatusWaiters(
+    ErrorCategory category,
+    int err_code,
+    const std::wstring &err_msg) {
+  // the shared request goes with the waiters it is for, or it would be
+  // sent besides the one which the next RequestStatus queues.
+  QueuedRequest withdrawn{};
+  if (request_queue_->RemoveFirst(
+          MessageType::kStreamingStatusRequest, &withdrawn) == false) {
+    request_throttle_->RemoveFirst(
+        MessageType::kStreamingStatusRequest, &withdrawn);
+  }
+
+  std::vector<StatusWaiter> waiters = TakeStatusWaiters();
+  for (const auto &waiter : waiters) {
+    if (waiter.error_handler) {
+      callback_watchdog_->Run(CallbackKind::kError, [&]() {
+        waiter.error_handler(category, err_code, err_msg);
+      });
+    }
+  }
+  RecycleStatusWaiters(&waiters);
+}
+
+
+std::vector<NcStreamerRemote::Impl::StatusWaiter>
+    NcStreamerRemote::Impl::TakeStatusWaiters() {
+  std::vector<StatusWaiter> waiters{};
+  std::lock_guard<std::mutex> lock{status_waiters_mutex_};
+  status_in_flight_ = false;
+  waiters.swap(status_waiters_);
+  return waiters;
+}
+
+
+void NcStreamerRemote::Impl::RecycleStatusWaiters(
+    std::vector<StatusWaiter> *waiters) {
+  waiters->clear();
+
+  // gives the reserved capacity back, not to allocate on the next request.
+  std::lock_guard<std::mutex> lock{status_waiters_mutex_};
+  if (status_waiters_.empty() == true &&
+      status_waiters_.capacity() < waiters->capacity()) {
+    status_waiters_.swap(*waiters);
+  }
+}
+
+
+void NcStreamerRemote::Impl::OnRemoteOpen(
+    websocketpp::connection_hdl connection) {
+  traffic_capture_->Write(TrafficRecord::Kind::kOpen, std::string{});
+  bool request_pending{false};
+  {
+    std::lock_guard<std::mutex> lock{remote_connection_mutex_};
+    remote_connection_ = connection;
+    connecting_ = false;
+    request_pending = request_pending_;
+    request_pending_ = false;
+  }
+  if (stopping_ == true) {
+    websocketpp::lib::error_code ec;
+    remote_.close(connection, websocketpp::close::status::going_away, "", ec);
+    return;
+  }
+  // responses on the closed connection never come.
+  cancelled_responses_.clear();
+
+  // may be another NCStreamer, so starts over with JSON.
+  batch_support_ = BatchSupport::kUnknown;
+  request_payload_cache_->SetEncoding(RequestPayloadCache::Encoding::kJson);
+  SendHandshake();
+
+  if (connect_handler_) {
+    callback_watchdog_->RunEvent(CallbackKind::kConnect, connect_handler_);
+  }
+
+  if (request_pending == true) {
+    SendCurrentRequest();
+  }
+
+  if (last_event_seq_ != 0) {
+    // waits for the handshake response to tell if the events are replayed.
+    static const std::int64_t kResumeTimeoutNs{1000000000};
+    resuming_ = true;
+    timer_to_resume_->ExpiresAfter(kResumeTimeoutNs);
+    AsyncWait(timer_to_resume_.get(), [this]() {
+      FinishResume(false);
+    });
+  } else {
+    RefreshStatus();  // shared with a status request waiting, if any.
+  }
+}
+
+
+void NcStreamerRemote::Impl::OnRemoteFail(
+    websocketpp::connection_hdl connection) {
+  traffic_capture_->Write(TrafficRecord::Kind::kFail, std::string{});
+  if (NeedsDiscovery() == true) {
+    discovered_port_ = 0;  // NCStreamer may have moved; discovers it again.
+  }
+  if (DropPendingRequest() == true) {
+    HandleError(Error::Connection::kOnRemoteFail);
+  }
+  HandleDisconnect(Error::Connection::kOnRemoteFail);
+}
+
+
+void NcStreamerRemote::Impl::OnRemoteClose(
+    websocketpp::connection_hdl connection) {
+  traffic_capture_->Write(TrafficRecord::Kind::kClose, std::string{});
+  HandleDisconnect(Error::Connection::kOnRemoteClose);
+}
+
+
+void NcStreamerRemote::Impl::OnRemoteMessage(
+    websocketpp::connection_hdl connection,
+    websocketpp::connection<AsioClient>::message_ptr msg) {
+  const std::string &payload = msg->get_payload();
+  bool binary = (msg->get_opcode() == websocketpp::frame::opcode::binary);
+  traffic_capture_->Write(
+      binary ? TrafficRecord::Kind::kInboundBinary :
+               TrafficRecord::Kind::kInboundText,
+      payload);
+  OnRemotePayload(payload, binary);
+}
+
+
+void NcStreamerRemote::Impl::OnRemotePayload(
+    const std::string &payload,
+    bool binary) {
+  boost::property_tree::ptree response;
+  ncstreamer::RemoteMessage::MessageType msg_type{
+      ncstreamer::RemoteMessage::MessageType::kUndefined};
+
+  StatsRecorder::Increase(&stats_->messages_received);
+  if (binary == true) {
+    StatsRecorder::Increase(&stats_->binary_messages_received);
+  }
+  StatsRecorder::Add(&stats_->bytes_received, payload.size());
+
+  std::int64_t decode_begin_ns = StatsRecorder::NowNs();
+  try {
+    if (binary == true) {
+      if (MsgpackCodec::Decode(payload, &response) == false) {
+        throw std::runtime_error{"broken msgpack"};
+      }
+    } else {
+      std::stringstream ss{payload};
+      boost::property_tree::read_json(ss, response);
+    }
+
+    if (response.empty() == false && response.front().first.empty()) {
+      msg_type = ncstreamer::RemoteMessage::MessageType::kBatchResponse;
+    } else {
+      msg_type = static_cast<ncstreamer::RemoteMessage::MessageType>(
+          response.get<int>("type"));
+    }
+  } catch (const std::exception &/*e*/) {
+    msg_type = ncstreamer::RemoteMessage::MessageType::kUndefined;
+  }
+  StatsRecorder::AddElapsedNs(&stats_->decode_ns_total, decode_begin_ns);
+
+  if (DropCancelledResponse(msg_type) == true) {
+    return;  // its request is cancelled.
+  }
+
+  switch (msg_type) {
+    case MessageType::kStreamingStartEvent:
+      OnRemoteStartEvent(response);
+      break;
+    case MessageType::kStreamingStopEvent:
+      OnRemoteStopEvent(response);
+      break;
+    case MessageType::kStreamingStatusResponse:
+      OnRemoteStatusResponse(response);
+      break;
+    case MessageType::kStreamingStartResponse:
+      OnRemoteStartResponse(response);
+      break;
+    case MessageType::kStreamingStopResponse:
+      OnRemoteStopResponse(response);
+      break;
+    case MessageType::kSettingsQualityUpdateResponse:
+      OnRemoteQualityUpdateResponse(response);
+      break;
+    case MessageType::kBatchResponse:
+      OnRemoteBatchResponse(response);
+      break;
+    case MessageType::kRemoteHandshakeResponse:
+      OnRemoteHandshakeResponse(response);
+      break;
+    default:
+      LogWarning("unknown message type: " +
+                 std::to_string(static_cast<int>(msg_type)));
+      break;
+  }
+}
+
+
+void NcStreamerRemote::Impl::ReplayRecord(const TrafficRecord &record) {
+  switch (record.kind) {
+    case TrafficRecord::Kind::kInboundText:
+      OnRemotePayload(record.payload, false);
+      break;
+    case TrafficRecord::Kind::kInboundBinary:
+      OnRemotePayload(record.payload, true);
+      break;
+    case TrafficRecord::Kind::kOpen:
+      if (connect_handler_) {
+        callback_watchdog_->RunEvent(CallbackKind::kConnect, connect_handler_);
+      }
+      break;
+    case TrafficRecord::Kind::kFail:
+    case TrafficRecord::Kind::kClose:
+      if (disconnect_handler_) {
+        callback_watchdog_->RunEvent(
+            CallbackKind::kDisconnect, disconnect_handler_);
+      }
+      break;
+    default:
+      break;  // sent frames are only recorded.
+  }
+}
+
+
+bool NcStreamerRemote::Impl::AcceptEvent(
+    const boost::property_tree::ptree &evt) {
+  auto seq = evt.get_optional<std::uint64_t>("seq");
+  if (!seq) {
+    StatsRecorder::Increase(&stats_->events_received);
+    return true;  // from NCStreamer without resume.
+  }
+
+  if (event_epoch_confirmed_ == true && *seq <= last_event_seq_) {
+    StatsRecorder::Increase(&stats_->events_duplicated);
+    return false;
+  }
+
+  last_event_seq_ = *seq;
+  StatsRecorder::Increase(&stats_->events_received);
+  return true;
+}
+
+
+void NcStreamerRemote::Impl::FinishResume(bool resumed) {
+  if (resuming_ == false) {
+    return;
+  }
+  resuming_ = false;
+  timer_to_resume_->Cancel();
+
+  if (resumed == true) {
+    streamer_status_cache_->RestoreLastKnown();
+    if (streamer_status_cache_->Get()->status.empty() == false) {
+      StatsRecorder::Increase(&stats_->resumes);
+      return;
+    }
+  }
+
+  StatsRecorder::Increase(&stats_->resyncs);
+  RefreshStatus();
+}
+
+
+void NcStreamerRemote::Impl::OnRemoteStartEvent(
+    const boost::property_tree::ptree &evt) {
+  if (AcceptEvent(evt) == false) {
+    return;
+  }
+
+  std::string source{};
+  std::string user_page{};
+  std::string privacy{};
+  std::string description{};
+  std::string mic{};
+  std::string service_provider{};
+  std::string stream_url{};
+  std::string post_url{};
+  try {
+    source = evt.get<std::string>("source");
+    user_page = evt.get<std::string>("userPage");
+    privacy = evt.get<std::string>("privacy");
+    description = evt.get<std::string>("description");
+    mic = evt.get<std::string>("mic");
+    service_provider = evt.get<std::string>("serviceProvider");
+    stream_url = evt.get<std::string>("streamUrl");
+    post_url = evt.get<std::string>("postUrl");
+  } catch (const std::exception &/*e*/) {
+    source.clear();
+    user_page.clear();
+    privacy.clear();
+    description.clear();
+    mic.clear();
+    service_provider.clear();
+    stream_url.clear();
+    post_url.clear();
+  }
+
+  if (source.empty() == true) {
+    LogError("source.empty()");
+    return;
+  }
+
+  std::vector<std::string> tokens{};
+  boost::split(tokens, source, boost::is_any_of(":"));
+  const std::string &source_title = tokens.at(0);
+
+  std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+  const std::wstring &w_source_title = converter.from_bytes(source_title);
+  const std::wstring &w_stream_url = converter.from_bytes(stream_url);
+  const std::wstring &w_post_url = converter.from_bytes(post_url);
+
+  streamer_status_cache_->OnStartEvent(
+      w_source_title, w_stream_url, w_post_url);
+
+  if (start_event_handler_) {
+    callback_watchdog_->RunEvent(CallbackKind::kStartEvent, std::bind(
+        start_event_handler_,
+        w_source_title,
+        converter.from_bytes(user_page),
+        converter.from_bytes(privacy),
+        converter.from_bytes(description),
+        converter.from_bytes(mic),
+        converter.from_bytes(service_provider),
+        w_stream_url,
+        w_post_url));
+  }
+
+  if (utf8_start_event_handler_) {
+    callback_watchdog_->RunEvent(CallbackKind::kStartEvent, std::bind(
+        &CallUtf8StartEventHandler,
+        utf8_start_event_handler_,
+        std::move(tokens.at(0)),
+        std::move(user_page),
+        std::move(privacy),
+        std::move(description),
+        std::move(mic),
+        std::move(service_provider),
+        std::move(stream_url),
+        std::move(post_url)));
+  }
+}
+
+
+void NcStreamerRemote::Impl::OnRemoteStopEvent(
+    const boost::property_tree::ptree &evt) {
+  if (AcceptEvent(evt) == false) {
+    return;
+  }
+
+  std::string source{};
+  try {
+    source = evt.get<std::string>("source");
+  } catch (const std::exception &/*e*/) {
+    source.clear();
+  }
+
+  if (source.empty() == true) {
+    LogError("source.empty()");
+    return;
+  }
+
+  std::vector<std::string> tokens{};
+  boost::algorithm::split(tokens, source, boost::is_any_of(":"));
+  const std::string &source_title = tokens.at(0);
+
+  std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+  const std::wstring &w_source_title = converter.from_bytes(source_title);
+
+  streamer_status_cache_->OnStopEvent(w_source_title);
+
+  if (stop_event_handler_) {
+    callback_watchdog_->RunEvent(CallbackKind::kStopEvent, std::bind(
+        stop_event_handler_,
+        w_source_title));
+  }
+
+  if (utf8_stop_event_handler_) {
+    callback_watchdog_->RunEvent(CallbackKind::kStopEvent, std::bind(
+        &CallUtf8StopEventHandler,
+        utf8_stop_event_handler_,
+        std::move(tokens.at(0))));
+  }
+}
+
+
+void NcStreamerRemote::Impl::OnRemoteStatusResponse(
+    const boost::property_tree::ptree &response) {
+  std::string status{};
+  std::string source_title{};
+  std::string user_name{};
+  std::string quality{};
+  try {
+    status = response.get<std::string>("status");
+    source_title = response.get<std::string>("sourceTitle");
+    user_name = response.get<std::string>("userName");
+    quality = response.get<std::string>("quality");
+  } catch (const std::exception &/*e*/) {
+    status.clear();
+    source_title.clear();
+  }
+
+  if (status.empty() == true || quality.empty() == true) {
+    LogError(status.empty() == true ? "status.empty()" : "quality.empty()");
+    // the waiters would wait for good otherwise, and the later
+    // status requests with them.
+    FailStatusWaiters(
+        ErrorCategory::kConnection,
+        static_cast<int>(Error::Connection::kBadResponse),
+        ErrorConverter::ToConnectionError(
+            Error::Connection::kBadResponse).wide);
+    if (IsInFlight(
+            busy_, *current_request_, MessageType::kStreamingStatusRequest)) {
+      CompleteRequest();
+    }
+    return;
+  }
+
+  std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+  const std::wstring &w_status = converter.from_bytes(status);
+  const std::wstring &w_source_title = converter.from_bytes(source_title);
+  const std::wstring &w_user_name = converter.from_bytes(user_name);
+  const std::wstring &w_quality = converter.from_bytes(quality);
+
+  streamer_status_cache_->OnStatusResponse(
+      w_status, w_source_title, w_user_name, w_quality);
+
+  std::vector<StatusWaiter> waiters = TakeStatusWaiters();
+  for (const auto &waiter : waiters) {
+    if (waiter.response_handler) {
+      callback_watchdog_->Run(CallbackKind::kResponse, [&]() {
+        waiter.response_handler(
+            w_status, w_source_title, w_user_name, w_quality);
+      });
+    }
+  }
+  RecycleStatusWaiters(&waiters);
+
+  if (IsInFlight(
+          busy_, *current_request_, MessageType::kStreamingStatusRequest)) {
+    CompleteRequest();
+  }
+}
+
+
+void NcStreamerRemote::Impl::OnRemoteStartResponse(
+    const boost::property_tree::ptree &response) {
+  // the error ID is read in place, not to copy it.
+  const std::string *error{nullptr};
+  try {
+    error = &response.get_child("error").data();
+  } catch (const std::exception &/*e*/) {
+    error = nullptr;
+  }
+
+  if (error == nullptr) {
+    LogError("start response broken");
+    return;
+  }
+
+  OnRemoteResult(BatchItem::Type::kStart, *error);
+}
+
+
+void NcStreamerRemote::Impl::OnRemoteStopResponse(
+    const boost::property_tree::ptree &response) {
+  const std::string *error{nullptr};
+  try {
+    error = &response.get_child("error").data();
+  } catch (const std::exception &/*e*/) {
+    error = nullptr;
+  }
+
+  if (error == nullptr) {
+    LogError("stop response broken");
+    return;
+  }
+
+  OnRemoteResult(BatchItem::Type::kStop, *error);
+}
+
+
+void NcStreamerRemote::Impl::OnRemoteQualityUpdateResponse(
+    const boost::property_tree::ptree &response) {
+  const std::string *error{nullptr};
+  try {
+    error = &response.get_child("error").data();
+  } catch (const std::exception &/*e*/) {
+    error = nullptr;
+  }
+
+  if (error == nullptr) {
+    LogError("stop response broken");
+    return;
+  }
+
+  OnRemoteResult(BatchItem::Type::kQualityUpdate, *error);
+}
+
+
+void NcStreamerRemote::Impl::OnRemoteBatchResponse(
+    const boost::property_tree::ptree &response) {
+  if (IsInFlight(busy_, *current_request_,
+                 MessageType::kBatchRequest) == false ||
+      batch_sequential_ == true) {
+    LogWarning("unexpected batch response");
+    return;
+  }
+
+  timer_to_fall_back_batch_->Cancel();
+  batch_support_ = BatchSupport::kSupported;
+
+  const std::vector<BatchItem> &items = current_request_->batch_items;
+  std::vector<bool> responded(items.size(), false);
+  for (const auto &child : response) {
+    std::size_t id{0};
+    std::string error{};
+    try {
+      id = child.second.get<std::size_t>("id");
+      error = child.second.get<std::string>("error");
+    } catch (const std::exception &/*e*/) {
+      id = 0;
+    }
+
+    if (id == 0 || id > items.size()) {
+      LogError("batch response item broken");
+      continue;
+    }
+    batch_results_[id - 1] = ToResult(items[id - 1].type, error);
+    responded[id - 1] = true;
+    if (items[id - 1].type == BatchItem::Type::kQualityUpdate &&
+        error.empty() == true) {
+      streamer_status_cache_->OnQualityUpdated(items[id - 1].param);
+    }
+  }
+
+  for (std::size_t i = 0; i < items.size(); ++i) {
+    if (responded[i] == false && items[i].type != BatchItem::Type::kExit) {
+      batch_results_[i].category = ErrorCategory::kConnection;
+      batch_results_[i].err_code =
+          static_cast<int>(Error::Connection::kUnknownError);
+      batch_results_[i].err_msg = L"no response to this item in the batch";
+    }
+  }
+
+  FinishBatch();
+}
+
+
+void NcStreamerRemote::Impl::OnRemoteHandshakeResponse(
+    const boost::property_tree::ptree &response) {
+  int version{0};
+  std::string capabilities{};
+  std::string epoch{};
+  bool resumed{false};
+  try {
+    version = response.get<int>("version");
+    capabilities = response.get<std::string>("capabilities");
+    epoch = response.get<std::string>("epoch", std::string{});
+    resumed = response.get<bool>("resumed", false);
+  } catch (const std::exception &/*e*/) {
+    version = 0;
+  }
+
+  if (version <= 0) {
+    LogError("handshake response broken");
+    return;
+  }
+
+  std::vector<std::string> tokens{};
+  boost::split(tokens, capabilities, boost::is_any_of(","));
+  bool batch{false};
+  bool msgpack{false};
+  bool resume{false};
+  for (const auto &token : tokens) {
+    if (token == ncstreamer::RemoteMessage::Capability::kBatch) {
+      batch = true;
+    } else if (token == ncstreamer::RemoteMessage::Capability::kMsgpack) {
+      msgpack = true;
+    } else if (token == ncstreamer::RemoteMessage::Capability::kResume) {
+      resume = true;
+    }
+  }
+
+  batch_support_ =
+      batch ? BatchSupport::kSupported : BatchSupport::kUnsupported;
+  if (msgpack == true && binary_encoding_enabled_ == true) {
+    request_payload_cache_->SetEncoding(
+        RequestPayloadCache::Encoding::kMsgpack);
+  }
+
+  if (resume == false || epoch != event_epoch_) {
+    // another NCStreamer numbers its events from the start.
+    last_event_seq_ = 0;
+    event_epoch_ = epoch;
+    resumed = false;
+  }
+  event_epoch_confirmed_ = (resume == true && epoch.empty() == false);
+
+  if (resuming_ == true) {
+    FinishResume(resumed);
+  }
+}
+
+
+void NcStreamerRemote::Impl::OnRemoteResult(
+    BatchItem::Type request_type,
+    const std::string &error) {
+  // a known error passes its static description by reference,
+  // so that reporting it allocates nothing.
+  BatchResult result{ErrorCategory::kNoCategory, 0, std::wstring{}};
+  const std::wstring *err_msg{&result.err_msg};
+  if (error.empty() == false) {
+    const ErrorDescription *description =
+        ToErrorCode(request_type, error, &result);
+    if (description) {
+      err_msg = &description->wide;
+    } else {
+      result.err_msg = ToWide(error);
+    }
+  }
+
+  if (IsInFlight(busy_, *current_request_,
+                 RequestPayloadCache::ToRequestType(request_type))) {
+    if (result.category == ErrorCategory::kNoCategory) {
+      if (request_type == BatchItem::Type::kQualityUpdate) {
+        streamer_status_cache_->OnQualityUpdated(current_request_->param);
+      }
+      if (current_request_->response_handler) {
+        callback_watchdog_->Run(CallbackKind::kResponse, [this]() {
+          current_request_->response_handler(true);
+        });
+      }
+    } else if (current_request_->error_handler) {
+      callback_watchdog_->Run(CallbackKind::kError, [&]() {
+        current_request_->error_handler(
+            result.category, result.err_code, *err_msg);
+      });
+    }
+    CompleteRequest();
+    return;
+  }
+
+  if (IsInFlight(busy_, *current_request_, MessageType::kBatchRequest) &&
+      batch_sequential_ == true &&
+      batch_cursor_ < current_request_->batch_items.size() &&
+      current_request_->batch_items[batch_cursor_].type == request_type) {
+    if (request_type == BatchItem::Type::kQualityUpdate &&
+        result.category == ErrorCategory::kNoCategory) {
+      streamer_status_cache_->OnQualityUpdated(
+          current_request_->batch_items[batch_cursor_].param);
+    }
+    BatchResult &batch_result = batch_results_[batch_cursor_];
+    batch_result.category = result.category;
+    batch_result.err_code = result.err_code;
+    batch_result.err_msg = *err_msg;
+    ++batch_cursor_;
+    SendNextBatchItem();
+    return;
+  }
+
+  LogWarning("unexpected response");
+}
+
+
+bool NcStreamerRemote::Impl::DropPendingRequest() {
+  std::lock_guard<std::mutex> lock{remote_connection_mutex_};
+  connecting_ = false;
+  bool request_pending = request_pending_;
+  request_pending_ = false;
+  return request_pending;
+}
+
+
+void NcStreamerRemote::Impl::HandleConnectFailure(
+    Error::Connection err_code,
+    const websocketpp::lib::error_code &ec) {
+  if (DropPendingRequest() == true) {
+    if (ec) {
+      HandleError(err_code, ec);
+    } else {
+      HandleError(err_code);
+    }
+  } else {
+    LogWarning(ErrorConverter::ToConnectionError(err_code).narrow);
+  }
+
+  if (stopping_ == true) {
+    return;
+  }
+  static const std::int64_t kReconnectIntervalNs{1000000000};
+  timer_to_keep_connected_->ExpiresAfter(kReconnectIntervalNs);
+  AsyncWait(timer_to_keep_connected_.get(), [this]() {
+    KeepConnected();
+  });
+}
+
+
+void NcStreamerRemote::Impl::HandleDisconnect(
+    Error::Connection err_code) {
+  DropPendingRequest();
+  {
+    std::lock_guard<std::mutex> lock{remote_connection_mutex_};
+    remote_connection_.reset();
+  }
+  streamer_status_cache_->Invalidate();
+
+  resuming_ = false;
+  event_epoch_confirmed_ = false;
+  timer_to_resume_->Cancel();
+
+  {
+    std::lock_guard<std::mutex> lock{status_waiters_mutex_};
+    timer_to_coalesce_status_->Cancel();
+  }
+
+  FailStatusWaiters(
+      ErrorCategory::kConnection,
+      static_cast<int>(err_code),
+      ErrorConverter::ToConnectionError(err_code).wide);
+
+  if (busy_ == true) {
+    HandleError(err_code);  // the request in flight is lost.
+  } else {
+    LogWarning(ErrorConverter::ToConnectionError(err_code).narrow);
+  }
+
+  if (disconnect_handler_) {
+    callback_watchdog_->RunEvent(
+        CallbackKind::kDisconnect, disconnect_handler_);
+  }
+
+  KeepConnected();
+}
+
+
+void NcStreamerRemote::Impl::HandleConnectionError(
+    Error::Connection err_code,
+    const UniqueErrorHandler &err_handler) {
+  if (!err_handler) {
+    return;
+  }
+
+  const std::wstring &w_err_msg =
+      ErrorConverter::ToConnectionError(err_code).wide;
+  callback_watchdog_->Run(CallbackKind::kError, [&]() {
+    err_handler(
+        ErrorCategory::kConnection, static_cast<int>(err_code), w_err_msg);
+  });
+}
+
+
+void NcStreamerRemote::Impl::HandleError(
+    Error::Connection err_code,
+    const websocketpp::lib::error_code &ec) {
+  HandleError(err_code, ec, current_request_->error_handler);
+  CompleteRequest();
+}
+
+
+void NcStreamerRemote::Impl::HandleError(
+    Error::Connection err_code,
+    const websocketpp::lib::error_code &ec,
+    const UniqueErrorHandler &err_handler) {
+  // the detail goes only to the log; the handler gets the description.
+  std::stringstream ss;
+  ss << ErrorConverter::ToConnectionError(err_code).narrow
+     << ": " << ec.message();
+  LogError(ss.str());
+  HandleConnectionError(err_code, err_handler);
+}
+
+
+void NcStreamerRemote::Impl::HandleError(
+    Error::Connection err_code) {
+  HandleError(err_code, current_request_->error_handler);
+  CompleteRequest();
+}
+
+
+void NcStreamerRemote::Impl::HandleError(
+    Error::Connection err_code,
+    const UniqueErrorHandler &err_handler) {
+  LogError(ErrorConverter::ToConnectionError(err_code).narrow);
+  HandleConnectionError(err_code, err_handler);
+}
+
+
+void NcStreamerRemote::Impl::LogWarning(const std::string &warn_msg) {
+  remote_.get_elog().write(websocketpp::log::elevel::warn, warn_msg);
+}
+
+
+void NcStreamerRemote::Impl::LogError(const std::string &err_msg) {
+  remote_.get_elog().write(websocketpp::log::elevel::rerror, err_msg);
+}
+
+}  // namespace ncstreamer_remote
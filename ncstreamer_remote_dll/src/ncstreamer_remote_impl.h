@@ -0,0 +1,503 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_SRC_NCSTREAMER_REMOTE_IMPL_H_
+#define NCSTREAMER_REMOTE_DLL_SRC_NCSTREAMER_REMOTE_IMPL_H_
+
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "boost/asio/io_service.hpp"
+#include "boost/asio/strand.hpp"
+#include "boost/property_tree/ptree.hpp"
+
+#ifdef _MSC_VER
+#pragma warning(disable: 4267)
+#endif
+#include "websocketpp/client.hpp"
+#include "websocketpp/config/asio_no_tls_client.hpp"
+#ifdef _MSC_VER
+#pragma warning(default: 4267)
+#endif
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/io_pool.h"
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/ncstreamer_remote.h"
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/remote_clock.h"
+#include "ncstreamer_remote_dll/src/ncstreamer_remote_message_types.h"
+
+
+namespace ncstreamer_remote {
+class CallbackWatchdog;
+class CancellationRelay;
+class HandlerMemory;
+class PortProber;
+class QueuedRequest;
+class RequestPayloadCache;
+class RequestQueue;
+class RequestThrottle;
+class StatsRecorder;
+class StreamerStatusCache;
+class TrafficCaptureWriter;
+class TrafficRecord;
+
+
+/// Everything of NcStreamerRemote behind its public header.
+class NcStreamerRemote::Impl {
+ public:
+  Impl(
+      const PortDiscovery &discovery,
+      const std::shared_ptr<IoPool> &io_pool,
+      const std::shared_ptr<RemoteClock> &clock,
+      const std::string &log_path);
+  virtual ~Impl();
+
+  bool Close(
+      std::uint32_t deadline_ms,
+      bool flush_urgent);
+
+  void RegisterReadyHandler(
+      const ReadyHandler &ready_handler);
+
+  void RegisterConnectHandler(
+      const ConnectHandler &connect_handler);
+
+  void RegisterDisconnectHandler(
+      const DisconnectHandler &disconnect_handler);
+
+  void RegisterStartEventHandler(
+      const StartEventHandler &start_event_handler);
+
+  void RegisterStopEventHandler(
+      const StopEventHandler &stop_event_handler);
+
+  void RegisterUtf8StartEventHandler(
+      const Utf8StartEventHandler &start_event_handler);
+
+  void RegisterUtf8StopEventHandler(
+      const Utf8StopEventHandler &stop_event_handler);
+
+  void SetStatusCoalescingWindow(
+      std::uint32_t window_ms);
+
+  void SetQualityUpdateDebounceWindow(
+      std::uint32_t window_ms);
+
+  void SetCallbackBudget(
+      std::uint32_t budget_us,
+      const SlowCallbackHandler &slow_callback_handler,
+      std::uint32_t offload_after);
+
+  void SetRequestQueuePolicy(
+      std::size_t capacity,
+      OverflowPolicy overflow_policy,
+      std::uint32_t block_timeout_ms);
+
+  void SetBinaryEncodingEnabled(bool enabled);
+
+  void SetRateLimit(
+      RequestType type,
+      const RateLimit &rate_limit);
+
+  RemoteStats GetStats() const;
+
+  bool StartCapture(const std::string &path);
+  void StopCapture();
+  ReplayStats Replay(
+      const std::string &capture_path,
+      bool recorded_speed);
+
+  void RequestStatus(
+      const ErrorHandler &error_handler,
+      const StatusResponseHandler &status_response_handler,
+      const CancellationToken &cancellation_token);
+
+  void RequestStart(
+      const std::wstring &title,
+      const ErrorHandler &error_handler,
+      const StartResponseHandler &start_response_handler,
+      const CancellationToken &cancellation_token);
+
+  void RequestStop(
+      const std::wstring &title,
+      const ErrorHandler &error_handler,
+      const StopResponseHandler &stop_response_handler,
+      const CancellationToken &cancellation_token);
+
+  void RequestQualityUpdate(
+      const std::wstring &quality,
+      const ErrorHandler &error_handler,
+      const SuccessHandler &quality_update_response_handler,
+      const CancellationToken &cancellation_token);
+
+  void RequestExit(
+      const ErrorHandler &error_handler,
+      const CancellationToken &cancellation_token);
+
+  void RequestBatch(
+      const std::vector<BatchItem> &items,
+      const ErrorHandler &error_handler,
+      const BatchResponseHandler &batch_response_handler,
+      const CancellationToken &cancellation_token);
+
+  void RequestStatus(
+      UniqueErrorHandler &&error_handler,
+      UniqueStatusResponseHandler &&status_response_handler,
+      const CancellationToken &cancellation_token);
+
+  std::shared_ptr<const StreamerStatus> GetCachedStatus() const;
+
+  void RequestCachedStatus(
+      std::uint32_t max_age_ms,
+      const ErrorHandler &error_handler,
+      const StatusResponseHandler &status_response_handler,
+      const CancellationToken &cancellation_token);
+
+  void RequestStart(
+      std::wstring &&title,
+      UniqueErrorHandler &&error_handler,
+      UniqueStartResponseHandler &&start_response_handler,
+      const CancellationToken &cancellation_token);
+
+  void RequestStop(
+      std::wstring &&title,
+      UniqueErrorHandler &&error_handler,
+      UniqueStopResponseHandler &&stop_response_handler,
+      const CancellationToken &cancellation_token);
+
+  void RequestQualityUpdate(
+      std::wstring &&quality,
+      UniqueErrorHandler &&error_handler,
+      UniqueSuccessHandler &&quality_update_response_handler,
+      const CancellationToken &cancellation_token);
+
+  void RequestExit(
+      UniqueErrorHandler &&error_handler,
+      const CancellationToken &cancellation_token);
+
+  void RequestBatch(
+      std::vector<BatchItem> &&items,
+      UniqueErrorHandler &&error_handler,
+      UniqueBatchResponseHandler &&batch_response_handler,
+      const CancellationToken &cancellation_token);
+
+ private:
+  using AsioClient = websocketpp::config::asio_client;
+
+  class StatusWaiter {
+   public:
+    StatusWaiter(
+        UniqueErrorHandler &&error_handler,
+        UniqueStatusResponseHandler &&response_handler,
+        const CancellationToken &cancellation_token);
+    StatusWaiter(StatusWaiter &&other);
+    virtual ~StatusWaiter();
+
+    StatusWaiter &operator=(StatusWaiter &&other);
+
+    UniqueErrorHandler error_handler;
+    UniqueStatusResponseHandler response_handler;
+    CancellationToken cancellation_token;
+  };
+
+  enum class BatchSupport {
+    kUnknown,
+    kSupported,
+    kUnsupported,
+  };
+
+  Impl(const Impl &) = delete;
+  Impl &operator=(const Impl &) = delete;
+
+  /// A task of Post, with its memory from handler_memory_.
+  template <typename Task>
+  class PostedTask;
+
+  /// Every handler of this instance runs through these, on strand_,
+  /// and is counted so that the destructor can wait for them.
+  /// Post may be called from any thread, and doesn't allocate once warm.
+  /// Dispatch is called only from the io threads, where asio recycles
+  /// the handler memory by itself.
+  template <typename Task>
+  void Post(Task &&task);
+  void Dispatch(std::function<void()> &&task);
+  void AsyncWait(
+      RemoteClock::Timer *timer,
+      std::function<void()> &&on_expired);
+  void FinishTask();
+  void Initialize(const std::string &log_path);
+  void FinishInitialization(bool success);
+  void BeginClose(bool flush_urgent);
+  void Stop();
+  void FailQueuedRequests(bool keep_urgent);
+  void FailThrottledRequests(bool keep_urgent);
+  void FailDebouncedQualityUpdate();
+  long GetCloseTimeoutMs() const;  // NOLINT
+  bool IsDrained();
+
+  /// Runs the handlers of a manual io pool on this thread until drained.
+  bool PollUntilDrained(std::int64_t deadline_ns);
+
+  bool ExistsNcStreamer();
+
+  void KeepConnected();
+
+  void Connect();
+
+  /// Finds the port of NCStreamer, unless it is fixed or already found.
+  bool NeedsDiscovery() const;
+  bool IsOffline() const;
+  void Discover();
+  void OnPortDiscovered(
+      std::uint16_t port);
+
+  /// Cancelling the token calls CancelRequests on the io thread.
+  void WatchCancellation(
+      const CancellationToken &cancellation_token);
+  void CancelRequests(
+      const CancellationToken &cancellation_token);
+  void CancelCurrentRequest();
+  bool DropCancelledResponse(
+      ncstreamer::RemoteMessage::MessageType msg_type);
+
+  bool IsIoThread() const;
+  void Enqueue(
+      QueuedRequest *request);
+  void PushRequest(
+      QueuedRequest *request);
+  void ArmThrottleTimer();
+  void ReleaseThrottledRequests();
+  void DispatchNextRequest();
+  void SubmitCurrentRequest();
+  void SendCurrentRequest();
+  void CompleteRequest();
+
+  bool SendStatusRequest();
+  bool SendStartRequest(
+      const std::wstring &title);
+  bool SendStopRequest(
+      const std::wstring &title);
+  bool SendQualityUpdateRequest(
+      const std::wstring &quality);
+  bool SendExitRequest();
+  void SendBatchRequest();
+  void SendHandshake();
+  void SendNextBatchItem();
+  void FallBackFromBatch();
+  void FinishBatch();
+  bool SendPayload(
+      const std::string &payload);
+
+  void StartQualityUpdate(
+      std::wstring &&quality,
+      UniqueErrorHandler &&error_handler,
+      UniqueSuccessHandler &&quality_update_response_handler,
+      const CancellationToken &cancellation_token);
+  void DebounceQualityUpdate(
+      std::wstring &&quality,
+      UniqueErrorHandler &&error_handler,
+      UniqueSuccessHandler &&quality_update_response_handler,
+      const CancellationToken &cancellation_token);
+  void ArmQualityUpdateTimer();
+  void FlushQualityUpdate();
+  void FinishQualityUpdate(
+      ErrorCategory category,
+      int err_code,
+      const std::wstring &err_msg);
+
+  void RefreshStatus();
+  void StartStatusRequest(
+      UniqueErrorHandler &&error_handler,
+      UniqueStatusResponseHandler &&status_response_handler,
+      const CancellationToken &cancellation_token);
+  void EnqueueStatusRequest();
+  void FailStatusWaiters(
+      ErrorCategory category,
+      int err_code,
+      const std::wstring &err_msg);
+  std::vector<StatusWaiter> TakeStatusWaiters();
+  void RecycleStatusWaiters(
+      std::vector<StatusWaiter> *waiters);
+
+  void OnRemoteOpen(
+      websocketpp::connection_hdl connection);
+  void OnRemoteFail(
+      websocketpp::connection_hdl connection);
+  void OnRemoteClose(
+      websocketpp::connection_hdl connection);
+  void OnRemoteMessage(
+      websocketpp::connection_hdl connection,
+      websocketpp::connection<AsioClient>::message_ptr msg);
+  void OnRemotePayload(
+      const std::string &payload,
+      bool binary);
+  void ReplayRecord(
+      const TrafficRecord &record);
+
+  bool AcceptEvent(
+      const boost::property_tree::ptree &evt);
+  void FinishResume(
+      bool resumed);
+
+  void OnRemoteStartEvent(
+      const boost::property_tree::ptree &evt);
+  void OnRemoteStopEvent(
+      const boost::property_tree::ptree &evt);
+
+  void OnRemoteStatusResponse(
+      const boost::property_tree::ptree &response);
+  void OnRemoteStartResponse(
+      const boost::property_tree::ptree &response);
+  void OnRemoteStopResponse(
+      const boost::property_tree::ptree &response);
+  void OnRemoteQualityUpdateResponse(
+      const boost::property_tree::ptree &response);
+  void OnRemoteBatchResponse(
+      const boost::property_tree::ptree &response);
+  void OnRemoteHandshakeResponse(
+      const boost::property_tree::ptree &response);
+  /// @param error ID of the error from NCStreamer, or empty on success.
+  void OnRemoteResult(
+      BatchItem::Type request_type,
+      const std::string &error);
+
+  bool DropPendingRequest();
+
+  void HandleConnectFailure(
+      Error::Connection err_code,
+      const websocketpp::lib::error_code &ec);
+  void HandleDisconnect(
+      Error::Connection err_code);
+  void HandleConnectionError(
+      Error::Connection err_code,
+      const UniqueErrorHandler &err_handler);
+
+  void HandleError(
+      Error::Connection err_code,
+      const websocketpp::lib::error_code &ec,
+      const UniqueErrorHandler &err_handler);
+  void HandleError(
+      Error::Connection err_code,
+      const websocketpp::lib::error_code &ec);
+  void HandleError(
+      Error::Connection err_code,
+      const UniqueErrorHandler &err_handler);
+  void HandleError(
+      Error::Connection err_code);
+
+  void LogWarning(
+      const std::string &warn_msg);
+  void LogError(
+      const std::string &err_msg);
+
+  std::shared_ptr<IoPool> io_pool_;
+  bool owns_io_pool_;
+  const std::shared_ptr<RemoteClock> clock_;
+  boost::asio::io_service::strand strand_;
+  const std::shared_ptr<HandlerMemory> handler_memory_;
+  websocketpp::client<AsioClient> remote_;
+  std::ofstream remote_log_;
+
+  std::atomic_bool closing_;  // takes no more requests.
+  std::atomic_bool stopping_;
+  std::atomic<std::int64_t> close_deadline_ns_;  // 0 for none.
+
+  std::mutex ready_mutex_;
+  bool initialized_;
+  bool initialization_succeeded_;
+  ReadyHandler ready_handler_;
+  std::atomic<std::size_t> outstanding_tasks_;
+  std::mutex drain_mutex_;
+  std::condition_variable drain_cv_;
+
+  /// Touched only on the io thread, except for the constant discovery_.
+  const PortDiscovery discovery_;
+  std::uint16_t discovered_port_;
+  websocketpp::uri_ptr remote_uri_;
+  std::unique_ptr<PortProber> port_prober_;
+  std::unique_ptr<RemoteClock::Timer> timer_to_end_discovery_;
+
+  std::mutex remote_connection_mutex_;
+  websocketpp::connection_hdl remote_connection_;
+  bool connecting_;
+  std::unique_ptr<RemoteClock::Timer> timer_to_keep_connected_;
+
+  std::unique_ptr<StatsRecorder> stats_;
+  std::unique_ptr<TrafficCaptureWriter> traffic_capture_;
+  std::unique_ptr<CallbackWatchdog> callback_watchdog_;
+  std::unique_ptr<RequestPayloadCache> request_payload_cache_;
+  std::unique_ptr<StreamerStatusCache> streamer_status_cache_;
+  std::atomic_bool binary_encoding_enabled_;
+
+  /// The current request is touched only on the io thread.
+  std::unique_ptr<RequestQueue> request_queue_;
+  std::unique_ptr<RequestThrottle> request_throttle_;
+  /// Touched only on the io thread.
+  std::unique_ptr<RemoteClock::Timer> timer_to_release_throttled_;
+  std::unique_ptr<QueuedRequest> current_request_;
+  std::atomic_bool busy_;
+
+  /// Sends the current request once the connection is opened.
+  bool request_pending_;
+
+  std::shared_ptr<CancellationRelay> cancellation_relay_;
+
+  /// Responses still to come for cancelled requests, in the order sent,
+  /// touched only on the io thread.
+  std::vector<ncstreamer::RemoteMessage::MessageType> cancelled_responses_;
+
+  /// State of the current batch request, touched only on the io thread.
+  BatchSupport batch_support_;
+  bool batch_sequential_;
+  std::size_t batch_cursor_;
+  std::vector<BatchResult> batch_results_;
+  std::unique_ptr<RemoteClock::Timer> timer_to_fall_back_batch_;
+
+  /// Event stream position, touched only on the io thread.
+  /// The epoch names the NCStreamer instance that numbered the events.
+  std::uint64_t last_event_seq_;
+  std::string event_epoch_;
+  bool event_epoch_confirmed_;
+  bool resuming_;
+  std::unique_ptr<RemoteClock::Timer> timer_to_resume_;
+
+  ConnectHandler connect_handler_;
+  DisconnectHandler disconnect_handler_;
+  StartEventHandler start_event_handler_;
+  StopEventHandler stop_event_handler_;
+  Utf8StartEventHandler utf8_start_event_handler_;
+  Utf8StopEventHandler utf8_stop_event_handler_;
+
+  std::mutex status_waiters_mutex_;
+  bool status_in_flight_;
+  std::vector<StatusWaiter> status_waiters_;
+  std::atomic<std::uint32_t> status_coalescing_window_ms_;
+  std::unique_ptr<RemoteClock::Timer> timer_to_coalesce_status_;
+
+  std::mutex quality_update_mutex_;
+  bool debounced_quality_pending_;
+  bool debounced_quality_in_flight_;
+  std::wstring debounced_quality_;
+  UniqueErrorHandler debounced_quality_error_handler_;
+  UniqueSuccessHandler debounced_quality_response_handler_;
+  CancellationToken debounced_quality_cancellation_token_;
+  UniqueErrorHandler quality_in_flight_error_handler_;
+  UniqueSuccessHandler quality_in_flight_response_handler_;
+  CancellationToken quality_in_flight_cancellation_token_;
+  std::atomic<std::uint32_t> quality_update_debounce_window_ms_;
+  std::unique_ptr<RemoteClock::Timer> timer_to_debounce_quality_;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_SRC_NCSTREAMER_REMOTE_IMPL_H_
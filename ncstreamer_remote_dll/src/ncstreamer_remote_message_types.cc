@@ -7,6 +7,16 @@
 
 
 namespace ncstreamer {
+const char *const RemoteMessage::
+    Capability::kBatch{"batch"};
+
+const char *const RemoteMessage::
+    Capability::kMsgpack{"msgpack"};
+
+const char *const RemoteMessage::
+    Capability::kResume{"resume"};
+
+
 const char *const RemoteMessage::Error::
     Start::kNoUser{"no user"};
 
@@ -9,12 +9,15 @@
 
 namespace ncstreamer {
 static const wchar_t *const kNcStreamerWindowTitle{L"NCStreaming"};
+static const int kRemoteProtocolVersion{1};
 
 
 class RemoteMessage {
  public:
   enum class MessageType {
     kUndefined = 0,
+    kRemoteHandshakeRequest = 1,
+    kRemoteHandshakeResponse,
     kStreamingStatusRequest = 101,
     kStreamingStatusResponse,
     kStreamingStartRequest = 201,
@@ -25,10 +28,20 @@ class RemoteMessage {
     kStreamingStopEvent,
     kSettingsQualityUpdateRequest = 301,
     kSettingsQualityUpdateResponse,
+    kBatchRequest = 801,  // a JSON array of requests with "id"s.
+    kBatchResponse,  // a JSON array of responses with the same "id"s.
     kNcStreamerExitRequest = 901,
     kNcStreamerExitResponse,  // not used.
   };
 
+  /// Comma separated in the "capabilities" of the handshake.
+  class Capability {
+   public:
+    static const char *const kBatch;
+    static const char *const kMsgpack;
+    static const char *const kResume;
+  };
+
   class Error {
    public:
     class Start {
@@ -0,0 +1,222 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/src/port_prober.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "boost/property_tree/json_parser.hpp"
+#include "boost/property_tree/ptree.hpp"
+
+#include "ncstreamer_remote_dll/src/ncstreamer_remote_message_types.h"
+
+
+namespace ncstreamer_remote {
+PortProber::PortProber(
+    websocketpp::client<AsioClient> *client,
+    const Dispatcher &dispatcher)
+    : client_{client},
+      dispatcher_{dispatcher},
+      generation_{0},
+      found_handler_{},
+      open_probes_{},
+      probes_started_{0},
+      probes_ended_{0},
+      probes_alive_{0} {
+}
+
+
+PortProber::~PortProber() {
+}
+
+
+void PortProber::Probe(
+    const std::vector<std::uint16_t> &ports,
+    std::uint32_t timeout_ms,
+    const FoundHandler &found_handler) {
+  Cancel();
+
+  ++generation_;
+  found_handler_ = found_handler;
+  probes_started_ = 0;
+  probes_ended_ = 0;
+
+  const std::uint32_t generation{generation_};
+  for (std::uint16_t port : ports) {
+    websocketpp::uri_ptr uri{
+        new websocketpp::uri{false, "localhost", port, ""}};
+    websocketpp::lib::error_code ec;
+    auto connection = client_->get_connection(uri, ec);
+    if (ec) {
+      continue;
+    }
+    connection->set_open_handshake_timeout(timeout_ms);
+    connection->set_close_handshake_timeout(timeout_ms);
+
+    connection->set_open_handler([this, generation, port](
+        websocketpp::connection_hdl hdl) {
+      dispatcher_([this, generation, port, hdl]() {
+        OnProbeOpen(generation, port, hdl);
+      });
+    });
+    connection->set_fail_handler([this, generation](
+        websocketpp::connection_hdl /*hdl*/) {
+      dispatcher_([this, generation]() {
+        OnProbeEnd(generation);
+      });
+    });
+    connection->set_close_handler([this, generation](
+        websocketpp::connection_hdl /*hdl*/) {
+      dispatcher_([this, generation]() {
+        OnProbeEnd(generation);
+      });
+    });
+    connection->set_message_handler([this, generation, port](
+        websocketpp::connection_hdl /*hdl*/,
+        websocketpp::connection<AsioClient>::message_ptr msg) {
+      dispatcher_([this, generation, port, msg]() {
+        OnProbeMessage(generation, port, msg);
+      });
+    });
+
+    ++probes_alive_;
+    ++probes_started_;
+    client_->connect(connection);
+  }
+
+  if (probes_started_ == 0) {
+    Finish(0);
+  }
+}
+
+
+bool PortProber::Cancel() {
+  if (!found_handler_) {
+    return false;
+  }
+  found_handler_ = nullptr;
+  for (const auto &probe : open_probes_) {
+    Close(probe.connection);
+  }
+  open_probes_.clear();
+  return true;
+}
+
+
+bool PortProber::IsIdle() const {
+  return probes_alive_ == 0;
+}
+
+
+std::uint16_t PortProber::ReadPortFile(const std::string &path) {
+  if (path.empty() == true) {
+    return 0;
+  }
+  std::ifstream file{path};
+  unsigned long port{0};  // NOLINT
+  if (!(file >> port) || port > 0xFFFF) {
+    return 0;
+  }
+  return static_cast<std::uint16_t>(port);
+}
+
+
+void PortProber::OnProbeOpen(
+    std::uint32_t generation,
+    std::uint16_t port,
+    websocketpp::connection_hdl connection) {
+  if (generation != generation_ || !found_handler_) {
+    Close(connection);  // too late.
+    return;
+  }
+  open_probes_.emplace_back(OpenProbe{port, connection});
+
+  // an NCStreamer without the handshake still answers the status request.
+  static const ncstreamer::RemoteMessage::MessageType kQuestions[]{
+      ncstreamer::RemoteMessage::MessageType::kRemoteHandshakeRequest,
+      ncstreamer::RemoteMessage::MessageType::kStreamingStatusRequest};
+  for (auto msg_type : kQuestions) {
+    std::stringstream msg;
+    {
+      boost::property_tree::ptree tree;
+      tree.put("type", static_cast<int>(msg_type));
+      if (msg_type ==
+          ncstreamer::RemoteMessage::MessageType::kRemoteHandshakeRequest) {
+        tree.put("version", ncstreamer::kRemoteProtocolVersion);
+      }
+      boost::property_tree::write_json(msg, tree, false);
+    }
+
+    websocketpp::lib::error_code ec;
+    client_->send(
+        connection, msg.str(), websocketpp::frame::opcode::text, ec);
+    if (ec) {
+      Close(connection);
+      return;
+    }
+  }
+}
+
+
+void PortProber::OnProbeEnd(std::uint32_t generation) {
+  --probes_alive_;
+  if (generation != generation_ || !found_handler_) {
+    return;
+  }
+  if (++probes_ended_ == probes_started_) {
+    Finish(0);  // nobody has answered.
+  }
+}
+
+
+void PortProber::OnProbeMessage(
+    std::uint32_t generation,
+    std::uint16_t port,
+    websocketpp::connection<AsioClient>::message_ptr msg) {
+  if (generation != generation_ || !found_handler_) {
+    return;
+  }
+  if (msg->get_opcode() != websocketpp::frame::opcode::text ||
+      IsNcStreamerAnswer(msg->get_payload()) == false) {
+    return;  // keeps waiting; the probe fails on timeout.
+  }
+  Finish(port);
+}
+
+
+void PortProber::Finish(std::uint16_t port) {
+  FoundHandler found_handler{found_handler_};
+  Cancel();
+  found_handler(port);
+}
+
+
+void PortProber::Close(websocketpp::connection_hdl connection) {
+  websocketpp::lib::error_code ec;
+  client_->close(
+      connection, websocketpp::close::status::going_away, "", ec);
+}
+
+
+bool PortProber::IsNcStreamerAnswer(const std::string &payload) {
+  ncstreamer::RemoteMessage::MessageType msg_type{
+      ncstreamer::RemoteMessage::MessageType::kUndefined};
+  try {
+    boost::property_tree::ptree response;
+    std::stringstream ss{payload};
+    boost::property_tree::read_json(ss, response);
+    msg_type = static_cast<ncstreamer::RemoteMessage::MessageType>(
+        response.get<int>("type"));
+  } catch (const std::exception &/*e*/) {
+    return false;
+  }
+
+  return msg_type ==
+             ncstreamer::RemoteMessage::MessageType::kRemoteHandshakeResponse ||
+         msg_type ==
+             ncstreamer::RemoteMessage::MessageType::kStreamingStatusResponse;
+}
+}  // namespace ncstreamer_remote
@@ -0,0 +1,89 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_SRC_PORT_PROBER_H_
+#define NCSTREAMER_REMOTE_DLL_SRC_PORT_PROBER_H_
+
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "websocketpp/client.hpp"
+#include "websocketpp/config/asio_no_tls_client.hpp"
+
+
+namespace ncstreamer_remote {
+/// Connects to several ports at once, and tells the first one whose peer
+/// answers like NCStreamer does.
+/// Not thread safe: the handlers of the probes are passed to the dispatcher,
+/// which runs them on the same strand as the calls.
+class PortProber {
+ public:
+  using AsioClient = websocketpp::config::asio_client;
+  using Dispatcher = std::function<void(std::function<void()> &&task)>;
+  using FoundHandler = std::function<void(std::uint16_t port)>;
+
+  PortProber(
+      websocketpp::client<AsioClient> *client,
+      const Dispatcher &dispatcher);
+  virtual ~PortProber();
+
+  /// Calls found_handler once, with the winning port, or with 0 when every
+  /// probe has failed. The probes left are closed then.
+  void Probe(
+      const std::vector<std::uint16_t> &ports,
+      std::uint32_t timeout_ms,
+      const FoundHandler &found_handler);
+
+  /// Gives up the probing in progress without calling its handler.
+  /// @return Whether a probing was in progress.
+  bool Cancel();
+
+  /// No probe is connecting or connected. May be called from any thread.
+  bool IsIdle() const;
+
+  /// @return The port in the file, or 0 if there is none.
+  static std::uint16_t ReadPortFile(const std::string &path);
+
+ private:
+  struct OpenProbe {
+    std::uint16_t port;
+    websocketpp::connection_hdl connection;
+  };
+
+  /// Probes of an earlier probing, still closing, are told apart
+  /// by their generation.
+  void OnProbeOpen(
+      std::uint32_t generation,
+      std::uint16_t port,
+      websocketpp::connection_hdl connection);
+  void OnProbeEnd(std::uint32_t generation);
+  void OnProbeMessage(
+      std::uint32_t generation,
+      std::uint16_t port,
+      websocketpp::connection<AsioClient>::message_ptr msg);
+
+  void Finish(std::uint16_t port);
+  void Close(websocketpp::connection_hdl connection);
+
+  static bool IsNcStreamerAnswer(const std::string &payload);
+
+  websocketpp::client<AsioClient> *client_;
+  Dispatcher dispatcher_;
+
+  std::uint32_t generation_;
+  FoundHandler found_handler_;
+  std::vector<OpenProbe> open_probes_;  // to close at the end.
+  std::size_t probes_started_;
+  std::size_t probes_ended_;
+  std::atomic<std::size_t> probes_alive_;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_SRC_PORT_PROBER_H_
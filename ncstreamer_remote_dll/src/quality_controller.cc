@@ -0,0 +1,308 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/quality_controller.h"
+
+#include <algorithm>
+#include <cassert>
+#include <mutex>  // NOLINT
+#include <utility>
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/ncstreamer_remote.h"
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/remote_clock.h"
+
+
+namespace {
+const std::size_t kNoLevel{static_cast<std::size_t>(-1)};
+
+
+std::int64_t ToNs(std::uint32_t ms) {
+  return static_cast<std::int64_t>(ms) * 1000000;
+}
+
+
+bool IsValid(const ncstreamer_remote::QualityControlPolicy &policy) {
+  return policy.levels.empty() == false &&
+         policy.initial_level < policy.levels.size() &&
+         policy.frame_budget_us != 0 &&
+         policy.sample_weight > 0.0 &&
+         policy.sample_weight <= 1.0 &&
+         policy.step_up_load < policy.step_down_load;
+}
+}  // unnamed namespace
+
+
+namespace ncstreamer_remote {
+class QualityController::State {
+ public:
+  State(
+      const QualityControlPolicy &policy,
+      const std::shared_ptr<RemoteClock> &clock)
+      : policy_(policy),
+        clock_{clock},
+        mutex_{},
+        level_{policy.initial_level},
+        changing_{false},
+        frame_load_{0.0, 0},
+        cpu_load_{0.0, 0},
+        above_since_ns_{0},
+        below_since_ns_{0},
+        last_change_ns_{0},
+        cancellation_token_{} {}
+
+  const QualityControlPolicy &policy() const { return policy_; }
+
+  CancellationToken BeginStatus() {
+    std::lock_guard<std::mutex> lock{mutex_};
+    changing_ = true;
+    cancellation_token_ = CancellationToken::Create();
+    return cancellation_token_;
+  }
+
+  CancellationToken GetCancellationToken() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return cancellation_token_;
+  }
+
+  /// @return The level to change to, or kNoLevel.
+  std::size_t AddLoad(double load, bool frame_time) {
+    std::int64_t now_ns = clock_->NowNs();
+    std::lock_guard<std::mutex> lock{mutex_};
+    LoadSource &source = frame_time ? frame_load_ : cpu_load_;
+    if (IsFresh(source, now_ns) == false) {
+      source.load = load;  // starts over, not from a stale load.
+    } else {
+      source.load += policy_.sample_weight * (load - source.load);
+    }
+    source.sampled_ns = now_ns;
+    return Decide(now_ns);
+  }
+
+  void OnStatus(const std::wstring &quality) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    const auto &levels = policy_.levels;
+    auto i = std::find(levels.begin(), levels.end(), quality);
+    if (i != levels.end()) {
+      level_ = static_cast<std::size_t>(i - levels.begin());
+    }
+    changing_ = false;
+  }
+
+  void OnChanged(std::size_t level) {
+    std::int64_t now_ns = clock_->NowNs();
+    std::lock_guard<std::mutex> lock{mutex_};
+    level_ = level;
+    changing_ = false;
+    last_change_ns_ = now_ns;
+  }
+
+  /// Keeps the level, and waits for the change interval to try again.
+  void OnFailed() {
+    std::int64_t now_ns = clock_->NowNs();
+    std::lock_guard<std::mutex> lock{mutex_};
+    changing_ = false;
+    last_change_ns_ = now_ns;
+  }
+
+  std::size_t GetLevel() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return level_;
+  }
+
+  bool IsChanging() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return changing_;
+  }
+
+ private:
+  struct LoadSource {
+    double load;  // smoothed.
+    std::int64_t sampled_ns;  // 0 for never.
+  };
+
+  bool IsFresh(const LoadSource &source, std::int64_t now_ns) const {
+    return source.sampled_ns != 0 &&
+           now_ns - source.sampled_ns <= ToNs(policy_.sample_timeout_ms);
+  }
+
+  std::size_t Decide(std::int64_t now_ns) {
+    // mutex_ is locked by the caller.
+    // a source the host has stopped sampling is left out.
+    double load{0.0};
+    if (IsFresh(frame_load_, now_ns) == true) {
+      load = std::max(load, frame_load_.load);
+    }
+    if (IsFresh(cpu_load_, now_ns) == true) {
+      load = std::max(load, cpu_load_.load);
+    }
+    if (load >= policy_.step_down_load) {
+      above_since_ns_ = (above_since_ns_ != 0) ? above_since_ns_ : now_ns;
+    } else {
+      above_since_ns_ = 0;
+    }
+    if (load <= policy_.step_up_load) {
+      below_since_ns_ = (below_since_ns_ != 0) ? below_since_ns_ : now_ns;
+    } else {
+      below_since_ns_ = 0;
+    }
+
+    if (changing_ == true) {
+      return kNoLevel;  // one change in flight at most.
+    }
+    if (last_change_ns_ != 0 &&
+        now_ns - last_change_ns_ < ToNs(policy_.min_change_interval_ms)) {
+      return kNoLevel;
+    }
+    if (above_since_ns_ != 0 && level_ > 0 &&
+        now_ns - above_since_ns_ >= ToNs(policy_.step_down_after_ms)) {
+      return BeginChange(level_ - 1);
+    }
+    if (below_since_ns_ != 0 && level_ + 1 < policy_.levels.size() &&
+        now_ns - below_since_ns_ >= ToNs(policy_.step_up_after_ms)) {
+      return BeginChange(level_ + 1);
+    }
+    return kNoLevel;
+  }
+
+  std::size_t BeginChange(std::size_t level) {
+    // mutex_ is locked by the caller.
+    changing_ = true;
+    above_since_ns_ = 0;  // the next change needs a load of its own.
+    below_since_ns_ = 0;
+    cancellation_token_ = CancellationToken::Create();
+    return level;
+  }
+
+  const QualityControlPolicy policy_;
+  const std::shared_ptr<RemoteClock> clock_;
+
+  mutable std::mutex mutex_;
+  std::size_t level_;
+  bool changing_;
+  LoadSource frame_load_;
+  LoadSource cpu_load_;
+  std::int64_t above_since_ns_;  // 0 for none.
+  std::int64_t below_since_ns_;  // 0 for none.
+  std::int64_t last_change_ns_;  // 0 for none.
+
+  /// Of the request in flight.
+  CancellationToken cancellation_token_;
+};
+
+
+QualityControlPolicy QualityController::GetDefaultPolicy() {
+  return QualityControlPolicy{
+      {L"low", L"medium", L"high"},
+      2,
+      16667,
+      0.2,
+      2000,
+      0.9,
+      500,
+      0.7,
+      5000,
+      3000};
+}
+
+
+std::unique_ptr<QualityController> QualityController::Create(
+    NcStreamerRemote *remote,
+    const QualityControlPolicy &policy,
+    const std::shared_ptr<RemoteClock> &clock) {
+  assert(remote);
+  if (IsValid(policy) == false) {
+    return nullptr;
+  }
+  std::unique_ptr<QualityController> controller{
+      new QualityController{remote, policy, clock}};
+  controller->RequestStatus();
+  return controller;
+}
+
+
+QualityController::QualityController(
+    NcStreamerRemote *remote,
+    const QualityControlPolicy &policy,
+    const std::shared_ptr<RemoteClock> &clock)
+    : remote_{remote},
+      state_{std::make_shared<State>(
+          policy, clock ? clock : RemoteClock::CreateSteady())} {
+}
+
+
+QualityController::~QualityController() {
+  state_->GetCancellationToken().Cancel();
+}
+
+
+void QualityController::AddFrameTimeSample(std::uint32_t frame_time_us) {
+  const QualityControlPolicy &policy = state_->policy();
+  std::size_t level = state_->AddLoad(
+      static_cast<double>(frame_time_us) / policy.frame_budget_us, true);
+  if (level != kNoLevel) {
+    RequestLevel(level);
+  }
+}
+
+
+void QualityController::AddCpuSample(double cpu_usage) {
+  std::size_t level = state_->AddLoad(cpu_usage, false);
+  if (level != kNoLevel) {
+    RequestLevel(level);
+  }
+}
+
+
+std::size_t QualityController::GetLevel() const {
+  return state_->GetLevel();
+}
+
+
+bool QualityController::IsChanging() const {
+  return state_->IsChanging();
+}
+
+
+void QualityController::RequestStatus() {
+  // the handlers hold the state, as they may outlive this.
+  std::shared_ptr<State> state{state_};
+  remote_->RequestStatus(
+      NcStreamerRemote::UniqueErrorHandler{[state](
+          ErrorCategory /*category*/,
+          int /*err_code*/,
+          const std::wstring &/*err_msg*/) {
+        state->OnFailed();
+      }},
+      NcStreamerRemote::UniqueStatusResponseHandler{[state](
+          const std::wstring &/*status*/,
+          const std::wstring &/*source_title*/,
+          const std::wstring &/*user_name*/,
+          const std::wstring &quality) {
+        state->OnStatus(quality);
+      }},
+      state_->BeginStatus());
+}
+
+
+void QualityController::RequestLevel(std::size_t level) {
+  std::shared_ptr<State> state{state_};
+  remote_->RequestQualityUpdate(
+      std::wstring{state_->policy().levels[level]},
+      NcStreamerRemote::UniqueErrorHandler{[state](
+          ErrorCategory /*category*/,
+          int /*err_code*/,
+          const std::wstring &/*err_msg*/) {
+        state->OnFailed();
+      }},
+      NcStreamerRemote::UniqueSuccessHandler{[state, level](bool success) {
+        if (success == true) {
+          state->OnChanged(level);
+        } else {
+          state->OnFailed();
+        }
+      }},
+      state_->GetCancellationToken());
+}
+}  // namespace ncstreamer_remote
@@ -0,0 +1,76 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/remote_clock.h"
+
+#include <utility>
+
+#include "boost/asio/steady_timer.hpp"
+
+#if _MSC_VER >= 1900
+#include <chrono>  // NOLINT
+namespace Chrono = std::chrono;
+#else
+#include "boost/chrono/include.hpp"
+namespace Chrono = boost::chrono;
+#endif  // _MSC_VER >= 1900
+
+#include "ncstreamer_remote_dll/src/stats_recorder.h"
+
+
+namespace {
+using ncstreamer_remote::RemoteClock;
+
+
+class SteadyTimer : public RemoteClock::Timer {
+ public:
+  explicit SteadyTimer(boost::asio::io_service *io_service)
+      : timer_{*io_service} {}
+
+  virtual ~SteadyTimer() {}
+
+  void ExpiresAfter(std::int64_t delay_ns) override {
+    timer_.expires_from_now(Chrono::nanoseconds{delay_ns > 0 ? delay_ns : 0});
+  }
+
+  void AsyncWait(RemoteClock::TimerHandler &&handler) override {
+    RemoteClock::TimerHandler timer_handler{std::move(handler)};
+    timer_.async_wait([timer_handler](const boost::system::error_code &ec) {
+      timer_handler(!ec);
+    });
+  }
+
+  void Cancel() override {
+    boost::system::error_code ec;
+    timer_.cancel(ec);
+  }
+
+ private:
+  boost::asio::basic_waitable_timer<Chrono::steady_clock> timer_;
+};
+
+
+class SteadyClock : public RemoteClock {
+ public:
+  SteadyClock() {}
+  virtual ~SteadyClock() {}
+
+  std::int64_t NowNs() const override {
+    return ncstreamer_remote::StatsRecorder::NowNs();
+  }
+
+  std::unique_ptr<Timer> CreateTimer(
+      boost::asio::io_service *io_service) override {
+    return std::unique_ptr<Timer>{new SteadyTimer{io_service}};
+  }
+};
+}  // unnamed namespace
+
+
+namespace ncstreamer_remote {
+std::shared_ptr<RemoteClock> RemoteClock::CreateSteady() {
+  return std::make_shared<SteadyClock>();
+}
+}  // namespace ncstreamer_remote
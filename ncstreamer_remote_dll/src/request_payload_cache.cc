@@ -0,0 +1,204 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/src/request_payload_cache.h"
+
+#include <codecvt>
+#include <locale>
+#include <sstream>
+
+#include "boost/property_tree/json_parser.hpp"
+
+#include "ncstreamer_remote_dll/src/msgpack_codec.h"
+#include "ncstreamer_remote_dll/src/stats_recorder.h"
+
+
+namespace ncstreamer_remote {
+RequestPayloadCache::RequestPayloadCache(StatsRecorder *stats)
+    : encoding_{Encoding::kJson},
+      stats_{stats},
+      status_request_{},
+      exit_request_{},
+      start_requests_{},
+      stop_requests_{} {
+}
+
+
+RequestPayloadCache::~RequestPayloadCache() {
+}
+
+
+void RequestPayloadCache::SetEncoding(Encoding encoding) {
+  if (encoding == encoding_) {
+    return;
+  }
+  encoding_ = encoding;
+  Clear();
+}
+
+
+const std::string &RequestPayloadCache::GetStatusRequest() {
+  if (status_request_.empty() == true) {
+    status_request_ = Encode(
+        ncstreamer::RemoteMessage::MessageType::kStreamingStatusRequest);
+  }
+  return status_request_;
+}
+
+
+const std::string &RequestPayloadCache::GetExitRequest() {
+  if (exit_request_.empty() == true) {
+    exit_request_ = Encode(
+        ncstreamer::RemoteMessage::MessageType::kNcStreamerExitRequest);
+  }
+  return exit_request_;
+}
+
+
+const std::string &RequestPayloadCache::GetStartRequest(
+    const std::wstring &title) {
+  return GetTitleRequest(
+      ncstreamer::RemoteMessage::MessageType::kStreamingStartRequest,
+      title,
+      &start_requests_);
+}
+
+
+const std::string &RequestPayloadCache::GetStopRequest(
+    const std::wstring &title) {
+  return GetTitleRequest(
+      ncstreamer::RemoteMessage::MessageType::kStreamingStopRequest,
+      title,
+      &stop_requests_);
+}
+
+
+std::string RequestPayloadCache::Encode(
+    ncstreamer::RemoteMessage::MessageType msg_type) {
+  boost::property_tree::ptree tree;
+  tree.put("type", static_cast<int>(msg_type));
+  return Serialize(tree);
+}
+
+
+std::string RequestPayloadCache::Encode(
+    ncstreamer::RemoteMessage::MessageType msg_type,
+    const char *param_key,
+    const std::wstring &param_value) {
+  std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+
+  boost::property_tree::ptree tree;
+  tree.put("type", static_cast<int>(msg_type));
+  tree.put(param_key, converter.to_bytes(param_value));
+  return Serialize(tree);
+}
+
+
+std::string RequestPayloadCache::EncodeBatch(
+    const std::vector<BatchItem> &items) {
+  std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+
+  boost::property_tree::ptree tree;
+  for (std::size_t i = 0; i < items.size(); ++i) {
+    const BatchItem &item = items[i];
+    boost::property_tree::ptree request;
+    request.put("id", i + 1);
+    request.put("type", static_cast<int>(ToRequestType(item.type)));
+    switch (item.type) {
+      case BatchItem::Type::kQualityUpdate: {
+        request.put("quality", converter.to_bytes(item.param));
+        break;
+      }
+      case BatchItem::Type::kStart:
+      case BatchItem::Type::kStop: {
+        request.put("title", converter.to_bytes(item.param));
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+    tree.push_back(std::make_pair("", request));
+  }
+  return Serialize(tree);
+}
+
+
+ncstreamer::RemoteMessage::MessageType RequestPayloadCache::ToRequestType(
+    BatchItem::Type item_type) {
+  using MessageType = ncstreamer::RemoteMessage::MessageType;
+  switch (item_type) {
+    case BatchItem::Type::kQualityUpdate:
+      return MessageType::kSettingsQualityUpdateRequest;
+    case BatchItem::Type::kStart:
+      return MessageType::kStreamingStartRequest;
+    case BatchItem::Type::kStop:
+      return MessageType::kStreamingStopRequest;
+    case BatchItem::Type::kExit:
+      return MessageType::kNcStreamerExitRequest;
+    default:
+      return MessageType::kUndefined;
+  }
+}
+
+
+const std::string &RequestPayloadCache::GetTitleRequest(
+    ncstreamer::RemoteMessage::MessageType msg_type,
+    const std::wstring &title,
+    TitlePayloads *payloads) {
+  auto i = payloads->find(title);
+  if (i != payloads->end()) {
+    return i->second;
+  }
+
+  if (payloads->size() >= kMaxTitlePayloads) {
+    payloads->clear();
+  }
+  return payloads->emplace(title, Encode(msg_type, "title", title))
+      .first->second;
+}
+
+
+std::string RequestPayloadCache::Serialize(
+    const boost::property_tree::ptree &tree) {
+  std::int64_t begin_ns = StatsRecorder::NowNs();
+
+  std::string payload{};
+  if (encoding_ == Encoding::kMsgpack) {
+    payload = MsgpackCodec::Encode(tree);
+  } else if (tree.empty() == false && tree.front().first.empty() == true) {
+    // write_json doesn't write an array at the root, so joins the items.
+    std::stringstream msg;
+    msg << '[';
+    for (auto i = tree.begin(); i != tree.end(); ++i) {
+      if (i != tree.begin()) {
+        msg << ',';
+      }
+      boost::property_tree::write_json(msg, i->second, false);
+    }
+    msg << ']';
+    payload = msg.str();
+  } else {
+    std::stringstream msg;
+    boost::property_tree::write_json(msg, tree, false);
+    payload = msg.str();
+  }
+
+  StatsRecorder::Increase(&stats_->messages_encoded);
+  StatsRecorder::AddElapsedNs(&stats_->encode_ns_total, begin_ns);
+  return payload;
+}
+
+
+void RequestPayloadCache::Clear() {
+  status_request_.clear();
+  exit_request_.clear();
+  start_requests_.clear();
+  stop_requests_.clear();
+}
+
+
+const std::size_t RequestPayloadCache::kMaxTitlePayloads{16};
+}  // namespace ncstreamer_remote
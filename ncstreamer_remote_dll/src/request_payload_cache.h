@@ -0,0 +1,84 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_SRC_REQUEST_PAYLOAD_CACHE_H_
+#define NCSTREAMER_REMOTE_DLL_SRC_REQUEST_PAYLOAD_CACHE_H_
+
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/batch_item.h"
+#include "ncstreamer_remote_dll/src/ncstreamer_remote_message_types.h"
+
+#include "boost/property_tree/ptree.hpp"
+
+
+namespace ncstreamer_remote {
+class StatsRecorder;
+
+
+/// Keeps encoded request payloads, so that repeated requests skip
+/// building a ptree and encoding it.
+/// Not thread safe: requests are sent one at a time.
+class RequestPayloadCache {
+ public:
+  enum class Encoding {
+    kJson,  // text frames, understood by every NCStreamer.
+    kMsgpack,  // binary frames, once agreed by the handshake.
+  };
+
+  explicit RequestPayloadCache(StatsRecorder *stats);
+  virtual ~RequestPayloadCache();
+
+  /// Drops every cached payload if the encoding differs from the current.
+  void SetEncoding(Encoding encoding);
+  Encoding encoding() const { return encoding_; }
+
+  const std::string &GetStatusRequest();
+  const std::string &GetExitRequest();
+  const std::string &GetStartRequest(const std::wstring &title);
+  const std::string &GetStopRequest(const std::wstring &title);
+
+  std::string Encode(
+      ncstreamer::RemoteMessage::MessageType msg_type);
+  std::string Encode(
+      ncstreamer::RemoteMessage::MessageType msg_type,
+      const char *param_key,
+      const std::wstring &param_value);
+
+  /// Encodes the items as an array, with "id"s from 1 in order.
+  std::string EncodeBatch(const std::vector<BatchItem> &items);
+
+  static ncstreamer::RemoteMessage::MessageType ToRequestType(
+      BatchItem::Type item_type);
+
+ private:
+  using TitlePayloads = std::unordered_map<std::wstring, std::string>;
+
+  static const std::size_t kMaxTitlePayloads;
+
+  const std::string &GetTitleRequest(
+      ncstreamer::RemoteMessage::MessageType msg_type,
+      const std::wstring &title,
+      TitlePayloads *payloads);
+
+  std::string Serialize(const boost::property_tree::ptree &tree);
+
+  void Clear();
+
+  Encoding encoding_;
+  StatsRecorder *stats_;
+
+  std::string status_request_;
+  std::string exit_request_;
+  TitlePayloads start_requests_;
+  TitlePayloads stop_requests_;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_SRC_REQUEST_PAYLOAD_CACHE_H_
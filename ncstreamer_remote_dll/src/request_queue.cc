@@ -0,0 +1,350 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/src/request_queue.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iterator>
+#include <utility>
+
+#include "ncstreamer_remote_dll/src/request_payload_cache.h"
+
+#if _MSC_VER >= 1900
+namespace Chrono = std::chrono;
+#else
+#include "boost/chrono/include.hpp"
+namespace Chrono = boost::chrono;
+#endif  // _MSC_VER >= 1900
+
+
+namespace ncstreamer_remote {
+QueuedRequest::QueuedRequest()
+    : type{ncstreamer::RemoteMessage::MessageType::kUndefined},
+      param{},
+      error_handler{},
+      response_handler{},
+      batch_items{},
+      batch_response_handler{},
+      enqueued_at_us{0},
+      cancellation_token{} {
+}
+
+
+QueuedRequest::QueuedRequest(QueuedRequest &&other)
+    : type{other.type},
+      param{std::move(other.param)},
+      error_handler{std::move(other.error_handler)},
+      response_handler{std::move(other.response_handler)},
+      batch_items{std::move(other.batch_items)},
+      batch_response_handler{std::move(other.batch_response_handler)},
+      enqueued_at_us{other.enqueued_at_us},
+      cancellation_token{std::move(other.cancellation_token)} {
+}
+
+
+QueuedRequest::~QueuedRequest() {
+}
+
+
+QueuedRequest &QueuedRequest::operator=(QueuedRequest &&other) {
+  type = other.type;
+  param = std::move(other.param);
+  error_handler = std::move(other.error_handler);
+  response_handler = std::move(other.response_handler);
+  batch_items = std::move(other.batch_items);
+  batch_response_handler = std::move(other.batch_response_handler);
+  enqueued_at_us = other.enqueued_at_us;
+  cancellation_token = std::move(other.cancellation_token);
+  return *this;
+}
+
+
+RequestQueue::RequestQueue(
+    std::size_t capacity,
+    OverflowPolicy overflow_policy,
+    std::uint32_t block_timeout_ms)
+    : mutex_{},
+      not_full_{},
+      capacity_{capacity},
+      overflow_policy_{overflow_policy},
+      block_timeout_ms_{block_timeout_ms},
+      closed_{false},
+      size_{0},
+      lanes_{},
+      free_nodes_{} {
+  Reserve();
+}
+
+
+RequestQueue::~RequestQueue() {
+}
+
+
+void RequestQueue::SetPolicy(
+    std::size_t capacity,
+    OverflowPolicy overflow_policy,
+    std::uint32_t block_timeout_ms) {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    capacity_ = capacity;
+    overflow_policy_ = overflow_policy;
+    block_timeout_ms_ = block_timeout_ms;
+    Reserve();
+  }
+  not_full_.notify_all();
+}
+
+
+Error::Connection RequestQueue::Push(
+    QueuedRequest *request,
+    QueuedRequest *dropped,
+    bool *has_dropped,
+    bool can_block) {
+  *has_dropped = false;
+  Priority priority = ToPriority(*request);
+
+  std::unique_lock<std::mutex> lock{mutex_};
+  if (closed_ == true) {
+    return Error::Connection::kShutDown;
+  }
+  if (IsFull() == true) {
+    switch (overflow_policy_) {
+      case OverflowPolicy::kDropOldest: {
+        if (DropOldest(priority, dropped) == false) {
+          return Error::Connection::kQueueFull;
+        }
+        *has_dropped = true;
+        break;
+      }
+      case OverflowPolicy::kBlock: {
+        if (can_block == false) {
+          return Error::Connection::kQueueFull;
+        }
+        bool has_room = not_full_.wait_for(
+            lock,
+            std::chrono::milliseconds{block_timeout_ms_},
+            [this]() { return closed_ == true || IsFull() == false; });
+        if (closed_ == true) {
+          return Error::Connection::kShutDown;
+        }
+        if (has_room == false) {
+          return Error::Connection::kQueueFull;
+        }
+        break;
+      }
+      case OverflowPolicy::kRejectNewest:
+      default: {
+        return Error::Connection::kQueueFull;
+      }
+    }
+  }
+
+  if (free_nodes_.empty() == true) {
+    free_nodes_.emplace_back();  // only if SetPolicy has shrunk the queue.
+  }
+
+  Lane &lane = lanes_[priority];
+  lane.splice(lane.end(), free_nodes_, free_nodes_.begin());
+  lane.back() = std::move(*request);
+  lane.back().enqueued_at_us = NowUs();
+  ++size_;
+  return Error::Connection::kNoError;
+}
+
+
+void RequestQueue::Close() {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    closed_ = true;
+  }
+  not_full_.notify_all();
+}
+
+
+bool RequestQueue::Pop(QueuedRequest *request) {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    Lane *lane{nullptr};
+    for (auto &l : lanes_) {
+      if (l.empty() == false) {
+        lane = &l;
+        break;
+      }
+    }
+    if (!lane) {
+      return false;
+    }
+
+    *request = std::move(lane->front());
+    free_nodes_.splice(free_nodes_.end(), *lane, lane->begin());
+    --size_;
+  }
+  not_full_.notify_one();
+  return true;
+}
+
+
+bool RequestQueue::PopLeastUrgent(QueuedRequest *request, bool keep_urgent) {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    Lane *lane{nullptr};
+    for (int p = kLowPriority; p >= kHighPriority; --p) {
+      if (p == kHighPriority && keep_urgent == true) {
+        break;
+      }
+      if (lanes_[p].empty() == false) {
+        lane = &lanes_[p];
+        break;
+      }
+    }
+    if (!lane) {
+      return false;
+    }
+
+    *request = std::move(lane->back());
+    free_nodes_.splice(free_nodes_.end(), *lane, std::prev(lane->end()));
+    --size_;
+  }
+  not_full_.notify_one();
+  return true;
+}
+
+
+std::size_t RequestQueue::RemoveCancelled(
+    const CancellationToken &token,
+    std::vector<QueuedRequest> *cancelled) {
+  std::size_t removed{0};
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    for (auto &lane : lanes_) {
+      for (auto i = lane.begin(); i != lane.end();) {
+        if (i->cancellation_token != token) {
+          ++i;
+          continue;
+        }
+        cancelled->emplace_back(std::move(*i));
+        *i = QueuedRequest{};
+        auto node = i++;
+        free_nodes_.splice(free_nodes_.end(), lane, node);
+        --size_;
+        ++removed;
+      }
+    }
+  }
+  if (removed > 0) {
+    not_full_.notify_all();
+  }
+  return removed;
+}
+
+
+bool RequestQueue::RemoveFirst(
+    ncstreamer::RemoteMessage::MessageType type,
+    QueuedRequest *removed) {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    Lane &lane = lanes_[ToPriority(type)];
+    auto i = std::find_if(
+        lane.begin(),
+        lane.end(),
+        [type](const QueuedRequest &request) {
+          return request.type == type;
+        });
+    if (i == lane.end()) {
+      return false;
+    }
+    *removed = std::move(*i);
+    *i = QueuedRequest{};
+    free_nodes_.splice(free_nodes_.end(), lane, i);
+    --size_;
+  }
+  not_full_.notify_one();
+  return true;
+}
+
+
+std::size_t RequestQueue::size() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return size_;
+}
+
+
+std::int64_t RequestQueue::NowUs() {
+  return Chrono::duration_cast<Chrono::microseconds>(
+      Chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+bool RequestQueue::IsUrgent(const QueuedRequest &request) {
+  return ToPriority(request) == kHighPriority;
+}
+
+
+RequestQueue::Priority RequestQueue::ToPriority(
+    const QueuedRequest &request) {
+  if (request.type !=
+      ncstreamer::RemoteMessage::MessageType::kBatchRequest) {
+    return ToPriority(request.type);
+  }
+
+  Priority priority{kLowPriority};
+  for (const auto &item : request.batch_items) {
+    Priority item_priority =
+        ToPriority(RequestPayloadCache::ToRequestType(item.type));
+    if (item_priority < priority) {
+      priority = item_priority;
+    }
+  }
+  return priority;
+}
+
+
+RequestQueue::Priority RequestQueue::ToPriority(
+    ncstreamer::RemoteMessage::MessageType type) {
+  using MessageType = ncstreamer::RemoteMessage::MessageType;
+  switch (type) {
+    case MessageType::kNcStreamerExitRequest:
+    case MessageType::kStreamingStopRequest:
+      return kHighPriority;
+    case MessageType::kStreamingStartRequest:
+    case MessageType::kSettingsQualityUpdateRequest:
+      return kNormalPriority;
+    default:
+      return kLowPriority;
+  }
+}
+
+
+bool RequestQueue::IsFull() const {
+  return size_ >= capacity_;
+}
+
+
+bool RequestQueue::DropOldest(Priority priority, QueuedRequest *dropped) {
+  // evicts from the lowest lane, but never one above the new request.
+  for (int p = kLowPriority; p >= priority; --p) {
+    Lane &lane = lanes_[p];
+    if (lane.empty() == false) {
+      *dropped = std::move(lane.front());
+      free_nodes_.splice(free_nodes_.end(), lane, lane.begin());
+      --size_;
+      return true;
+    }
+  }
+  return false;
+}
+
+
+void RequestQueue::Reserve() {
+  while (size_ + free_nodes_.size() < capacity_) {
+    free_nodes_.emplace_back();
+  }
+  while (size_ + free_nodes_.size() > capacity_ &&
+         free_nodes_.empty() == false) {
+    free_nodes_.pop_back();
+  }
+}
+}  // namespace ncstreamer_remote
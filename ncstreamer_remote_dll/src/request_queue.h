@@ -0,0 +1,146 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_SRC_REQUEST_QUEUE_H_
+#define NCSTREAMER_REMOTE_DLL_SRC_REQUEST_QUEUE_H_
+
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <list>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/ncstreamer_remote.h"
+#include "ncstreamer_remote_dll/src/ncstreamer_remote_message_types.h"
+
+
+namespace ncstreamer_remote {
+class QueuedRequest {
+ public:
+  QueuedRequest();
+  QueuedRequest(QueuedRequest &&other);
+  virtual ~QueuedRequest();
+
+  QueuedRequest &operator=(QueuedRequest &&other);
+
+  ncstreamer::RemoteMessage::MessageType type;
+
+  /// Title or quality, according to the type.
+  std::wstring param;
+
+  NcStreamerRemote::UniqueErrorHandler error_handler;
+
+  /// Response handler of start, stop and quality update requests.
+  /// Status responses go to the status waiters instead.
+  NcStreamerRemote::UniqueSuccessHandler response_handler;
+
+  /// Items and response handler of a batch request.
+  std::vector<BatchItem> batch_items;
+  NcStreamerRemote::UniqueBatchResponseHandler batch_response_handler;
+
+  /// Steady clock microseconds when the request is pushed.
+  std::int64_t enqueued_at_us;
+
+  CancellationToken cancellation_token;
+};
+
+
+/// Bounded queue of requests with priority lanes.
+/// Exit and stop requests go first, then start and quality update requests,
+/// then status requests. Requests of the same lane keep their order.
+/// A batch request goes in the lane of its most urgent item.
+/// Nodes are preallocated up to the capacity, so that pushing and popping
+/// don't allocate.
+class RequestQueue {
+ public:
+  using OverflowPolicy = NcStreamerRemote::OverflowPolicy;
+
+  RequestQueue(
+      std::size_t capacity,
+      OverflowPolicy overflow_policy,
+      std::uint32_t block_timeout_ms);
+  virtual ~RequestQueue();
+
+  void SetPolicy(
+      std::size_t capacity,
+      OverflowPolicy overflow_policy,
+      std::uint32_t block_timeout_ms);
+
+  /// Moves the request into the queue, unless an error is returned.
+  /// @param dropped Receives the request evicted by kDropOldest, if any.
+  /// @param can_block False on the io thread, which must not wait for room.
+  /// @return kNoError, or kQueueFull or kShutDown if the request
+  ///     is not queued.
+  Error::Connection Push(
+      QueuedRequest *request,
+      QueuedRequest *dropped,
+      bool *has_dropped,
+      bool can_block);
+
+  /// Refuses the pushes from now on with kShutDown, including those
+  /// waiting for room, which the requests failed on close would free.
+  void Close();
+
+  /// Moves out the first request of the highest priority lane.
+  bool Pop(QueuedRequest *request);
+
+  /// Moves out the last request of the lowest priority lane, e.g. to fail
+  /// it. With keep_urgent, exit and stop requests are left in the queue.
+  bool PopLeastUrgent(QueuedRequest *request, bool keep_urgent);
+
+  /// Moves out the requests made with the token, without calling
+  /// their handlers, for the caller to release them out of the lock.
+  /// @return The number of requests moved out.
+  std::size_t RemoveCancelled(
+      const CancellationToken &token,
+      std::vector<QueuedRequest> *cancelled);
+
+  /// Moves out the first request of the type, without calling its handlers.
+  bool RemoveFirst(
+      ncstreamer::RemoteMessage::MessageType type,
+      QueuedRequest *removed);
+
+  std::size_t size() const;
+
+  /// Whether the request goes in the lane of exit and stop requests.
+  static bool IsUrgent(const QueuedRequest &request);
+
+  static std::int64_t NowUs();
+
+ private:
+  using Lane = std::list<QueuedRequest>;
+
+  enum Priority {
+    kHighPriority = 0,
+    kNormalPriority,
+    kLowPriority,
+    kPriorityCount,
+  };
+
+  static Priority ToPriority(const QueuedRequest &request);
+  static Priority ToPriority(ncstreamer::RemoteMessage::MessageType type);
+
+  bool IsFull() const;
+  bool DropOldest(Priority priority, QueuedRequest *dropped);
+  void Reserve();
+
+  mutable std::mutex mutex_;
+  std::condition_variable not_full_;
+
+  std::size_t capacity_;
+  OverflowPolicy overflow_policy_;
+  std::uint32_t block_timeout_ms_;
+  bool closed_;
+
+  std::size_t size_;
+  Lane lanes_[kPriorityCount];
+  Lane free_nodes_;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_SRC_REQUEST_QUEUE_H_
@@ -0,0 +1,335 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/src/request_throttle.h"
+
+#include <utility>
+
+
+namespace {
+/// Calls two handlers of requests merged into one.
+template <typename Handler>
+class BothHandlers {
+ public:
+  BothHandlers(Handler &&first, Handler &&second)
+      : first_{std::move(first)},
+        second_{std::move(second)} {}
+
+  BothHandlers(BothHandlers &&other)
+      : first_{std::move(other.first_)},
+        second_{std::move(other.second_)} {}
+
+  template <typename... Args>
+  void operator()(const Args &...args) const {
+    if (first_) {
+      first_(args...);
+    }
+    if (second_) {
+      second_(args...);
+    }
+  }
+
+ private:
+  Handler first_;
+  Handler second_;
+};
+
+
+template <typename Handler>
+Handler MergeHandlers(Handler *first, Handler *second) {
+  if (!*first) {
+    return std::move(*second);
+  }
+  if (!*second) {
+    return std::move(*first);
+  }
+  return Handler{BothHandlers<Handler>{std::move(*first), std::move(*second)}};
+}
+}  // unnamed namespace
+
+
+namespace ncstreamer_remote {
+RequestThrottle::RequestThrottle()
+    : buckets_{},
+      mutex_{},
+      held_requests_{} {
+}
+
+
+RequestThrottle::~RequestThrottle() {
+}
+
+
+void RequestThrottle::SetRateLimit(
+    RequestType type,
+    const RateLimit &rate_limit) {
+  buckets_[static_cast<int>(type)].Set(rate_limit);
+}
+
+
+RequestThrottle::Verdict RequestThrottle::Admit(
+    std::int64_t now_ns,
+    QueuedRequest *request,
+    NcStreamerRemote::UniqueErrorHandler *superseded,
+    std::int64_t *release_at_ns) {
+  RequestType type{};
+  if (ToRequestType(request->type, &type) == false) {
+    return Verdict::kPass;
+  }
+
+  Bucket &bucket = buckets_[static_cast<int>(type)];
+  if (bucket.TryTake(now_ns) == true) {
+    return Verdict::kPass;
+  }
+
+  switch (bucket.GetPolicy()) {
+    case RateLimit::Policy::kReject: {
+      return Verdict::kReject;
+    }
+    case RateLimit::Policy::kMerge: {
+      std::lock_guard<std::mutex> lock{mutex_};
+      for (auto &held : held_requests_) {
+        if (Merge(request, &held.request, superseded) == true) {
+          return Verdict::kMerge;
+        }
+      }
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+
+  *release_at_ns = bucket.Reserve(now_ns);
+  Hold(*release_at_ns, request);
+  return Verdict::kHold;
+}
+
+
+bool RequestThrottle::PopDue(
+    std::int64_t now_ns,
+    QueuedRequest *request) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (held_requests_.empty() == true ||
+      held_requests_.front().release_at_ns > now_ns) {
+    return false;
+  }
+  *request = std::move(held_requests_.front().request);
+  held_requests_.pop_front();
+  return true;
+}
+
+
+bool RequestThrottle::PopAny(QueuedRequest *request) {
+  return PopDue(INT64_MAX, request);
+}
+
+
+std::size_t RequestThrottle::RemoveCancelled(
+    const CancellationToken &token,
+    std::vector<QueuedRequest> *cancelled) {
+  std::size_t removed{0};
+  std::lock_guard<std::mutex> lock{mutex_};
+  for (auto i = held_requests_.begin(); i != held_requests_.end();) {
+    if (i->request.cancellation_token != token) {
+      ++i;
+      continue;
+    }
+    cancelled->emplace_back(std::move(i->request));
+    i = held_requests_.erase(i);
+    ++removed;
+  }
+  return removed;
+}
+
+
+bool RequestThrottle::RemoveFirst(
+    ncstreamer::RemoteMessage::MessageType type,
+    QueuedRequest *removed) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  for (auto i = held_requests_.begin(); i != held_requests_.end(); ++i) {
+    if (i->request.type == type) {
+      *removed = std::move(i->request);
+      held_requests_.erase(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+
+std::int64_t RequestThrottle::GetNextReleaseNs() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (held_requests_.empty() == true) {
+    return 0;
+  }
+  return held_requests_.front().release_at_ns;
+}
+
+
+bool RequestThrottle::ToRequestType(
+    ncstreamer::RemoteMessage::MessageType msg_type,
+    RequestType *type) {
+  using MessageType = ncstreamer::RemoteMessage::MessageType;
+  switch (msg_type) {
+    case MessageType::kStreamingStatusRequest:
+      *type = RequestType::kStatus;
+      return true;
+    case MessageType::kStreamingStartRequest:
+      *type = RequestType::kStart;
+      return true;
+    case MessageType::kStreamingStopRequest:
+      *type = RequestType::kStop;
+      return true;
+    case MessageType::kSettingsQualityUpdateRequest:
+      *type = RequestType::kQualityUpdate;
+      return true;
+    case MessageType::kNcStreamerExitRequest:
+      *type = RequestType::kExit;
+      return true;
+    case MessageType::kBatchRequest:
+      *type = RequestType::kBatch;
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+bool RequestThrottle::Merge(
+    QueuedRequest *request,
+    QueuedRequest *held,
+    NcStreamerRemote::UniqueErrorHandler *superseded) {
+  using MessageType = ncstreamer::RemoteMessage::MessageType;
+  if (held->type != request->type ||
+      request->type == MessageType::kBatchRequest ||
+      held->cancellation_token != request->cancellation_token) {
+    return false;
+  }
+
+  if (request->type == MessageType::kSettingsQualityUpdateRequest) {
+    *superseded = std::move(held->error_handler);
+    held->param = std::move(request->param);
+    held->error_handler = std::move(request->error_handler);
+    held->response_handler = std::move(request->response_handler);
+    return true;
+  }
+
+  if (held->param != request->param) {
+    return false;
+  }
+  held->error_handler = MergeHandlers(
+      &held->error_handler, &request->error_handler);
+  held->response_handler = MergeHandlers(
+      &held->response_handler, &request->response_handler);
+  return true;
+}
+
+
+void RequestThrottle::Hold(
+    std::int64_t release_at_ns,
+    QueuedRequest *request) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  auto i = held_requests_.end();
+  while (i != held_requests_.begin()) {
+    auto prev = i;
+    --prev;
+    if (prev->release_at_ns <= release_at_ns) {
+      break;
+    }
+    i = prev;
+  }
+  held_requests_.emplace(i, release_at_ns, std::move(*request));
+}
+
+
+RequestThrottle::Bucket::Bucket()
+    : arrival_ns_{0},
+      interval_ns_{0},
+      tolerance_ns_{0},
+      policy_{static_cast<int>(RateLimit::Policy::kReject)} {
+}
+
+
+RequestThrottle::Bucket::~Bucket() {
+}
+
+
+void RequestThrottle::Bucket::Set(const RateLimit &rate_limit) {
+  static const std::int64_t kNsPerSecond{1000000000};
+  std::int64_t interval_ns{0};
+  std::int64_t tolerance_ns{0};
+  if (rate_limit.rate_per_s != 0) {
+    interval_ns = kNsPerSecond / rate_limit.rate_per_s;
+    std::uint32_t burst = rate_limit.burst > 0 ? rate_limit.burst : 1;
+    tolerance_ns = interval_ns * (burst - 1);
+  }
+  policy_.store(
+      static_cast<int>(rate_limit.policy), std::memory_order_relaxed);
+  tolerance_ns_.store(tolerance_ns, std::memory_order_relaxed);
+  interval_ns_.store(interval_ns, std::memory_order_relaxed);
+}
+
+
+RateLimit::Policy RequestThrottle::Bucket::GetPolicy() const {
+  return static_cast<RateLimit::Policy>(
+      policy_.load(std::memory_order_relaxed));
+}
+
+
+bool RequestThrottle::Bucket::TryTake(std::int64_t now_ns) {
+  std::int64_t interval_ns = interval_ns_.load(std::memory_order_relaxed);
+  if (interval_ns == 0) {
+    return true;
+  }
+  std::int64_t tolerance_ns = tolerance_ns_.load(std::memory_order_relaxed);
+
+  std::int64_t arrival_ns = arrival_ns_.load(std::memory_order_relaxed);
+  std::int64_t start_ns{0};
+  do {
+    start_ns = arrival_ns > now_ns ? arrival_ns : now_ns;
+    if (start_ns - now_ns > tolerance_ns) {
+      return false;  // the bucket is empty.
+    }
+  } while (arrival_ns_.compare_exchange_weak(
+      arrival_ns,
+      start_ns + interval_ns,
+      std::memory_order_relaxed) == false);
+  return true;
+}
+
+
+std::int64_t RequestThrottle::Bucket::Reserve(std::int64_t now_ns) {
+  std::int64_t interval_ns = interval_ns_.load(std::memory_order_relaxed);
+  if (interval_ns == 0) {
+    return now_ns;
+  }
+  std::int64_t tolerance_ns = tolerance_ns_.load(std::memory_order_relaxed);
+
+  std::int64_t arrival_ns = arrival_ns_.load(std::memory_order_relaxed);
+  std::int64_t start_ns{0};
+  do {
+    start_ns = arrival_ns > now_ns ? arrival_ns : now_ns;
+  } while (arrival_ns_.compare_exchange_weak(
+      arrival_ns,
+      start_ns + interval_ns,
+      std::memory_order_relaxed) == false);
+
+  std::int64_t release_at_ns = start_ns - tolerance_ns;
+  return release_at_ns > now_ns ? release_at_ns : now_ns;
+}
+
+
+RequestThrottle::HeldRequest::HeldRequest(
+    std::int64_t release_at_ns,
+    QueuedRequest &&request)
+    : release_at_ns{release_at_ns},
+      request{std::move(request)} {
+}
+
+
+RequestThrottle::HeldRequest::~HeldRequest() {
+}
+}  // namespace ncstreamer_remote
@@ -0,0 +1,141 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_SRC_REQUEST_THROTTLE_H_
+#define NCSTREAMER_REMOTE_DLL_SRC_REQUEST_THROTTLE_H_
+
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>  // NOLINT
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/rate_limit.h"
+#include "ncstreamer_remote_dll/src/request_queue.h"
+
+
+namespace ncstreamer_remote {
+/// Rate limits of the requests, one token bucket per RequestType, and
+/// the requests held back by them.
+/// Taking a token is lock-free; only held requests take the mutex.
+class RequestThrottle {
+ public:
+  enum class Verdict {
+    /// The request has its token, and may be sent now.
+    kPass,
+
+    /// The request is over the limit of RateLimit::Policy::kReject.
+    kReject,
+
+    /// The request is moved into the throttle, until its token comes.
+    kHold,
+
+    /// The request is moved into a held one.
+    kMerge,
+  };
+
+  RequestThrottle();
+  virtual ~RequestThrottle();
+
+  void SetRateLimit(
+      RequestType type,
+      const RateLimit &rate_limit);
+
+  /// @param superseded Receives the error handler of a held quality update
+  ///     replaced by this one, if any.
+  /// @param release_at_ns Receives when a held request may be sent,
+  ///     in the time of now_ns.
+  Verdict Admit(
+      std::int64_t now_ns,
+      QueuedRequest *request,
+      NcStreamerRemote::UniqueErrorHandler *superseded,
+      std::int64_t *release_at_ns);
+
+  /// Moves out the first held request whose token has come by now_ns.
+  bool PopDue(
+      std::int64_t now_ns,
+      QueuedRequest *request);
+
+  /// Moves out any held request, e.g. to fail it.
+  bool PopAny(QueuedRequest *request);
+
+  /// Moves out the held requests made with the token, without calling
+  /// their handlers, for the caller to release them out of the lock.
+  /// @return The number of requests moved out.
+  std::size_t RemoveCancelled(
+      const CancellationToken &token,
+      std::vector<QueuedRequest> *cancelled);
+
+  /// Moves out the first held request of the type,
+  /// without calling its handlers.
+  bool RemoveFirst(
+      ncstreamer::RemoteMessage::MessageType type,
+      QueuedRequest *removed);
+
+  /// @return When the first held request may be sent, in the time passed
+  ///     to Admit, or zero if none is held.
+  std::int64_t GetNextReleaseNs() const;
+
+  static bool ToRequestType(
+      ncstreamer::RemoteMessage::MessageType msg_type,
+      RequestType *type);
+
+ private:
+  /// Token bucket kept as the theoretical arrival time of the next request,
+  /// in one atomic, so that it is updated by a single compare-and-swap.
+  class Bucket {
+   public:
+    Bucket();
+    virtual ~Bucket();
+
+    void Set(const RateLimit &rate_limit);
+    RateLimit::Policy GetPolicy() const;
+
+    /// @return Whether the token is taken, which is always the case
+    ///     without a limit.
+    bool TryTake(std::int64_t now_ns);
+
+    /// Takes the next token, even from the future.
+    /// @return When the token comes.
+    std::int64_t Reserve(std::int64_t now_ns);
+
+   private:
+    std::atomic<std::int64_t> arrival_ns_;
+    std::atomic<std::int64_t> interval_ns_;  // zero for no limit.
+    std::atomic<std::int64_t> tolerance_ns_;
+    std::atomic<int> policy_;
+  };
+
+  class HeldRequest {
+   public:
+    HeldRequest(
+        std::int64_t release_at_ns,
+        QueuedRequest &&request);
+    virtual ~HeldRequest();
+
+    std::int64_t release_at_ns;
+    QueuedRequest request;
+  };
+
+  using HeldRequests = std::list<HeldRequest>;
+
+  static bool Merge(
+      QueuedRequest *request,
+      QueuedRequest *held,
+      NcStreamerRemote::UniqueErrorHandler *superseded);
+
+  void Hold(
+      std::int64_t release_at_ns,
+      QueuedRequest *request);
+
+  Bucket buckets_[static_cast<int>(RequestType::kRequestTypeCount)];
+
+  mutable std::mutex mutex_;
+  HeldRequests held_requests_;  // in the order of release.
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_SRC_REQUEST_THROTTLE_H_
@@ -0,0 +1,282 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/simulated_clock.h"
+
+#include <condition_variable>  // NOLINT
+#include <map>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/io_pool.h"
+
+
+namespace {
+using ncstreamer_remote::RemoteClock;
+
+
+/// Nonzero, as zero stands for no time in places.
+const std::int64_t kEpochNs{1000000000};
+
+
+/// Timers of equal deadlines expire in the order of their waits.
+using WaitKey = std::pair<std::int64_t, std::uint64_t>;
+
+
+void PostHandler(
+    boost::asio::io_service *io_service,
+    const RemoteClock::TimerHandler &handler,
+    bool expired) {
+  io_service->post([handler, expired]() {
+    handler(expired);
+  });
+}
+}  // unnamed namespace
+
+
+namespace ncstreamer_remote {
+class SimulatedClock::State : public std::enable_shared_from_this<State> {
+ public:
+  class Wait {
+   public:
+    Wait(
+        boost::asio::io_service *io_service,
+        TimerHandler &&handler)
+        : io_service{io_service},
+          handler{std::move(handler)} {}
+
+    Wait(Wait &&other)
+        : io_service{other.io_service},
+          handler{std::move(other.handler)} {}
+
+    boost::asio::io_service *io_service;
+    TimerHandler handler;
+  };
+
+  /// Tells the state once an expired handler is run, or dropped unrun.
+  class Ticket {
+   public:
+    explicit Ticket(const std::shared_ptr<State> &state)
+        : state_{state} {}
+
+    virtual ~Ticket() {
+      state_->FinishExpired();
+    }
+
+   private:
+    const std::shared_ptr<State> state_;
+  };
+
+  State()
+      : mutex{},
+        unfinished_cv{},
+        now_ns{kEpochNs},
+        next_seq{0},
+        expired_count{0},
+        unfinished_count{0},
+        waits{} {}
+
+  /// Moves the time to the first deadline up to target_ns, and expires
+  /// the timers due then, or moves it to target_ns if none is due.
+  /// @return The number of timers expired.
+  std::size_t Step(std::int64_t target_ns) {
+    std::vector<Wait> expired_waits{};
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      std::int64_t step_ns = target_ns;
+      if (waits.empty() == false && waits.begin()->first.first < step_ns) {
+        step_ns = waits.begin()->first.first;
+      }
+      while (waits.empty() == false &&
+             waits.begin()->first.first <= step_ns) {
+        expired_waits.emplace_back(std::move(waits.begin()->second));
+        waits.erase(waits.begin());
+      }
+      expired_count += expired_waits.size();
+      unfinished_count += expired_waits.size();
+      if (step_ns > now_ns) {
+        now_ns = step_ns;
+      }
+    }
+    for (const auto &wait : expired_waits) {
+      std::shared_ptr<Ticket> ticket{new Ticket{shared_from_this()}};
+      TimerHandler handler{wait.handler};
+      wait.io_service->post([ticket, handler]() {
+        handler(true);
+      });
+    }
+    return expired_waits.size();
+  }
+
+  bool HasUnfinished() const {
+    std::lock_guard<std::mutex> lock{mutex};
+    return unfinished_count != 0;
+  }
+
+  /// Waits for the expired handlers to be run by their io threads.
+  void WaitForUnfinished() {
+    std::unique_lock<std::mutex> lock{mutex};
+    unfinished_cv.wait(lock, [this]() {
+      return unfinished_count == 0;
+    });
+  }
+
+  void FinishExpired() {
+    std::lock_guard<std::mutex> lock{mutex};
+    --unfinished_count;
+    if (unfinished_count == 0) {
+      unfinished_cv.notify_all();
+    }
+  }
+
+  mutable std::mutex mutex;
+  std::condition_variable unfinished_cv;
+  std::int64_t now_ns;
+  std::uint64_t next_seq;
+  std::uint64_t expired_count;
+
+  /// Handlers expired by Step, and not run yet.
+  std::uint64_t unfinished_count;
+
+  std::map<WaitKey, Wait> waits;
+};
+
+
+class SimulatedClock::SimulatedTimer : public RemoteClock::Timer {
+ public:
+  SimulatedTimer(
+      const std::shared_ptr<State> &state,
+      boost::asio::io_service *io_service)
+      : state_{state},
+        io_service_{io_service},
+        deadline_ns_{0},
+        wait_keys_{} {
+    std::lock_guard<std::mutex> lock{state_->mutex};
+    deadline_ns_ = state_->now_ns;
+  }
+
+  virtual ~SimulatedTimer() {
+    Cancel();
+  }
+
+  void ExpiresAfter(std::int64_t delay_ns) override {
+    Cancel();
+    std::lock_guard<std::mutex> lock{state_->mutex};
+    deadline_ns_ = state_->now_ns + (delay_ns > 0 ? delay_ns : 0);
+  }
+
+  void AsyncWait(TimerHandler &&handler) override {
+    {
+      std::lock_guard<std::mutex> lock{state_->mutex};
+      if (deadline_ns_ > state_->now_ns) {
+        WaitKey key{deadline_ns_, state_->next_seq++};
+        state_->waits.emplace(
+            key, State::Wait{io_service_, std::move(handler)});
+        wait_keys_.emplace_back(key);
+        return;
+      }
+      ++state_->expired_count;
+    }
+    PostHandler(io_service_, handler, true);  // expired already.
+  }
+
+  void Cancel() override {
+    std::vector<TimerHandler> cancelled{};
+    {
+      std::lock_guard<std::mutex> lock{state_->mutex};
+      for (const auto &key : wait_keys_) {
+        auto i = state_->waits.find(key);
+        if (i != state_->waits.end()) {  // or expired meanwhile.
+          cancelled.emplace_back(std::move(i->second.handler));
+          state_->waits.erase(i);
+        }
+      }
+      wait_keys_.clear();
+    }
+    for (const auto &handler : cancelled) {
+      PostHandler(io_service_, handler, false);
+    }
+  }
+
+ private:
+  const std::shared_ptr<State> state_;
+  boost::asio::io_service *const io_service_;
+  std::int64_t deadline_ns_;
+  std::vector<WaitKey> wait_keys_;
+};
+
+
+std::shared_ptr<SimulatedClock> SimulatedClock::Create() {
+  return std::shared_ptr<SimulatedClock>{new SimulatedClock{}};
+}
+
+
+SimulatedClock::SimulatedClock()
+    : state_{std::make_shared<State>()} {
+}
+
+
+SimulatedClock::~SimulatedClock() {
+}
+
+
+std::int64_t SimulatedClock::NowNs() const {
+  std::lock_guard<std::mutex> lock{state_->mutex};
+  return state_->now_ns;
+}
+
+
+std::unique_ptr<RemoteClock::Timer> SimulatedClock::CreateTimer(
+    boost::asio::io_service *io_service) {
+  return std::unique_ptr<Timer>{new SimulatedTimer{state_, io_service}};
+}
+
+
+void SimulatedClock::AdvanceBy(std::int64_t duration_ns) {
+  std::int64_t target_ns = NowNs() + (duration_ns > 0 ? duration_ns : 0);
+  while (state_->Step(target_ns) != 0) {
+    state_->WaitForUnfinished();
+  }
+}
+
+
+void SimulatedClock::AdvanceBy(
+    std::int64_t duration_ns,
+    IoPool *manual_pool) {
+  std::int64_t target_ns = NowNs() + (duration_ns > 0 ? duration_ns : 0);
+  while (state_->Step(target_ns) != 0) {
+    while (state_->HasUnfinished() == true && manual_pool->Poll() != 0) {
+      // the handlers may post more, e.g. to a strand.
+    }
+  }
+}
+
+
+bool SimulatedClock::AdvanceToNextTimer() {
+  std::int64_t target_ns{0};
+  {
+    std::lock_guard<std::mutex> lock{state_->mutex};
+    if (state_->waits.empty() == true) {
+      return false;
+    }
+    target_ns = state_->waits.begin()->first.first;
+  }
+  state_->Step(target_ns);
+  return true;
+}
+
+
+std::size_t SimulatedClock::GetArmedTimerCount() const {
+  std::lock_guard<std::mutex> lock{state_->mutex};
+  return state_->waits.size();
+}
+
+
+std::uint64_t SimulatedClock::GetExpiredTimerCount() const {
+  std::lock_guard<std::mutex> lock{state_->mutex};
+  return state_->expired_count;
+}
+}  // namespace ncstreamer_remote
@@ -0,0 +1,142 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/src/stats_recorder.h"
+
+#if _MSC_VER >= 1900
+#include <chrono>  // NOLINT
+namespace Chrono = std::chrono;
+#else
+#include "boost/chrono/include.hpp"
+namespace Chrono = boost::chrono;
+#endif  // _MSC_VER >= 1900
+
+
+namespace {
+std::uint64_t Load(const ncstreamer_remote::StatsRecorder::Counter &counter) {
+  return counter.load(std::memory_order_relaxed);
+}
+}  // unnamed namespace
+
+
+namespace ncstreamer_remote {
+StatsRecorder::StatsRecorder()
+    : status_requests{0},
+      status_requests_sent{0},
+      status_requests_coalesced{0},
+      quality_updates{0},
+      quality_updates_sent{0},
+      quality_updates_superseded{0},
+      requests_queued{0},
+      requests_dispatched{0},
+      requests_rejected{0},
+      requests_dropped{0},
+      requests_cancelled{0},
+      cancelled_responses_dropped{0},
+      requests_throttle_rejected{0},
+      requests_throttle_delayed{0},
+      requests_throttle_merged{0},
+      throttle_delay_us_total{0},
+      queue_depth_max{0},
+      queue_wait_us_total{0},
+      queue_wait_us_max{0},
+      batch_requests{0},
+      batch_fallbacks{0},
+      messages_sent{0},
+      binary_messages_sent{0},
+      bytes_sent{0},
+      messages_received{0},
+      binary_messages_received{0},
+      bytes_received{0},
+      messages_encoded{0},
+      encode_ns_total{0},
+      decode_ns_total{0},
+      events_received{0},
+      events_duplicated{0},
+      resumes{0},
+      resyncs{0},
+      port_discoveries{0},
+      port_discovery_failures{0},
+      io_tasks{0},
+      io_task_latency_ns_total{0},
+      io_task_latency_ns_max{0},
+      callbacks{0},
+      callbacks_slow{0},
+      callbacks_offloaded{0} {
+  for (auto &bucket : callback_us_histogram) {
+    bucket = 0;
+  }
+}
+
+
+StatsRecorder::~StatsRecorder() {
+}
+
+
+RemoteStats StatsRecorder::Snapshot() const {
+  RemoteStats stats{};
+  stats.status_requests = Load(status_requests);
+  stats.status_requests_sent = Load(status_requests_sent);
+  stats.status_requests_coalesced = Load(status_requests_coalesced);
+  stats.quality_updates = Load(quality_updates);
+  stats.quality_updates_sent = Load(quality_updates_sent);
+  stats.quality_updates_superseded = Load(quality_updates_superseded);
+  stats.requests_queued = Load(requests_queued);
+  stats.requests_dispatched = Load(requests_dispatched);
+  stats.requests_rejected = Load(requests_rejected);
+  stats.requests_dropped = Load(requests_dropped);
+  stats.requests_cancelled = Load(requests_cancelled);
+  stats.cancelled_responses_dropped = Load(cancelled_responses_dropped);
+  stats.requests_throttle_rejected = Load(requests_throttle_rejected);
+  stats.requests_throttle_delayed = Load(requests_throttle_delayed);
+  stats.requests_throttle_merged = Load(requests_throttle_merged);
+  stats.throttle_delay_us_total = Load(throttle_delay_us_total);
+  stats.queue_depth = 0;  // filled by the owner of the queue.
+  stats.queue_depth_max = Load(queue_depth_max);
+  stats.queue_wait_us_total = Load(queue_wait_us_total);
+  stats.queue_wait_us_max = Load(queue_wait_us_max);
+  stats.batch_requests = Load(batch_requests);
+  stats.batch_fallbacks = Load(batch_fallbacks);
+  stats.messages_sent = Load(messages_sent);
+  stats.binary_messages_sent = Load(binary_messages_sent);
+  stats.bytes_sent = Load(bytes_sent);
+  stats.messages_received = Load(messages_received);
+  stats.binary_messages_received = Load(binary_messages_received);
+  stats.bytes_received = Load(bytes_received);
+  stats.messages_encoded = Load(messages_encoded);
+  stats.encode_ns_total = Load(encode_ns_total);
+  stats.decode_ns_total = Load(decode_ns_total);
+  stats.events_received = Load(events_received);
+  stats.events_duplicated = Load(events_duplicated);
+  stats.resumes = Load(resumes);
+  stats.resyncs = Load(resyncs);
+  stats.port_discoveries = Load(port_discoveries);
+  stats.port_discovery_failures = Load(port_discovery_failures);
+  stats.io_tasks = Load(io_tasks);
+  stats.io_task_latency_ns_total = Load(io_task_latency_ns_total);
+  stats.io_task_latency_ns_max = Load(io_task_latency_ns_max);
+  stats.callbacks = Load(callbacks);
+  stats.callbacks_slow = Load(callbacks_slow);
+  stats.callbacks_offloaded = Load(callbacks_offloaded);
+  for (std::size_t i = 0; i < RemoteStats::kCallbackHistogramSize; ++i) {
+    stats.callback_us_histogram[i] = Load(callback_us_histogram[i]);
+  }
+  return stats;
+}
+
+
+std::int64_t StatsRecorder::NowNs() {
+  return Chrono::duration_cast<Chrono::nanoseconds>(
+      Chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+void StatsRecorder::AddElapsedNs(Counter *counter, std::int64_t begin_ns) {
+  std::int64_t elapsed_ns = NowNs() - begin_ns;
+  if (elapsed_ns > 0) {
+    Add(counter, static_cast<std::uint64_t>(elapsed_ns));
+  }
+}
+}  // namespace ncstreamer_remote
@@ -0,0 +1,96 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_SRC_STATS_RECORDER_H_
+#define NCSTREAMER_REMOTE_DLL_SRC_STATS_RECORDER_H_
+
+
+#include <atomic>
+#include <cstdint>
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/remote_stats.h"
+
+
+namespace ncstreamer_remote {
+/// Lock-free counters behind RemoteStats.
+class StatsRecorder {
+ public:
+  using Counter = std::atomic<std::uint64_t>;
+
+  StatsRecorder();
+  virtual ~StatsRecorder();
+
+  RemoteStats Snapshot() const;
+
+  /// Steady clock, for measuring durations.
+  static std::int64_t NowNs();
+
+  /// Adds the nanoseconds elapsed since begin_ns, a value of NowNs.
+  static void AddElapsedNs(Counter *counter, std::int64_t begin_ns);
+
+  static void Increase(Counter *counter) {
+    counter->fetch_add(1, std::memory_order_relaxed);
+  }
+
+  static void Add(Counter *counter, std::uint64_t value) {
+    counter->fetch_add(value, std::memory_order_relaxed);
+  }
+
+  static void Maximize(Counter *counter, std::uint64_t value) {
+    std::uint64_t current = counter->load(std::memory_order_relaxed);
+    while (current < value &&
+           counter->compare_exchange_weak(
+               current, value, std::memory_order_relaxed) == false) {
+    }
+  }
+
+  Counter status_requests;
+  Counter status_requests_sent;
+  Counter status_requests_coalesced;
+  Counter quality_updates;
+  Counter quality_updates_sent;
+  Counter quality_updates_superseded;
+  Counter requests_queued;
+  Counter requests_dispatched;
+  Counter requests_rejected;
+  Counter requests_dropped;
+  Counter requests_cancelled;
+  Counter cancelled_responses_dropped;
+  Counter requests_throttle_rejected;
+  Counter requests_throttle_delayed;
+  Counter requests_throttle_merged;
+  Counter throttle_delay_us_total;
+  Counter queue_depth_max;
+  Counter queue_wait_us_total;
+  Counter queue_wait_us_max;
+  Counter batch_requests;
+  Counter batch_fallbacks;
+  Counter messages_sent;
+  Counter binary_messages_sent;
+  Counter bytes_sent;
+  Counter messages_received;
+  Counter binary_messages_received;
+  Counter bytes_received;
+  Counter messages_encoded;
+  Counter encode_ns_total;
+  Counter decode_ns_total;
+  Counter events_received;
+  Counter events_duplicated;
+  Counter resumes;
+  Counter resyncs;
+  Counter port_discoveries;
+  Counter port_discovery_failures;
+  Counter io_tasks;
+  Counter io_task_latency_ns_total;
+  Counter io_task_latency_ns_max;
+  Counter callbacks;
+  Counter callbacks_slow;
+  Counter callbacks_offloaded;
+  Counter callback_us_histogram[RemoteStats::kCallbackHistogramSize];
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_SRC_STATS_RECORDER_H_
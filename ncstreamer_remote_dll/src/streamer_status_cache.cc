@@ -0,0 +1,143 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/src/streamer_status_cache.h"
+
+#include <atomic>
+
+#if _MSC_VER >= 1900
+#include <chrono>  // NOLINT
+namespace Chrono = std::chrono;
+#else
+#include "boost/chrono/include.hpp"
+namespace Chrono = boost::chrono;
+#endif  // _MSC_VER >= 1900
+
+
+namespace ncstreamer_remote {
+StreamerStatusCache::StreamerStatusCache()
+    : snapshot_{std::make_shared<StreamerStatus>()},
+      last_known_{} {
+}
+
+
+StreamerStatusCache::~StreamerStatusCache() {
+}
+
+
+std::shared_ptr<const StreamerStatus> StreamerStatusCache::Get() const {
+  return std::atomic_load(&snapshot_);
+}
+
+
+void StreamerStatusCache::OnStatusResponse(
+    const std::wstring &status,
+    const std::wstring &source_title,
+    const std::wstring &user_name,
+    const std::wstring &quality) {
+  static const std::wstring kOnAir{L"onAir"};
+
+  StreamerStatus next{*Get()};
+  next.status = status;
+  next.source_title = source_title;
+  next.user_name = user_name;
+  next.quality = quality;
+  if (status != kOnAir) {
+    next.stream_url.clear();
+    next.post_url.clear();
+  }
+  Publish(&next);
+}
+
+
+void StreamerStatusCache::OnStartEvent(
+    const std::wstring &source_title,
+    const std::wstring &stream_url,
+    const std::wstring &post_url) {
+  StreamerStatus next{*Get()};
+  next.status = L"onAir";
+  next.source_title = source_title;
+  next.stream_url = stream_url;
+  next.post_url = post_url;
+  Publish(&next);
+}
+
+
+void StreamerStatusCache::OnStopEvent(
+    const std::wstring &source_title) {
+  auto current = Get();
+  if (source_title.empty() == false &&
+      current->source_title.empty() == false &&
+      source_title != current->source_title) {
+    return;  // of another source, e.g. a stale one.
+  }
+
+  StreamerStatus next{*current};
+  next.status = L"standby";
+  next.source_title.clear();
+  next.stream_url.clear();
+  next.post_url.clear();
+  Publish(&next);
+}
+
+
+void StreamerStatusCache::OnQualityUpdated(
+    const std::wstring &quality) {
+  auto current = Get();
+  if (current->status.empty() == true ||
+      current->quality == quality) {
+    return;
+  }
+
+  StreamerStatus next{*current};
+  next.quality = quality;
+  Publish(&next);
+}
+
+
+void StreamerStatusCache::Invalidate() {
+  auto current = Get();
+  if (current->status.empty() == true) {
+    return;  // already unknown.
+  }
+  last_known_ = current;
+
+  StreamerStatus next{};
+  next.version = current->version;
+  Publish(&next);
+}
+
+
+bool StreamerStatusCache::RestoreLastKnown() {
+  auto last_known = std::move(last_known_);
+  last_known_.reset();
+
+  auto current = Get();
+  if (!last_known || current->status.empty() == false) {
+    return false;
+  }
+
+  StreamerStatus next{*last_known};
+  next.version = current->version;
+  Publish(&next);
+  return true;
+}
+
+
+std::int64_t StreamerStatusCache::NowMs() {
+  return Chrono::duration_cast<Chrono::milliseconds>(
+      Chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+void StreamerStatusCache::Publish(StreamerStatus *next) {
+  next->version += 1;
+  next->updated_at_ms = NowMs();
+  std::atomic_store(
+      &snapshot_,
+      std::shared_ptr<const StreamerStatus>{
+          std::make_shared<StreamerStatus>(std::move(*next))});
+}
+}  // namespace ncstreamer_remote
@@ -0,0 +1,67 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_SRC_STREAMER_STATUS_CACHE_H_
+#define NCSTREAMER_REMOTE_DLL_SRC_STREAMER_STATUS_CACHE_H_
+
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "ncstreamer_remote_dll/include/ncstreamer_remote/streamer_status.h"
+
+
+namespace ncstreamer_remote {
+/// Publishes immutable StreamerStatus snapshots.
+/// Updates come from the io thread only; Get may be called from any thread
+/// and only copies the current snapshot pointer.
+class StreamerStatusCache {
+ public:
+  StreamerStatusCache();
+  virtual ~StreamerStatusCache();
+
+  std::shared_ptr<const StreamerStatus> Get() const;
+
+  void OnStatusResponse(
+      const std::wstring &status,
+      const std::wstring &source_title,
+      const std::wstring &user_name,
+      const std::wstring &quality);
+  void OnStartEvent(
+      const std::wstring &source_title,
+      const std::wstring &stream_url,
+      const std::wstring &post_url);
+  /// Ignored if it is of another source than the streaming one.
+  void OnStopEvent(
+      const std::wstring &source_title);
+  /// Of a quality update NCStreamer has succeeded in.
+  /// Ignored while the status is unknown, which only a status response
+  /// makes known.
+  void OnQualityUpdated(
+      const std::wstring &quality);
+
+  /// Forgets the known status, e.g. on disconnect.
+  /// It is kept aside for RestoreLastKnown.
+  void Invalidate();
+
+  /// Brings back the status forgotten by Invalidate, if nothing newer has
+  /// been known since, e.g. once the missed events are replayed on resume.
+  bool RestoreLastKnown();
+
+  static std::int64_t NowMs();
+
+ private:
+  void Publish(StreamerStatus *next);
+
+  std::shared_ptr<const StreamerStatus> snapshot_;
+
+  /// Touched only on the io thread, like the updates.
+  std::shared_ptr<const StreamerStatus> last_known_;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_SRC_STREAMER_STATUS_CACHE_H_
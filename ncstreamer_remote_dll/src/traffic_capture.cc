@@ -0,0 +1,193 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_dll/src/traffic_capture.h"
+
+#include <cstring>
+#include <utility>
+
+#include "ncstreamer_remote_dll/src/stats_recorder.h"
+
+
+namespace {
+const char kMagic[] = "NCSRCAP1";
+const std::size_t kMagicSize = sizeof(kMagic) - 1;
+
+/// Sanity bound of a payload read back, against a broken file.
+const std::uint64_t kMaxPayloadSize = 64 * 1024 * 1024;
+}  // unnamed namespace
+
+
+namespace ncstreamer_remote {
+TrafficRecord::TrafficRecord()
+    : kind{Kind::kOpen},
+      time_ns{0},
+      payload{} {
+}
+
+
+TrafficRecord::TrafficRecord(TrafficRecord &&other)
+    : kind{other.kind},
+      time_ns{other.time_ns},
+      payload{std::move(other.payload)} {
+}
+
+
+TrafficRecord::~TrafficRecord() {
+}
+
+
+TrafficRecord &TrafficRecord::operator=(TrafficRecord &&other) {
+  kind = other.kind;
+  time_ns = other.time_ns;
+  payload = std::move(other.payload);
+  return *this;
+}
+
+
+TrafficCaptureWriter::TrafficCaptureWriter()
+    : open_{false},
+      mutex_{},
+      file_{},
+      start_ns_{0},
+      last_ns_{0} {
+}
+
+
+TrafficCaptureWriter::~TrafficCaptureWriter() {
+  Close();
+}
+
+
+bool TrafficCaptureWriter::Open(const std::string &path) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (file_.is_open() == true) {
+    file_.close();
+  }
+  file_.clear();
+  file_.open(path, std::ios::binary | std::ios::trunc);
+  if (file_.is_open() == false) {
+    open_ = false;
+    return false;
+  }
+
+  file_.write(kMagic, kMagicSize);
+  start_ns_ = StatsRecorder::NowNs();
+  last_ns_ = start_ns_;
+  open_ = true;
+  return true;
+}
+
+
+void TrafficCaptureWriter::Close() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  open_ = false;
+  if (file_.is_open() == true) {
+    file_.close();
+  }
+}
+
+
+void TrafficCaptureWriter::Write(
+    TrafficRecord::Kind kind,
+    const std::string &payload) {
+  if (open_ == false) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (open_ == false) {
+    return;  // closed meanwhile.
+  }
+  // taken under the lock, so that the times never go backwards.
+  std::int64_t now_ns = StatsRecorder::NowNs();
+  std::int64_t delta_ns = now_ns > last_ns_ ? now_ns - last_ns_ : 0;
+  last_ns_ += delta_ns;
+
+  file_.put(static_cast<char>(kind));
+  WriteVarint(static_cast<std::uint64_t>(delta_ns));
+  WriteVarint(payload.size());
+  file_.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+}
+
+
+void TrafficCaptureWriter::WriteVarint(std::uint64_t value) {
+  while (value >= 0x80) {
+    file_.put(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  file_.put(static_cast<char>(value));
+}
+
+
+TrafficCaptureReader::TrafficCaptureReader()
+    : file_{},
+      time_ns_{0} {
+}
+
+
+TrafficCaptureReader::~TrafficCaptureReader() {
+}
+
+
+bool TrafficCaptureReader::Open(const std::string &path) {
+  file_.open(path, std::ios::binary);
+  if (file_.is_open() == false) {
+    return false;
+  }
+
+  char magic[kMagicSize]{};
+  file_.read(magic, kMagicSize);
+  time_ns_ = 0;
+  return file_.gcount() == static_cast<std::streamsize>(kMagicSize) &&
+         std::memcmp(magic, kMagic, kMagicSize) == 0;
+}
+
+
+bool TrafficCaptureReader::Read(TrafficRecord *record) {
+  int kind = file_.get();
+  if (kind < static_cast<int>(TrafficRecord::Kind::kInboundText) ||
+      kind > static_cast<int>(TrafficRecord::Kind::kClose)) {
+    return false;  // the end of the file, or a broken record.
+  }
+
+  std::uint64_t delta_ns{0};
+  std::uint64_t size{0};
+  if (ReadVarint(&delta_ns) == false ||
+      ReadVarint(&size) == false ||
+      size > kMaxPayloadSize) {
+    return false;
+  }
+
+  record->payload.resize(static_cast<std::size_t>(size));
+  if (size > 0) {
+    file_.read(&record->payload[0], static_cast<std::streamsize>(size));
+    if (file_.gcount() != static_cast<std::streamsize>(size)) {
+      return false;
+    }
+  }
+
+  time_ns_ += static_cast<std::int64_t>(delta_ns);
+  record->kind = static_cast<TrafficRecord::Kind>(kind);
+  record->time_ns = time_ns_;
+  return true;
+}
+
+
+bool TrafficCaptureReader::ReadVarint(std::uint64_t *value) {
+  *value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int byte = file_.get();
+    if (byte == std::char_traits<char>::eof()) {
+      return false;
+    }
+    *value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace ncstreamer_remote
@@ -0,0 +1,97 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_DLL_SRC_TRAFFIC_CAPTURE_H_
+#define NCSTREAMER_REMOTE_DLL_SRC_TRAFFIC_CAPTURE_H_
+
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>  // NOLINT
+#include <string>
+
+
+namespace ncstreamer_remote {
+/// One record of a capture of the wire traffic.
+class TrafficRecord {
+ public:
+  enum class Kind {
+    kInboundText = 1,
+    kInboundBinary,
+    kOutboundText,
+    kOutboundBinary,
+    kOpen,
+    kFail,
+    kClose,
+  };
+
+  TrafficRecord();
+  TrafficRecord(TrafficRecord &&other);
+  virtual ~TrafficRecord();
+
+  TrafficRecord &operator=(TrafficRecord &&other);
+
+  Kind kind;
+
+  /// Steady clock nanoseconds since the capture started.
+  std::int64_t time_ns;
+
+  /// Frame payload, empty for the connection events.
+  std::string payload;
+};
+
+
+/// Appends records to a capture file, from any thread.
+/// The file starts with a magic, followed by the records, each of which is
+/// the kind in a byte, the nanoseconds since the previous record and
+/// the payload size as varints, and the payload.
+class TrafficCaptureWriter {
+ public:
+  TrafficCaptureWriter();
+  virtual ~TrafficCaptureWriter();
+
+  /// Replaces the file of the capture going on, if any.
+  bool Open(const std::string &path);
+  void Close();
+
+  /// Costs a single atomic load while no capture goes on.
+  void Write(
+      TrafficRecord::Kind kind,
+      const std::string &payload);
+
+ private:
+  void WriteVarint(std::uint64_t value);
+
+  std::atomic_bool open_;
+  std::mutex mutex_;
+  std::ofstream file_;
+  std::int64_t start_ns_;
+  std::int64_t last_ns_;
+};
+
+
+/// Reads a capture file of TrafficCaptureWriter.
+class TrafficCaptureReader {
+ public:
+  TrafficCaptureReader();
+  virtual ~TrafficCaptureReader();
+
+  /// @return False if the file is not a capture.
+  bool Open(const std::string &path);
+
+  /// @return False at the end of the file, or at a broken record.
+  bool Read(TrafficRecord *record);
+
+ private:
+  bool ReadVarint(std::uint64_t *value);
+
+  std::ifstream file_;
+  std::int64_t time_ns_;
+};
+}  // namespace ncstreamer_remote
+
+
+#endif  // NCSTREAMER_REMOTE_DLL_SRC_TRAFFIC_CAPTURE_H_
@@ -0,0 +1,598 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_load/src/load_generator.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <codecvt>
+#include <functional>
+#include <iomanip>
+#include <locale>
+#include <map>
+#include <queue>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "Windows.h"  // NOLINT
+#include "Psapi.h"  // NOLINT
+
+#include "ncstreamer_remote/ncstreamer_remote.h"
+
+#if _MSC_VER >= 1900
+namespace Chrono = std::chrono;
+#else
+#include "boost/chrono/include.hpp"
+namespace Chrono = boost::chrono;
+#endif  // _MSC_VER >= 1900
+
+
+namespace {
+using ncstreamer_remote::ErrorCategory;
+using ncstreamer_remote::NcStreamerRemote;
+using ncstreamer_remote_load::RequestKind;
+
+
+const std::size_t kRequestKindCount{
+    static_cast<std::size_t>(RequestKind::kRequestKindCount)};
+
+const wchar_t *const kSourceTitle{L"ncstreamer_remote_load"};
+const wchar_t *const kQualities[]{L"high", L"medium", L"low"};
+
+const std::uint32_t kWarmUpTimeoutMs{10000};
+const std::uint32_t kDrainTimeoutMs{5000};
+const std::uint32_t kCloseDeadlineMs{1000};
+
+
+const char *ToName(RequestKind kind) {
+  switch (kind) {
+    case RequestKind::kStatus: return "status";
+    case RequestKind::kStart: return "start";
+    case RequestKind::kStop: return "stop";
+    case RequestKind::kQualityUpdate: return "quality";
+    default: return "?";
+  }
+}
+
+
+/// Requests of one kind on one connection, or summed over many.
+class Tally {
+ public:
+  Tally()
+      : issued{0},
+        succeeded{0},
+        failed{0},
+        latencies_us{} {}
+
+  void Merge(const Tally &other) {
+    issued += other.issued;
+    succeeded += other.succeeded;
+    failed += other.failed;
+    latencies_us.insert(
+        latencies_us.end(),
+        other.latencies_us.begin(),
+        other.latencies_us.end());
+  }
+
+  std::uint64_t issued;
+  std::uint64_t succeeded;
+  std::uint64_t failed;
+
+  /// Of the requests answered, succeeded or not.
+  std::vector<std::uint32_t> latencies_us;
+};
+
+
+std::uint32_t Percentile(
+    const std::vector<std::uint32_t> &sorted,
+    std::size_t percent) {
+  if (sorted.empty() == true) {
+    return 0;
+  }
+  return sorted[(sorted.size() - 1) * percent / 100];
+}
+
+
+void WriteHeader(std::ostream *out, const char *first_column) {
+  *out << std::left << std::setw(10) << first_column << std::right
+       << std::setw(10) << "issued"
+       << std::setw(10) << "succeeded"
+       << std::setw(8) << "failed"
+       << std::setw(8) << "error%"
+       << std::setw(10) << "p50_us"
+       << std::setw(10) << "p90_us"
+       << std::setw(10) << "p99_us"
+       << std::setw(10) << "max_us" << std::endl;
+}
+
+
+void WriteRow(std::ostream *out, const std::string &name, Tally tally) {
+  std::sort(tally.latencies_us.begin(), tally.latencies_us.end());
+  double error_rate = (tally.issued != 0) ?
+      100.0 * static_cast<double>(tally.failed) / tally.issued : 0.0;
+  *out << std::left << std::setw(10) << name << std::right
+       << std::setw(10) << tally.issued
+       << std::setw(10) << tally.succeeded
+       << std::setw(8) << tally.failed
+       << std::setw(8) << std::fixed << std::setprecision(2) << error_rate
+       << std::setw(10) << Percentile(tally.latencies_us, 50)
+       << std::setw(10) << Percentile(tally.latencies_us, 90)
+       << std::setw(10) << Percentile(tally.latencies_us, 99)
+       << std::setw(10) << Percentile(tally.latencies_us, 100) << std::endl;
+}
+
+
+std::int64_t ToNs(const FILETIME &time) {
+  ULARGE_INTEGER value{};
+  value.LowPart = time.dwLowDateTime;
+  value.HighPart = time.dwHighDateTime;
+  return static_cast<std::int64_t>(value.QuadPart) * 100;
+}
+}  // unnamed namespace
+
+
+namespace ncstreamer_remote_load {
+class LoadGenerator::Connection {
+ public:
+  using ErrorKey = std::pair<ErrorCategory, int>;
+
+  struct ErrorCount {
+    std::uint64_t count;
+    std::wstring first_msg;
+  };
+
+  explicit Connection(std::unique_ptr<NcStreamerRemote> &&remote)
+      : remote_{std::move(remote)},
+        stats_{},
+        mutex_{},
+        tallies_{},
+        errors_{} {}
+
+  virtual ~Connection() {}
+
+  NcStreamerRemote *remote() { return remote_.get(); }
+
+  const ncstreamer_remote::RemoteStats &stats() const { return stats_; }
+
+  void CountIssued(RequestKind kind) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    ++tallies_[static_cast<std::size_t>(kind)].issued;
+  }
+
+  void CountCompleted(
+      RequestKind kind,
+      std::int64_t latency_ns,
+      bool succeeded,
+      ErrorCategory category,
+      int err_code,
+      const std::wstring &err_msg) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    Tally &tally = tallies_[static_cast<std::size_t>(kind)];
+    if (succeeded == true) {
+      ++tally.succeeded;
+    } else {
+      ++tally.failed;
+      ErrorCount &error = errors_[ErrorKey{category, err_code}];
+      if (error.count++ == 0) {
+        error.first_msg = err_msg;
+      }
+    }
+    tally.latencies_us.emplace_back(
+        static_cast<std::uint32_t>(latency_ns / 1000));
+  }
+
+  Tally GetTally(RequestKind kind) const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return tallies_[static_cast<std::size_t>(kind)];
+  }
+
+  std::map<ErrorKey, ErrorCount> GetErrors() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return errors_;
+  }
+
+  /// Keeps the tallies and the final stats of the library.
+  void Close() {
+    if (!remote_) {
+      return;
+    }
+    stats_ = remote_->GetStats();
+    remote_->Close(kCloseDeadlineMs, false);
+    remote_.reset();
+  }
+
+ private:
+  std::unique_ptr<NcStreamerRemote> remote_;
+  ncstreamer_remote::RemoteStats stats_;
+
+  mutable std::mutex mutex_;
+  Tally tallies_[kRequestKindCount];
+  std::map<ErrorKey, ErrorCount> errors_;
+};
+
+
+LoadGenerator::LoadGenerator(const LoadOptions &options)
+    : options_(options),
+      io_pool_{},
+      connections_{},
+      outstanding_{0},
+      outstanding_mutex_{},
+      outstanding_cv_{},
+      quality_seq_{0},
+      usage_before_connect_(),
+      usage_before_load_(),
+      usage_after_load_(),
+      load_elapsed_ns_{0},
+      drain_elapsed_ns_{0},
+      drained_{false},
+      warm_up_elapsed_ns_{0},
+      connected_count_{0} {
+  if (options_.io_thread_count != 0) {
+    io_pool_ = ncstreamer_remote::IoPool::Create(options_.io_thread_count);
+  }
+}
+
+
+LoadGenerator::~LoadGenerator() {
+  for (auto &connection : connections_) {
+    connection->Close();
+  }
+}
+
+
+bool LoadGenerator::Run(std::ostream *out) {
+  usage_before_connect_ = GetProcessUsage();
+  for (std::size_t i = 0; i < options_.connection_count; ++i) {
+    connections_.emplace_back(new Connection{
+        NcStreamerRemote::Create(options_.port, io_pool_)});
+  }
+
+  std::int64_t warm_up_begin_ns = NowNs();
+  connected_count_ = WarmUp();
+  warm_up_elapsed_ns_ = NowNs() - warm_up_begin_ns;
+
+  if (connected_count_ != 0) {
+    usage_before_load_ = GetProcessUsage();
+    std::int64_t load_begin_ns = NowNs();
+    Drive();
+    load_elapsed_ns_ = NowNs() - load_begin_ns;
+    usage_after_load_ = GetProcessUsage();
+
+    std::int64_t drain_begin_ns = NowNs();
+    drained_ = WaitForResponses(kDrainTimeoutMs);
+    drain_elapsed_ns_ = NowNs() - drain_begin_ns;
+  }
+
+  for (auto &connection : connections_) {
+    connection->Close();
+  }
+  Report(out);
+  return connected_count_ != 0;
+}
+
+
+std::size_t LoadGenerator::WarmUp() {
+  // a status request on each connection, answered once it is connected.
+  auto connected = std::make_shared<std::atomic<std::size_t>>(0);
+  for (auto &connection : connections_) {
+    ++outstanding_;
+    connection->remote()->RequestStatus(
+        NcStreamerRemote::UniqueErrorHandler{[this](
+            ErrorCategory /*category*/,
+            int /*err_code*/,
+            const std::wstring &/*err_msg*/) {
+          FinishResponse();
+        }},
+        NcStreamerRemote::UniqueStatusResponseHandler{[this, connected](
+            const std::wstring &/*status*/,
+            const std::wstring &/*source_title*/,
+            const std::wstring &/*user_name*/,
+            const std::wstring &/*quality*/) {
+          ++*connected;
+          FinishResponse();
+        }});
+  }
+  WaitForResponses(kWarmUpTimeoutMs);
+  return *connected;
+}
+
+
+void LoadGenerator::Drive() {
+  struct Due {
+    bool operator>(const Due &other) const {
+      return at_ns > other.at_ns;
+    }
+
+    std::int64_t at_ns;
+    std::int64_t interval_ns;
+    std::size_t connection;
+    RequestKind kind;
+  };
+
+  const std::int64_t begin_ns = NowNs();
+  const std::int64_t end_ns =
+      begin_ns + static_cast<std::int64_t>(options_.duration_s) * 1000000000;
+
+  std::priority_queue<Due, std::vector<Due>, std::greater<Due>> schedule{};
+  for (std::size_t k = 0; k < kRequestKindCount; ++k) {
+    double rate = options_.rates[k];
+    if (rate <= 0.0) {
+      continue;
+    }
+    std::int64_t interval_ns = static_cast<std::int64_t>(1e9 / rate);
+    if (interval_ns <= 0) {
+      interval_ns = 1;
+    }
+    for (std::size_t c = 0; c < connections_.size(); ++c) {
+      // spreads the connections over the interval, not to fire at once.
+      std::int64_t phase_ns = static_cast<std::int64_t>(
+          static_cast<double>(interval_ns) * c / connections_.size());
+      schedule.push(Due{
+          begin_ns + phase_ns, interval_ns, c, static_cast<RequestKind>(k)});
+    }
+  }
+
+  while (schedule.empty() == false) {
+    Due due = schedule.top();
+    if (due.at_ns >= end_ns) {
+      break;
+    }
+    schedule.pop();
+
+    std::int64_t wait_ns = due.at_ns - NowNs();
+    if (wait_ns > 0) {
+      std::this_thread::sleep_for(std::chrono::nanoseconds{wait_ns});
+    }
+    Issue(connections_[due.connection].get(), due.kind);
+
+    due.at_ns += due.interval_ns;
+    schedule.push(due);
+  }
+}
+
+
+void LoadGenerator::Issue(Connection *connection, RequestKind kind) {
+  const std::int64_t issued_ns = NowNs();
+  connection->CountIssued(kind);
+  ++outstanding_;
+
+  NcStreamerRemote::UniqueErrorHandler error_handler{
+      [this, connection, kind, issued_ns](
+          ErrorCategory category,
+          int err_code,
+          const std::wstring &err_msg) {
+    Complete(connection, kind, issued_ns, false, category, err_code, err_msg);
+  }};
+  auto success_handler = [this, connection, kind, issued_ns](bool success) {
+    Complete(
+        connection,
+        kind,
+        issued_ns,
+        success,
+        ErrorCategory::kNoCategory,
+        0,
+        std::wstring{});
+  };
+
+  NcStreamerRemote *remote = connection->remote();
+  switch (kind) {
+    case RequestKind::kStatus: {
+      remote->RequestStatus(
+          std::move(error_handler),
+          NcStreamerRemote::UniqueStatusResponseHandler{[success_handler](
+              const std::wstring &/*status*/,
+              const std::wstring &/*source_title*/,
+              const std::wstring &/*user_name*/,
+              const std::wstring &/*quality*/) {
+            success_handler(true);
+          }});
+      break;
+    }
+    case RequestKind::kStart: {
+      remote->RequestStart(
+          std::wstring{kSourceTitle},
+          std::move(error_handler),
+          NcStreamerRemote::UniqueStartResponseHandler{success_handler});
+      break;
+    }
+    case RequestKind::kStop: {
+      remote->RequestStop(
+          std::wstring{kSourceTitle},
+          std::move(error_handler),
+          NcStreamerRemote::UniqueStopResponseHandler{success_handler});
+      break;
+    }
+    case RequestKind::kQualityUpdate: {
+      std::size_t quality_index = static_cast<std::size_t>(
+          quality_seq_++ % (sizeof(kQualities) / sizeof(kQualities[0])));
+      remote->RequestQualityUpdate(
+          std::wstring{kQualities[quality_index]},
+          std::move(error_handler),
+          NcStreamerRemote::UniqueSuccessHandler{success_handler});
+      break;
+    }
+    default: {
+      FinishResponse();
+      break;
+    }
+  }
+}
+
+
+void LoadGenerator::Complete(
+    Connection *connection,
+    RequestKind kind,
+    std::int64_t issued_ns,
+    bool succeeded,
+    ErrorCategory category,
+    int err_code,
+    const std::wstring &err_msg) {
+  connection->CountCompleted(
+      kind, NowNs() - issued_ns, succeeded, category, err_code, err_msg);
+  FinishResponse();
+}
+
+
+void LoadGenerator::FinishResponse() {
+  if (--outstanding_ == 0) {
+    std::lock_guard<std::mutex> lock{outstanding_mutex_};
+    outstanding_cv_.notify_all();
+  }
+}
+
+
+bool LoadGenerator::WaitForResponses(std::uint32_t timeout_ms) {
+  std::unique_lock<std::mutex> lock{outstanding_mutex_};
+  return outstanding_cv_.wait_for(
+      lock,
+      std::chrono::milliseconds{timeout_ms},
+      [this]() {
+        return outstanding_ == 0;
+      });
+}
+
+
+void LoadGenerator::Report(std::ostream *out) const {
+  static const double kMiB{1024.0 * 1024.0};
+
+  *out << "connections: " << connections_.size()
+       << ", connected: " << connected_count_
+       << " in " << warm_up_elapsed_ns_ / 1000000 << " ms"
+       << ", io threads: ";
+  if (options_.io_thread_count != 0) {
+    *out << options_.io_thread_count << " shared";
+  } else {
+    *out << "one per connection";
+  }
+  *out << std::endl;
+  if (connected_count_ == 0) {
+    *out << "no connection to NCStreamer on port " << options_.port
+         << std::endl;
+    return;
+  }
+
+  std::int64_t memory_per_connection =
+      (static_cast<std::int64_t>(usage_before_load_.private_bytes) -
+       static_cast<std::int64_t>(usage_before_connect_.private_bytes)) /
+      static_cast<std::int64_t>(connections_.size());
+  *out << std::fixed << std::setprecision(1)
+       << "memory: " << usage_before_connect_.private_bytes / kMiB
+       << " MiB private before connecting, "
+       << memory_per_connection / 1024.0 << " KiB more per connection, "
+       << usage_after_load_.private_bytes / kMiB << " MiB after the load, "
+       << usage_after_load_.peak_working_set / kMiB
+       << " MiB peak working set" << std::endl;
+
+  std::vector<Tally> totals(kRequestKindCount);
+  Tally all{};
+  for (const auto &connection : connections_) {
+    for (std::size_t k = 0; k < kRequestKindCount; ++k) {
+      totals[k].Merge(connection->GetTally(static_cast<RequestKind>(k)));
+    }
+  }
+  for (const auto &total : totals) {
+    all.Merge(total);
+  }
+
+  std::int64_t cpu_ns = usage_after_load_.cpu_ns - usage_before_load_.cpu_ns;
+  double elapsed_s = load_elapsed_ns_ / 1e9;
+  *out << "cpu: " << cpu_ns / 1000000 << " ms over "
+       << std::setprecision(2) << elapsed_s << " s ("
+       << std::setprecision(1)
+       << (elapsed_s > 0.0 ? 100.0 * cpu_ns / load_elapsed_ns_ : 0.0)
+       << "% of a core), " << std::setprecision(1)
+       << (all.issued != 0 ? cpu_ns / 1000.0 / all.issued : 0.0)
+       << " us per request, "
+       << (elapsed_s > 0.0 ? all.issued / elapsed_s : 0.0)
+       << " requests/s" << std::endl;
+  *out << "drain: " << drain_elapsed_ns_ / 1000000 << " ms for the responses"
+       << " in flight at the end"
+       << (drained_ == true ? "" : ", timed out with some missing")
+       << std::endl << std::endl;
+
+  WriteHeader(out, "kind");
+  for (std::size_t k = 0; k < kRequestKindCount; ++k) {
+    if (totals[k].issued != 0) {
+      WriteRow(out, ToName(static_cast<RequestKind>(k)), totals[k]);
+    }
+  }
+  WriteRow(out, "all", all);
+  *out << std::endl;
+
+  WriteHeader(out, "conn");
+  std::map<Connection::ErrorKey, Connection::ErrorCount> errors{};
+  std::uint64_t rejected{0};
+  std::uint64_t queue_depth_max{0};
+  std::uint64_t io_task_latency_ns_max{0};
+  for (std::size_t c = 0; c < connections_.size(); ++c) {
+    const Connection &connection = *connections_[c];
+    Tally tally{};
+    for (std::size_t k = 0; k < kRequestKindCount; ++k) {
+      tally.Merge(connection.GetTally(static_cast<RequestKind>(k)));
+    }
+    WriteRow(out, std::to_string(c), tally);
+
+    for (const auto &error : connection.GetErrors()) {
+      Connection::ErrorCount &sum = errors[error.first];
+      if (sum.count == 0) {
+        sum.first_msg = error.second.first_msg;
+      }
+      sum.count += error.second.count;
+    }
+    const ncstreamer_remote::RemoteStats &stats = connection.stats();
+    rejected += stats.requests_rejected + stats.requests_dropped;
+    queue_depth_max = (std::max)(queue_depth_max, stats.queue_depth_max);
+    io_task_latency_ns_max =
+        (std::max)(io_task_latency_ns_max, stats.io_task_latency_ns_max);
+  }
+  *out << std::endl;
+
+  std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+  for (const auto &error : errors) {
+    *out << "error " << static_cast<int>(error.first.first) << "/"
+         << error.first.second << " x" << error.second.count << ": "
+         << converter.to_bytes(error.second.first_msg) << std::endl;
+  }
+  *out << "queue: " << rejected << " rejected or dropped, depth max "
+       << queue_depth_max << ", io task latency max "
+       << io_task_latency_ns_max / 1000 << " us" << std::endl;
+}
+
+
+std::int64_t LoadGenerator::NowNs() {
+  return Chrono::duration_cast<Chrono::nanoseconds>(
+      Chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+LoadGenerator::ProcessUsage LoadGenerator::GetProcessUsage() {
+  ProcessUsage usage{0, 0, 0, 0};
+  FILETIME creation_time{};
+  FILETIME exit_time{};
+  FILETIME kernel_time{};
+  FILETIME user_time{};
+  if (::GetProcessTimes(
+          ::GetCurrentProcess(),
+          &creation_time,
+          &exit_time,
+          &kernel_time,
+          &user_time) != FALSE) {
+    usage.cpu_ns = ToNs(kernel_time) + ToNs(user_time);
+  }
+
+  PROCESS_MEMORY_COUNTERS_EX counters{};
+  counters.cb = sizeof(counters);
+  if (::GetProcessMemoryInfo(
+          ::GetCurrentProcess(),
+          reinterpret_cast<PROCESS_MEMORY_COUNTERS *>(&counters),
+          sizeof(counters)) != FALSE) {
+    usage.working_set = counters.WorkingSetSize;
+    usage.peak_working_set = counters.PeakWorkingSetSize;
+    usage.private_bytes = counters.PrivateUsage;
+  }
+  return usage;
+}
+}  // namespace ncstreamer_remote_load
@@ -0,0 +1,116 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_LOAD_SRC_LOAD_GENERATOR_H_
+#define NCSTREAMER_REMOTE_LOAD_SRC_LOAD_GENERATOR_H_
+
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ncstreamer_remote/error/error_types.h"
+#include "ncstreamer_remote/io_pool.h"
+
+
+namespace ncstreamer_remote_load {
+enum class RequestKind {
+  kStatus = 0,
+  kStart,
+  kStop,
+  kQualityUpdate,
+  kRequestKindCount,
+};
+
+
+struct LoadOptions {
+  std::uint16_t port;
+  std::size_t connection_count;
+
+  /// Shared by all the connections. Zero gives each its own thread,
+  /// as NcStreamerRemote does by default.
+  std::size_t io_thread_count;
+
+  std::uint32_t duration_s;
+
+  /// Requests per second of each connection, indexed by RequestKind.
+  double rates[static_cast<int>(RequestKind::kRequestKindCount)];
+};
+
+
+/// Drives many NcStreamerRemote instances against one NCStreamer,
+/// each at the target rates whatever the responses take (open loop),
+/// and reports error rates and latency percentiles per connection,
+/// and the CPU and memory the process spends on them.
+class LoadGenerator {
+ public:
+  explicit LoadGenerator(const LoadOptions &options);
+  virtual ~LoadGenerator();
+
+  /// @return False if no connection is made.
+  bool Run(std::ostream *out);
+
+ private:
+  class Connection;
+
+  struct ProcessUsage {
+    std::int64_t cpu_ns;
+    std::uint64_t working_set;
+    std::uint64_t peak_working_set;
+    std::uint64_t private_bytes;
+  };
+
+  LoadGenerator(const LoadGenerator &) = delete;
+  LoadGenerator &operator=(const LoadGenerator &) = delete;
+
+  std::size_t WarmUp();
+  void Drive();
+  void Issue(Connection *connection, RequestKind kind);
+  void Complete(
+      Connection *connection,
+      RequestKind kind,
+      std::int64_t issued_ns,
+      bool succeeded,
+      ncstreamer_remote::ErrorCategory category,
+      int err_code,
+      const std::wstring &err_msg);
+  void FinishResponse();
+  bool WaitForResponses(std::uint32_t timeout_ms);
+  void Report(std::ostream *out) const;
+
+  static std::int64_t NowNs();
+  static ProcessUsage GetProcessUsage();
+
+  const LoadOptions options_;
+  std::shared_ptr<ncstreamer_remote::IoPool> io_pool_;
+  std::vector<std::unique_ptr<Connection>> connections_;
+
+  std::atomic<std::size_t> outstanding_;
+  std::mutex outstanding_mutex_;
+  std::condition_variable outstanding_cv_;
+  std::atomic<std::uint64_t> quality_seq_;
+
+  ProcessUsage usage_before_connect_;
+  ProcessUsage usage_before_load_;
+  ProcessUsage usage_after_load_;
+  std::int64_t load_elapsed_ns_;
+
+  /// The wait for the responses in flight once the load ends,
+  /// out of load_elapsed_ns_ and usage_after_load_.
+  std::int64_t drain_elapsed_ns_;
+  bool drained_;
+
+  std::int64_t warm_up_elapsed_ns_;
+  std::size_t connected_count_;
+};
+}  // namespace ncstreamer_remote_load
+
+
+#endif  // NCSTREAMER_REMOTE_LOAD_SRC_LOAD_GENERATOR_H_
@@ -0,0 +1,129 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "ncstreamer_remote_load/src/load_generator.h"
+#include "ncstreamer_remote_load/src/mock_process.h"
+
+
+namespace {
+using ncstreamer_remote_load::LoadOptions;
+using ncstreamer_remote_load::RequestKind;
+
+
+void PrintUsage() {
+  std::cerr
+      << "usage: ncstreamer_remote_load [options]" << std::endl
+      << "  --port=N         port of NCStreamer (9002)" << std::endl
+      << "  --connections=N  concurrent connections (10)" << std::endl
+      << "  --io-threads=N   io threads shared by the connections,"
+      << " 0 for one each (2)" << std::endl
+      << "  --duration=S     seconds of load (10)" << std::endl
+      << "  --status=R       status requests/s per connection (10)"
+      << std::endl
+      << "  --start=R        start requests/s per connection (0.2)"
+      << std::endl
+      << "  --stop=R         stop requests/s per connection (0.2)"
+      << std::endl
+      << "  --quality=R      quality updates/s per connection (1)"
+      << std::endl
+      << "  --mock           serves the port with a mock NCStreamer"
+      << " in a child process, to measure the client alone" << std::endl
+      << "  --serve-only     serves the port with a mock NCStreamer"
+      << " until the input closes, without any load" << std::endl;
+}
+
+
+double &RateOf(LoadOptions *options, RequestKind kind) {
+  return options->rates[static_cast<int>(kind)];
+}
+
+
+/// @return False on an unknown option or a bad value.
+bool ParseOption(
+    const std::string &arg,
+    LoadOptions *options,
+    bool *mock,
+    bool *serve_only) {
+  if (arg == "--mock") {
+    *mock = true;
+    return true;
+  }
+  if (arg == "--serve-only") {
+    *serve_only = true;
+    return true;
+  }
+  std::size_t equal = arg.find('=');
+  if (equal == std::string::npos) {
+    return false;
+  }
+  const std::string &key = arg.substr(0, equal);
+  const std::string &value = arg.substr(equal + 1);
+  try {
+    if (key == "--port") {
+      options->port = static_cast<std::uint16_t>(std::stoul(value));
+    } else if (key == "--connections") {
+      options->connection_count = std::stoul(value);
+    } else if (key == "--io-threads") {
+      options->io_thread_count = std::stoul(value);
+    } else if (key == "--duration") {
+      options->duration_s = static_cast<std::uint32_t>(std::stoul(value));
+    } else if (key == "--status") {
+      RateOf(options, RequestKind::kStatus) = std::stod(value);
+    } else if (key == "--start") {
+      RateOf(options, RequestKind::kStart) = std::stod(value);
+    } else if (key == "--stop") {
+      RateOf(options, RequestKind::kStop) = std::stod(value);
+    } else if (key == "--quality") {
+      RateOf(options, RequestKind::kQualityUpdate) = std::stod(value);
+    } else {
+      return false;
+    }
+  } catch (const std::exception &/*e*/) {
+    return false;
+  }
+  return true;
+}
+}  // unnamed namespace
+
+
+int main(int argc, char *argv[]) {
+  LoadOptions options{9002, 10, 2, 10, {10.0, 0.2, 0.2, 1.0}};
+  bool mock{false};
+  bool serve_only{false};
+  for (int i = 1; i < argc; ++i) {
+    if (ParseOption(argv[i], &options, &mock, &serve_only) == false) {
+      PrintUsage();
+      return EXIT_FAILURE;
+    }
+  }
+  if (serve_only == true) {
+    return ncstreamer_remote_load::MockProcess::Serve(options.port);
+  }
+  if (options.connection_count == 0) {
+    PrintUsage();
+    return EXIT_FAILURE;
+  }
+
+  ncstreamer_remote_load::MockProcess mock_process{};
+  if (mock == true && mock_process.Start(options.port) == false) {
+    std::cerr << "mock server failed on port " << options.port << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  bool connected{false};
+  {
+    ncstreamer_remote_load::LoadGenerator load_generator{options};
+    connected = load_generator.Run(&std::cout);
+  }
+  if (mock == true) {
+    std::cout << mock_process.Stop();
+  }
+  return connected ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,180 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_load/src/mock_process.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "ncstreamer_remote_load/src/mock_server.h"
+
+
+namespace {
+/// The first line of the child, once it serves the port.
+const char *const kServingLine{"serving"};
+
+const DWORD kExitTimeoutMs{5000};
+
+
+void CloseHandleOnce(HANDLE *handle) {
+  if (*handle != NULL) {
+    ::CloseHandle(*handle);
+    *handle = NULL;
+  }
+}
+}  // unnamed namespace
+
+
+namespace ncstreamer_remote_load {
+MockProcess::MockProcess()
+    : process_(),
+      input_write_{NULL},
+      output_read_{NULL},
+      output_{} {
+}
+
+
+MockProcess::~MockProcess() {
+  Stop();
+}
+
+
+bool MockProcess::Start(std::uint16_t port) {
+  SECURITY_ATTRIBUTES inheritable{};
+  inheritable.nLength = sizeof(inheritable);
+  inheritable.bInheritHandle = TRUE;
+
+  HANDLE input_read{NULL};
+  HANDLE output_write{NULL};
+  if (::CreatePipe(&input_read, &input_write_, &inheritable, 0) == FALSE) {
+    return false;
+  }
+  if (::CreatePipe(&output_read_, &output_write, &inheritable, 0) == FALSE) {
+    ::CloseHandle(input_read);
+    Close();
+    return false;
+  }
+  // only the ends of the child are inherited.
+  ::SetHandleInformation(input_write_, HANDLE_FLAG_INHERIT, 0);
+  ::SetHandleInformation(output_read_, HANDLE_FLAG_INHERIT, 0);
+
+  char path[MAX_PATH]{};
+  ::GetModuleFileNameA(NULL, path, MAX_PATH);
+  std::string command{"\"" + std::string{path} + "\" --serve-only --port=" +
+                      std::to_string(port)};
+  std::vector<char> command_line{command.begin(), command.end()};
+  command_line.emplace_back('\0');
+
+  STARTUPINFOA startup_info{};
+  startup_info.cb = sizeof(startup_info);
+  startup_info.dwFlags = STARTF_USESTDHANDLES;
+  startup_info.hStdInput = input_read;
+  startup_info.hStdOutput = output_write;
+  startup_info.hStdError = ::GetStdHandle(STD_ERROR_HANDLE);
+
+  BOOL created = ::CreateProcessA(
+      NULL,
+      command_line.data(),
+      NULL,
+      NULL,
+      TRUE,
+      0,
+      NULL,
+      NULL,
+      &startup_info,
+      &process_);
+  // the child holds its own copies, if any.
+  ::CloseHandle(input_read);
+  ::CloseHandle(output_write);
+  if (created == FALSE) {
+    process_ = PROCESS_INFORMATION();
+    Close();
+    return false;
+  }
+
+  std::string line{};
+  if (ReadLine(&line) == false || line.find(kServingLine) != 0) {
+    Stop();
+    return false;
+  }
+  return true;
+}
+
+
+std::string MockProcess::Stop() {
+  if (process_.hProcess == NULL) {
+    return std::string{};
+  }
+
+  CloseHandleOnce(&input_write_);  // tells the child to stop.
+  std::string last_output{};
+  std::string line{};
+  while (ReadLine(&line) == true) {
+    last_output += line + "\n";
+  }
+  if (::WaitForSingleObject(process_.hProcess, kExitTimeoutMs) !=
+      WAIT_OBJECT_0) {
+    ::TerminateProcess(process_.hProcess, EXIT_FAILURE);
+  }
+  Close();
+  return last_output;
+}
+
+
+int MockProcess::Serve(std::uint16_t port) {
+  MockServer mock_server{};
+  if (mock_server.Start(port) == false) {
+    std::cerr << "mock server failed on port " << port << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << kServingLine << " on port " << port << std::endl;
+
+  std::string line{};
+  while (std::getline(std::cin, line)) {
+    // until the input closes.
+  }
+
+  mock_server.Stop();
+  std::cout << "mock server: " << mock_server.GetRequestCount()
+            << " messages" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+
+bool MockProcess::ReadLine(std::string *line) {
+  line->clear();
+  while (true) {
+    std::size_t end = output_.find('\n');
+    if (end != std::string::npos) {
+      line->assign(output_, 0, end);
+      output_.erase(0, end + 1);
+      if (line->empty() == false && line->back() == '\r') {
+        line->pop_back();
+      }
+      return true;
+    }
+
+    char buffer[256];
+    DWORD read{0};
+    if (output_read_ == NULL ||
+        ::ReadFile(output_read_, buffer, sizeof(buffer), &read, NULL) ==
+            FALSE ||
+        read == 0) {
+      line->swap(output_);  // the rest, without a line break.
+      return line->empty() == false;
+    }
+    output_.append(buffer, read);
+  }
+}
+
+
+void MockProcess::Close() {
+  CloseHandleOnce(&input_write_);
+  CloseHandleOnce(&output_read_);
+  CloseHandleOnce(&process_.hThread);
+  CloseHandleOnce(&process_.hProcess);
+}
+}  // namespace ncstreamer_remote_load
@@ -0,0 +1,54 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_LOAD_SRC_MOCK_PROCESS_H_
+#define NCSTREAMER_REMOTE_LOAD_SRC_MOCK_PROCESS_H_
+
+
+#include <cstdint>
+#include <string>
+
+#include "Windows.h"  // NOLINT
+
+
+namespace ncstreamer_remote_load {
+/// Runs the MockServer in a child process of this executable, started
+/// with --serve-only, so that the CPU and the memory it takes aren't
+/// counted as the client's. The child serves until its standard input
+/// closes, and talks back through its standard output.
+class MockProcess {
+ public:
+  MockProcess();
+  virtual ~MockProcess();
+
+  /// @return False if the child fails to serve the port.
+  bool Start(std::uint16_t port);
+
+  /// Stops the child, and waits for it to exit.
+  /// @return The last output of the child, e.g. its message count.
+  std::string Stop();
+
+  /// The body of --serve-only, in the child.
+  /// @return The exit code of the child.
+  static int Serve(std::uint16_t port);
+
+ private:
+  MockProcess(const MockProcess &) = delete;
+  MockProcess &operator=(const MockProcess &) = delete;
+
+  /// @return False at the end of the output.
+  bool ReadLine(std::string *line);
+
+  void Close();
+
+  PROCESS_INFORMATION process_;
+  HANDLE input_write_;
+  HANDLE output_read_;
+  std::string output_;
+};
+}  // namespace ncstreamer_remote_load
+
+
+#endif  // NCSTREAMER_REMOTE_LOAD_SRC_MOCK_PROCESS_H_
@@ -0,0 +1,186 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_load/src/mock_server.h"
+
+#include <sstream>
+
+#include "boost/property_tree/json_parser.hpp"
+#include "boost/property_tree/ptree.hpp"
+
+#include "ncstreamer_remote_dll/src/ncstreamer_remote_message_types.h"
+
+
+namespace {
+using MessageType = ncstreamer::RemoteMessage::MessageType;
+
+
+boost::property_tree::ptree ToResponse(MessageType msg_type) {
+  boost::property_tree::ptree response;
+  response.put("type", static_cast<int>(msg_type));
+  return response;
+}
+
+
+boost::property_tree::ptree ToSuccessResponse(MessageType msg_type) {
+  boost::property_tree::ptree response = ToResponse(msg_type);
+  response.put("error", "");
+  return response;
+}
+}  // unnamed namespace
+
+
+namespace ncstreamer_remote_load {
+MockServer::MockServer()
+    : server_{},
+      server_thread_{},
+      window_{NULL},
+      request_count_{0},
+      on_air_{false},
+      source_title_{},
+      quality_{"medium"} {
+  server_.clear_access_channels(websocketpp::log::alevel::all);
+  server_.clear_error_channels(websocketpp::log::elevel::all);
+}
+
+
+MockServer::~MockServer() {
+  Stop();
+}
+
+
+bool MockServer::Start(std::uint16_t port) {
+  window_ = ::CreateWindowEx(
+      0,
+      L"STATIC",
+      ncstreamer::kNcStreamerWindowTitle,
+      0,  // never shown.
+      0,
+      0,
+      0,
+      0,
+      NULL,
+      NULL,
+      ::GetModuleHandle(NULL),
+      NULL);
+  if (window_ == NULL) {
+    return false;
+  }
+
+  websocketpp::lib::error_code ec;
+  server_.init_asio(ec);
+  if (ec) {
+    return false;
+  }
+  server_.set_reuse_addr(true);
+  server_.set_message_handler([this](
+      websocketpp::connection_hdl connection,
+      AsioServer::message_ptr msg) {
+    OnMessage(connection, msg);
+  });
+
+  server_.listen(boost::asio::ip::tcp::endpoint{
+      boost::asio::ip::address_v4::loopback(), port}, ec);
+  if (ec) {
+    return false;
+  }
+  server_.start_accept(ec);
+  if (ec) {
+    return false;
+  }
+
+  server_thread_ = std::thread{[this]() {
+    server_.run();
+  }};
+  return true;
+}
+
+
+void MockServer::Stop() {
+  server_.stop();
+  if (server_thread_.joinable() == true) {
+    server_thread_.join();
+  }
+  if (window_ != NULL) {
+    ::DestroyWindow(window_);
+    window_ = NULL;
+  }
+}
+
+
+std::uint64_t MockServer::GetRequestCount() const {
+  return request_count_;
+}
+
+
+void MockServer::OnMessage(
+    websocketpp::connection_hdl connection,
+    AsioServer::message_ptr msg) {
+  ++request_count_;
+  const std::string &response = Respond(msg->get_payload());
+  if (response.empty() == true) {
+    return;
+  }
+  websocketpp::lib::error_code ec;
+  server_.send(connection, response, websocketpp::frame::opcode::text, ec);
+}
+
+
+std::string MockServer::Respond(const std::string &request) {
+  boost::property_tree::ptree tree;
+  MessageType msg_type{MessageType::kUndefined};
+  try {
+    std::stringstream ss{request};
+    boost::property_tree::read_json(ss, tree);
+    msg_type = static_cast<MessageType>(tree.get<int>("type"));
+  } catch (const std::exception &/*e*/) {
+    return std::string{};
+  }
+
+  boost::property_tree::ptree response;
+  switch (msg_type) {
+    case MessageType::kRemoteHandshakeRequest: {
+      // plain JSON, one request at a time.
+      response = ToResponse(MessageType::kRemoteHandshakeResponse);
+      response.put("version", ncstreamer::kRemoteProtocolVersion);
+      response.put("capabilities", "");
+      break;
+    }
+    case MessageType::kStreamingStatusRequest: {
+      response = ToResponse(MessageType::kStreamingStatusResponse);
+      response.put("status", on_air_ ? "onAir" : "standby");
+      response.put("sourceTitle", source_title_);
+      response.put("userName", "mock");
+      response.put("quality", quality_);
+      break;
+    }
+    case MessageType::kStreamingStartRequest: {
+      on_air_ = true;
+      source_title_ = tree.get<std::string>("title", std::string{});
+      response = ToSuccessResponse(MessageType::kStreamingStartResponse);
+      break;
+    }
+    case MessageType::kStreamingStopRequest: {
+      on_air_ = false;
+      source_title_.clear();
+      response = ToSuccessResponse(MessageType::kStreamingStopResponse);
+      break;
+    }
+    case MessageType::kSettingsQualityUpdateRequest: {
+      quality_ = tree.get<std::string>("quality", quality_);
+      response = ToSuccessResponse(
+          MessageType::kSettingsQualityUpdateResponse);
+      break;
+    }
+    default: {
+      return std::string{};
+    }
+  }
+
+  std::stringstream msg;
+  boost::property_tree::write_json(msg, response, false);
+  return msg.str();
+}
+}  // namespace ncstreamer_remote_load
@@ -0,0 +1,69 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_LOAD_SRC_MOCK_SERVER_H_
+#define NCSTREAMER_REMOTE_LOAD_SRC_MOCK_SERVER_H_
+
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "Windows.h"  // NOLINT
+
+#ifdef _MSC_VER
+#pragma warning(disable: 4267)
+#endif
+#include "websocketpp/config/asio_no_tls.hpp"
+#include "websocketpp/server.hpp"
+#ifdef _MSC_VER
+#pragma warning(default: 4267)
+#endif
+
+
+namespace ncstreamer_remote_load {
+/// Stands in for NCStreamer on a local port, and answers every request
+/// at once with success, so that the load measures the client side alone.
+/// Owns a hidden window of the title of NCStreamer, as the client looks
+/// for it before connecting.
+class MockServer {
+ public:
+  MockServer();
+  virtual ~MockServer();
+
+  /// Call Start and Stop on the same thread, as the window belongs to it.
+  bool Start(std::uint16_t port);
+  void Stop();
+
+  std::uint64_t GetRequestCount() const;
+
+ private:
+  using AsioServer = websocketpp::server<websocketpp::config::asio>;
+
+  MockServer(const MockServer &) = delete;
+  MockServer &operator=(const MockServer &) = delete;
+
+  void OnMessage(
+      websocketpp::connection_hdl connection,
+      AsioServer::message_ptr msg);
+
+  /// @return Empty if the request has no response.
+  std::string Respond(const std::string &request);
+
+  AsioServer server_;
+  std::thread server_thread_;
+  HWND window_;
+  std::atomic<std::uint64_t> request_count_;
+
+  /// Touched only on the server thread.
+  bool on_air_;
+  std::string source_title_;
+  std::string quality_;
+};
+}  // namespace ncstreamer_remote_load
+
+
+#endif  // NCSTREAMER_REMOTE_LOAD_SRC_MOCK_SERVER_H_
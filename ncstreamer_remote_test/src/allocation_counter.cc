@@ -0,0 +1,66 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_test/src/allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>  // NOLINT
+
+
+namespace {
+std::atomic_bool counting{false};
+std::thread::id counted_thread{};
+std::atomic<std::uint64_t> allocations{0};
+}  // namespace
+
+
+void *operator new(std::size_t size) {
+  ncstreamer_remote_test::AllocationCounter::Count();
+  void *block = std::malloc(size != 0 ? size : 1);
+  if (block == nullptr) {
+    throw std::bad_alloc{};
+  }
+  return block;
+}
+
+
+void *operator new[](std::size_t size) {
+  return ::operator new(size);
+}
+
+
+void operator delete(void *block) {
+  std::free(block);
+}
+
+
+void operator delete[](void *block) {
+  ::operator delete(block);
+}
+
+
+namespace ncstreamer_remote_test {
+void AllocationCounter::Start() {
+  counted_thread = std::this_thread::get_id();
+  allocations = 0;
+  counting.store(true, std::memory_order_release);
+}
+
+
+std::uint64_t AllocationCounter::Stop() {
+  counting.store(false, std::memory_order_release);
+  return allocations;
+}
+
+
+void AllocationCounter::Count() {
+  if (counting.load(std::memory_order_acquire) == true &&
+      std::this_thread::get_id() == counted_thread) {
+    ++allocations;
+  }
+}
+}  // namespace ncstreamer_remote_test
@@ -0,0 +1,31 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_TEST_SRC_ALLOCATION_COUNTER_H_
+#define NCSTREAMER_REMOTE_TEST_SRC_ALLOCATION_COUNTER_H_
+
+
+#include <cstdint>
+
+
+namespace ncstreamer_remote_test {
+/// Counts the heap allocations of one thread, through the global
+/// operator new of this executable. As the sources of the dll are built
+/// into this executable, their allocations are counted as well.
+class AllocationCounter {
+ public:
+  /// Starts counting the allocations of the calling thread.
+  static void Start();
+
+  /// @return The allocations of the counted thread since Start.
+  static std::uint64_t Stop();
+
+  /// Called by the global operator new, on any thread.
+  static void Count();
+};
+}  // namespace ncstreamer_remote_test
+
+
+#endif  // NCSTREAMER_REMOTE_TEST_SRC_ALLOCATION_COUNTER_H_
@@ -0,0 +1,357 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_test/src/allocation_test.h"
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ncstreamer_remote/io_pool.h"
+#include "ncstreamer_remote/ncstreamer_remote.h"
+#include "ncstreamer_remote/port_discovery.h"
+
+#include "ncstreamer_remote_dll/src/request_payload_cache.h"
+#include "ncstreamer_remote_dll/src/stats_recorder.h"
+#include "ncstreamer_remote_test/src/allocation_counter.h"
+
+
+namespace {
+using ncstreamer_remote::BatchItem;
+using ncstreamer_remote::ErrorCategory;
+using ncstreamer_remote::IoPool;
+using ncstreamer_remote::NcStreamerRemote;
+using ncstreamer_remote::PortDiscovery;
+using ncstreamer_remote::RequestPayloadCache;
+using ncstreamer_remote::StatsRecorder;
+using ncstreamer_remote_test::AllocationCounter;
+
+
+const int kWarmUpRounds{4};
+const int kMeasuredRounds{16};
+
+
+/// Set by the handlers of a request, on the thread polling the io pool.
+class Completion {
+ public:
+  Completion()
+      : done_{false} {}
+
+  void Reset() {
+    done_ = false;
+  }
+
+  void Set() {
+    done_ = true;
+  }
+
+  bool done() const { return done_; }
+
+ private:
+  bool done_;
+};
+
+
+void PollAll(IoPool *io_pool) {
+  while (io_pool->Poll() != 0) {
+    // the handlers may post more.
+  }
+}
+
+
+NcStreamerRemote::UniqueErrorHandler ToErrorHandler(Completion *completion) {
+  return NcStreamerRemote::UniqueErrorHandler{[completion](
+      ErrorCategory /*category*/,
+      int /*err_code*/,
+      const std::wstring & /*err_msg*/) {
+    completion->Set();
+  }};
+}
+
+
+NcStreamerRemote::UniqueSuccessHandler ToSuccessHandler(
+    Completion *completion) {
+  return NcStreamerRemote::UniqueSuccessHandler{[completion](
+      bool /*success*/) {
+    completion->Set();
+  }};
+}
+
+
+NcStreamerRemote::UniqueStatusResponseHandler ToStatusResponseHandler(
+    Completion *completion) {
+  return NcStreamerRemote::UniqueStatusResponseHandler{[completion](
+      const std::wstring & /*status*/,
+      const std::wstring & /*source_title*/,
+      const std::wstring & /*user_name*/,
+      const std::wstring & /*quality*/) {
+    completion->Set();
+  }};
+}
+
+
+/// Submits a request a few times to warm up, and then counts
+/// the allocations while submitting more, and while polling the io pool
+/// on the same thread until the request completes. So the count covers
+/// both the caller's half of the submit path and the io thread's half.
+/// @param prepare Makes the argument of submit, out of the count.
+/// @return Whether no allocation is counted.
+template <typename Prepare, typename Submit>
+bool CheckNoAllocation(
+    const char *name,
+    NcStreamerRemote *remote,
+    IoPool *io_pool,
+    const Prepare &prepare,
+    const Submit &submit) {
+  Completion completion{};
+  std::uint64_t allocations{0};
+  for (int i = 0; i < kWarmUpRounds + kMeasuredRounds; ++i) {
+    auto arg = prepare();
+    completion.Reset();
+
+    bool measured = (i >= kWarmUpRounds);
+    if (measured == true) {
+      AllocationCounter::Start();
+    }
+    submit(remote, &completion, std::move(arg));
+    PollAll(io_pool);
+    if (measured == true) {
+      allocations += AllocationCounter::Stop();
+    }
+
+    if (completion.done() == false) {
+      std::cerr << name << ": not completed" << std::endl;
+      return false;
+    }
+  }
+
+  if (allocations != 0) {
+    std::cerr << name << ": " << allocations
+              << " allocations on the caller's and the io thread in "
+              << kMeasuredRounds << " requests" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+/// Gets a cached payload a few times to warm up, and then counts
+/// the allocations while getting it again.
+/// @return Whether no allocation is counted.
+template <typename Get>
+bool CheckNoEncodingAllocation(
+    const char *name,
+    RequestPayloadCache *payload_cache,
+    const Get &get) {
+  std::uint64_t allocations{0};
+  for (int i = 0; i < kWarmUpRounds + kMeasuredRounds; ++i) {
+    bool measured = (i >= kWarmUpRounds);
+    if (measured == true) {
+      AllocationCounter::Start();
+    }
+    const std::string &payload = get(payload_cache);
+    if (measured == true) {
+      allocations += AllocationCounter::Stop();
+    }
+
+    if (payload.empty() == true) {
+      std::cerr << name << ": empty payload" << std::endl;
+      return false;
+    }
+  }
+
+  if (allocations != 0) {
+    std::cerr << name << ": " << allocations
+              << " allocations in encoding " << kMeasuredRounds
+              << " requests" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+int PrepareNothing() {
+  return 0;
+}
+
+
+std::wstring PrepareTitle() {
+  return L"title";  // short enough for the small string buffer.
+}
+
+
+std::vector<BatchItem> PrepareBatch() {
+  std::vector<BatchItem> items{};
+  items.emplace_back(BatchItem{BatchItem::Type::kQualityUpdate, L"high"});
+  items.emplace_back(BatchItem{BatchItem::Type::kStart, L"title"});
+  return items;
+}
+
+
+void SubmitStatus(
+    NcStreamerRemote *remote,
+    Completion *completion,
+    int /*nothing*/) {
+  remote->RequestStatus(
+      ToErrorHandler(completion),
+      ToStatusResponseHandler(completion));
+}
+
+
+void SubmitStart(
+    NcStreamerRemote *remote,
+    Completion *completion,
+    std::wstring &&title) {
+  remote->RequestStart(
+      std::move(title),
+      ToErrorHandler(completion),
+      ToSuccessHandler(completion));
+}
+
+
+void SubmitStop(
+    NcStreamerRemote *remote,
+    Completion *completion,
+    std::wstring &&title) {
+  remote->RequestStop(
+      std::move(title),
+      ToErrorHandler(completion),
+      ToSuccessHandler(completion));
+}
+
+
+void SubmitQualityUpdate(
+    NcStreamerRemote *remote,
+    Completion *completion,
+    std::wstring &&quality) {
+  remote->RequestQualityUpdate(
+      std::move(quality),
+      ToErrorHandler(completion),
+      ToSuccessHandler(completion));
+}
+
+
+void SubmitExit(
+    NcStreamerRemote *remote,
+    Completion *completion,
+    int /*nothing*/) {
+  remote->RequestExit(ToErrorHandler(completion));
+}
+
+
+void SubmitBatch(
+    NcStreamerRemote *remote,
+    Completion *completion,
+    std::vector<BatchItem> &&items) {
+  remote->RequestBatch(
+      std::move(items),
+      ToErrorHandler(completion),
+      NcStreamerRemote::UniqueBatchResponseHandler{[completion](
+          const std::vector<ncstreamer_remote::BatchResult> & /*results*/) {
+        completion->Set();
+      }});
+}
+
+
+const std::string &GetStatusPayload(RequestPayloadCache *payload_cache) {
+  return payload_cache->GetStatusRequest();
+}
+
+
+const std::string &GetStartPayload(RequestPayloadCache *payload_cache) {
+  static const std::wstring kTitle{L"title"};  // made while warming up.
+  return payload_cache->GetStartRequest(kTitle);
+}
+
+
+const std::string &GetStopPayload(RequestPayloadCache *payload_cache) {
+  static const std::wstring kTitle{L"title"};  // made while warming up.
+  return payload_cache->GetStopRequest(kTitle);
+}
+
+
+const std::string &GetExitPayload(RequestPayloadCache *payload_cache) {
+  return payload_cache->GetExitRequest();
+}
+
+
+/// Checks the payloads the io thread sends as they are cached,
+/// in either encoding.
+bool CheckNoEncodingAllocations() {
+  StatsRecorder stats{};
+  RequestPayloadCache payload_cache{&stats};
+
+  bool passed{true};
+  const RequestPayloadCache::Encoding kEncodings[]{
+      RequestPayloadCache::Encoding::kJson,
+      RequestPayloadCache::Encoding::kMsgpack};
+  for (RequestPayloadCache::Encoding encoding : kEncodings) {
+    payload_cache.SetEncoding(encoding);
+    if (CheckNoEncodingAllocation(
+        "status payload", &payload_cache, GetStatusPayload) == false) {
+      passed = false;
+    }
+    if (CheckNoEncodingAllocation(
+        "start payload", &payload_cache, GetStartPayload) == false) {
+      passed = false;
+    }
+    if (CheckNoEncodingAllocation(
+        "stop payload", &payload_cache, GetStopPayload) == false) {
+      passed = false;
+    }
+    if (CheckNoEncodingAllocation(
+        "exit payload", &payload_cache, GetExitPayload) == false) {
+      passed = false;
+    }
+  }
+  return passed;
+}
+}  // namespace
+
+
+namespace ncstreamer_remote_test {
+bool TestSubmitAllocations() {
+  // polled on this thread, to count the io thread's half as well.
+  std::shared_ptr<IoPool> io_pool{IoPool::CreateManual()};
+  // no ports, so every request fails at once on the io thread
+  // with Error::Connection::kNoNcStreamer, without a socket or a timer.
+  std::unique_ptr<NcStreamerRemote> remote{
+      NcStreamerRemote::Create(PortDiscovery{}, io_pool)};
+  PollAll(io_pool.get());
+
+  bool passed{true};
+  if (CheckNoAllocation("status", remote.get(), io_pool.get(),
+                        PrepareNothing, SubmitStatus) == false) {
+    passed = false;
+  }
+  if (CheckNoAllocation("start", remote.get(), io_pool.get(),
+                        PrepareTitle, SubmitStart) == false) {
+    passed = false;
+  }
+  if (CheckNoAllocation("stop", remote.get(), io_pool.get(),
+                        PrepareTitle, SubmitStop) == false) {
+    passed = false;
+  }
+  if (CheckNoAllocation("quality", remote.get(), io_pool.get(),
+                        PrepareTitle, SubmitQualityUpdate) == false) {
+    passed = false;
+  }
+  if (CheckNoAllocation("exit", remote.get(), io_pool.get(),
+                        PrepareNothing, SubmitExit) == false) {
+    passed = false;
+  }
+  if (CheckNoAllocation("batch", remote.get(), io_pool.get(),
+                        PrepareBatch, SubmitBatch) == false) {
+    passed = false;
+  }
+  if (CheckNoEncodingAllocations() == false) {
+    passed = false;
+  }
+  return passed;
+}
+}  // namespace ncstreamer_remote_test
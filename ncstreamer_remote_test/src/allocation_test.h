@@ -0,0 +1,22 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_TEST_SRC_ALLOCATION_TEST_H_
+#define NCSTREAMER_REMOTE_TEST_SRC_ALLOCATION_TEST_H_
+
+
+namespace ncstreamer_remote_test {
+/// Checks that every kind of request, made through the overloads taking
+/// rvalues with small handlers and short strings, doesn't allocate once
+/// warm, on the caller's thread nor on the io thread, which is polled on
+/// the same thread. As the instance is offline, the io thread fails the
+/// requests instead of sending them, so the cached payloads it would
+/// send are checked on their own.
+/// @return Whether it passes.
+bool TestSubmitAllocations();
+}  // namespace ncstreamer_remote_test
+
+
+#endif  // NCSTREAMER_REMOTE_TEST_SRC_ALLOCATION_TEST_H_
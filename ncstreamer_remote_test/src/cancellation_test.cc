@@ -0,0 +1,148 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_test/src/cancellation_test.h"
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "ncstreamer_remote/cancellation_token.h"
+#include "ncstreamer_remote/io_pool.h"
+#include "ncstreamer_remote/ncstreamer_remote.h"
+#include "ncstreamer_remote/port_discovery.h"
+#include "ncstreamer_remote/remote_future.h"
+#include "ncstreamer_remote/simulated_clock.h"
+
+
+namespace {
+using ncstreamer_remote::CancellationToken;
+using ncstreamer_remote::Error;
+using ncstreamer_remote::ErrorCategory;
+using ncstreamer_remote::IoPool;
+using ncstreamer_remote::NcStreamerRemote;
+using ncstreamer_remote::PortDiscovery;
+using ncstreamer_remote::RemoteError;
+using ncstreamer_remote::RemoteFuture;
+using ncstreamer_remote::SimulatedClock;
+
+
+/// Nothing listens on it, and the requests never get that far anyway.
+const std::uint16_t kIdlePort{59002};
+
+
+/// @return The condition, telling what is wrong if false.
+bool Expect(bool condition, const char *what) {
+  if (condition == false) {
+    std::cerr << "cancellation: " << what << std::endl;
+  }
+  return condition;
+}
+
+
+void PollAll(IoPool *io_pool) {
+  while (io_pool->Poll() != 0) {
+    // the handlers may post more.
+  }
+}
+
+
+bool IsCancelled(const RemoteError &error) {
+  return error.category == ErrorCategory::kConnection &&
+         error.err_code == static_cast<int>(Error::Connection::kCancelled);
+}
+
+
+/// Requests a stop with handlers holding the state, which must be
+/// released without either of them being called.
+void RequestStop(
+    NcStreamerRemote *remote,
+    const std::shared_ptr<int> &state,
+    bool *called,
+    const CancellationToken &cancellation_token) {
+  remote->RequestStop(
+      L"cancellation test",
+      [state, called](ErrorCategory, int, const std::wstring &) {
+        *called = true;
+      },
+      [state, called](bool) {
+        *called = true;
+      },
+      cancellation_token);
+}
+}  // namespace
+
+
+namespace ncstreamer_remote_test {
+bool TestCancellation() {
+  std::shared_ptr<IoPool> io_pool{IoPool::CreateManual()};
+  std::shared_ptr<SimulatedClock> clock{SimulatedClock::Create()};
+
+  PortDiscovery discovery{};
+  discovery.candidate_ports.emplace_back(kIdlePort);
+  std::unique_ptr<NcStreamerRemote> remote{
+      NcStreamerRemote::Create(discovery, io_pool, clock)};
+
+  bool ready{false};
+  remote->RegisterReadyHandler([&ready](bool success) {
+    ready = success;
+  });
+  PollAll(io_pool.get());
+  if (Expect(ready, "not set up") == false) {
+    return false;
+  }
+  std::uint64_t start_cancelled = remote->GetStats().requests_cancelled;
+
+  // queued, as the manual pool doesn't dispatch them until polled.
+  CancellationToken queued_token{CancellationToken::Create()};
+  std::shared_ptr<int> queued_state{std::make_shared<int>(0)};
+  bool queued_called{false};
+  RequestStop(remote.get(), queued_state, &queued_called, queued_token);
+  RemoteFuture<bool> queued_start{
+      remote->RequestStart(L"cancellation test", queued_token)};
+  RemoteFuture<bool> queued_quality{
+      remote->RequestQualityUpdate(L"720p", queued_token)};
+  if (Expect(queued_state.use_count() > 1, "stop handlers not held") == false ||
+      Expect(queued_start.IsReady() == false, "start not queued") == false) {
+    return false;
+  }
+
+  queued_token.Cancel();
+  PollAll(io_pool.get());
+  if (Expect(queued_state.use_count() == 1,
+             "queued handlers not released") == false ||
+      Expect(queued_called == false, "queued handler called") == false ||
+      Expect(queued_start.IsReady(), "queued start pending") == false ||
+      Expect(IsCancelled(queued_start.Get().error),
+             "queued start not cancelled") == false ||
+      Expect(queued_quality.IsReady(), "queued quality pending") == false ||
+      Expect(IsCancelled(queued_quality.Get().error),
+             "queued quality not cancelled") == false) {
+    return false;
+  }
+
+  // cancelled beforehand, so released on the caller's thread.
+  CancellationToken early_token{CancellationToken::Create()};
+  early_token.Cancel();
+  std::shared_ptr<int> early_state{std::make_shared<int>(0)};
+  bool early_called{false};
+  RequestStop(remote.get(), early_state, &early_called, early_token);
+  RemoteFuture<bool> early_start{
+      remote->RequestStart(L"cancellation test", early_token)};
+  if (Expect(early_state.use_count() == 1,
+             "early handlers not released") == false ||
+      Expect(early_called == false, "early handler called") == false ||
+      Expect(early_start.IsReady(), "early start pending") == false ||
+      Expect(IsCancelled(early_start.Get().error),
+             "early start not cancelled") == false) {
+    return false;
+  }
+
+  PollAll(io_pool.get());
+  return Expect(remote->GetStats().requests_cancelled - start_cancelled == 5,
+                "requests cancelled miscounted");
+}
+}  // namespace ncstreamer_remote_test
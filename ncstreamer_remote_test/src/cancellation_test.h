@@ -0,0 +1,20 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_TEST_SRC_CANCELLATION_TEST_H_
+#define NCSTREAMER_REMOTE_TEST_SRC_CANCELLATION_TEST_H_
+
+
+namespace ncstreamer_remote_test {
+/// Cancels requests still queued on a manual io pool, and ones made with
+/// a token cancelled beforehand, and checks that their handlers are
+/// released without being called, and that their futures complete with
+/// Error::Connection::kCancelled.
+/// @return Whether it passes.
+bool TestCancellation();
+}  // namespace ncstreamer_remote_test
+
+
+#endif  // NCSTREAMER_REMOTE_TEST_SRC_CANCELLATION_TEST_H_
@@ -0,0 +1,110 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_test/src/keep_connected_test.h"
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+
+#include "ncstreamer_remote/io_pool.h"
+#include "ncstreamer_remote/ncstreamer_remote.h"
+#include "ncstreamer_remote/port_discovery.h"
+#include "ncstreamer_remote/simulated_clock.h"
+
+
+namespace {
+using ncstreamer_remote::IoPool;
+using ncstreamer_remote::NcStreamerRemote;
+using ncstreamer_remote::PortDiscovery;
+using ncstreamer_remote::SimulatedClock;
+
+
+/// Nothing listens on it, though without NCStreamer running,
+/// the attempts fail before connecting anyway.
+const std::uint16_t kIdlePort{59002};
+
+/// Of NcStreamerRemote, between failed attempts.
+const std::int64_t kReconnectIntervalNs{1000000000};
+
+const std::int64_t kRetries{5};
+
+
+/// @return The condition, telling what is wrong if false.
+bool Expect(bool condition, const char *what) {
+  if (condition == false) {
+    std::cerr << "keep connected: " << what << std::endl;
+  }
+  return condition;
+}
+
+
+void PollAll(IoPool *io_pool) {
+  while (io_pool->Poll() != 0) {
+    // the handlers may post more.
+  }
+}
+}  // namespace
+
+
+namespace ncstreamer_remote_test {
+bool TestKeepConnectedRetries() {
+  std::shared_ptr<IoPool> io_pool{IoPool::CreateManual()};
+  std::shared_ptr<SimulatedClock> clock{SimulatedClock::Create()};
+
+  PortDiscovery discovery{};
+  discovery.candidate_ports.emplace_back(kIdlePort);
+  std::unique_ptr<NcStreamerRemote> remote{
+      NcStreamerRemote::Create(discovery, io_pool, clock)};
+
+  bool ready{false};
+  remote->RegisterReadyHandler([&ready](bool success) {
+    ready = success;
+  });
+  PollAll(io_pool.get());
+  if (Expect(ready, "not set up") == false ||
+      Expect(clock->GetArmedTimerCount() == 1,
+             "no retry after the first attempt") == false) {
+    return false;
+  }
+
+  // one retry at a time.
+  std::int64_t start_ns = clock->NowNs();
+  std::uint64_t start_expired = clock->GetExpiredTimerCount();
+  for (std::int64_t i = 1; i <= kRetries; ++i) {
+    if (Expect(clock->AdvanceToNextTimer(), "no retry armed") == false) {
+      return false;
+    }
+    PollAll(io_pool.get());
+    if (Expect(clock->NowNs() - start_ns == i * kReconnectIntervalNs,
+               "retry off its interval") == false ||
+        Expect(clock->GetArmedTimerCount() == 1,
+               "no retry after a failed one") == false) {
+      return false;
+    }
+  }
+  if (Expect(clock->GetExpiredTimerCount() - start_expired == kRetries,
+             "retries other than the reconnects") == false) {
+    return false;
+  }
+
+  // many retries in one go, each armed from its own deadline.
+  start_ns = clock->NowNs();
+  start_expired = clock->GetExpiredTimerCount();
+  clock->AdvanceBy(
+      kRetries * kReconnectIntervalNs + kReconnectIntervalNs / 2,
+      io_pool.get());
+  if (Expect(clock->GetExpiredTimerCount() - start_expired == kRetries,
+             "retries skipped while advancing") == false ||
+      Expect(clock->AdvanceToNextTimer(), "no retry armed") == false ||
+      Expect(clock->NowNs() - start_ns ==
+                 (kRetries + 1) * kReconnectIntervalNs,
+             "retry armed from the end of the advance") == false) {
+    return false;
+  }
+  PollAll(io_pool.get());
+  return true;
+}
+}  // namespace ncstreamer_remote_test
@@ -0,0 +1,19 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_TEST_SRC_KEEP_CONNECTED_TEST_H_
+#define NCSTREAMER_REMOTE_TEST_SRC_KEEP_CONNECTED_TEST_H_
+
+
+namespace ncstreamer_remote_test {
+/// Drives the reconnect loop of an instance on a SimulatedClock and
+/// a manual io pool, without NCStreamer running, and checks that every
+/// failed attempt arms the next one a reconnect interval later.
+/// @return Whether it passes.
+bool TestKeepConnectedRetries();
+}  // namespace ncstreamer_remote_test
+
+
+#endif  // NCSTREAMER_REMOTE_TEST_SRC_KEEP_CONNECTED_TEST_H_
@@ -0,0 +1,45 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include <cstdlib>
+#include <iostream>
+
+#include "ncstreamer_remote_test/src/allocation_test.h"
+#include "ncstreamer_remote_test/src/cancellation_test.h"
+#include "ncstreamer_remote_test/src/keep_connected_test.h"
+#include "ncstreamer_remote_test/src/request_queue_test.h"
+#include "ncstreamer_remote_test/src/shutdown_test.h"
+
+
+namespace {
+struct Test {
+  const char *name;
+  bool (*run)();
+};
+
+
+const Test kTests[]{
+  {"submit allocations", ncstreamer_remote_test::TestSubmitAllocations},
+  {"keep connected retries", ncstreamer_remote_test::TestKeepConnectedRetries},
+  {"cancellation", ncstreamer_remote_test::TestCancellation},
+  {"blocked push on close", ncstreamer_remote_test::TestBlockedPushOnClose},
+  {"shutdown during discovery",
+   ncstreamer_remote_test::TestShutdownDuringDiscovery},
+};
+}  // namespace
+
+
+int main(int /*argc*/, char * /*argv*/[]) {
+  int failures{0};
+  for (const Test &test : kTests) {
+    bool passed = test.run();
+    std::cout << (passed == true ? "passed: " : "FAILED: ")
+              << test.name << std::endl;
+    if (passed == false) {
+      ++failures;
+    }
+  }
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
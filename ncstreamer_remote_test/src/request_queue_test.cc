@@ -0,0 +1,103 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_test/src/request_queue_test.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <iostream>
+#include <thread>  // NOLINT
+
+#include "ncstreamer_remote_dll/src/request_queue.h"
+
+#if _MSC_VER >= 1900
+namespace Chrono = std::chrono;
+#else
+#include "boost/chrono/include.hpp"
+namespace Chrono = boost::chrono;
+#endif  // _MSC_VER >= 1900
+
+
+namespace {
+using ncstreamer_remote::Error;
+using ncstreamer_remote::QueuedRequest;
+using ncstreamer_remote::RequestQueue;
+using MessageType = ncstreamer::RemoteMessage::MessageType;
+
+
+/// Long enough that the push is still waiting when the queue closes.
+const std::uint32_t kBlockTimeoutMs{10000};
+
+/// For the push to start waiting, which the queue doesn't tell.
+const std::int64_t kSettleMs{100};
+
+
+/// @return The condition, telling what is wrong if false.
+bool Expect(bool condition, const char *what) {
+  if (condition == false) {
+    std::cerr << "request queue: " << what << std::endl;
+  }
+  return condition;
+}
+
+
+QueuedRequest ToRequest(MessageType type) {
+  QueuedRequest request{};
+  request.type = type;
+  return request;
+}
+
+
+Error::Connection Push(RequestQueue *queue, MessageType type) {
+  QueuedRequest request = ToRequest(type);
+  QueuedRequest dropped{};
+  bool has_dropped{false};
+  return queue->Push(&request, &dropped, &has_dropped, true);
+}
+}  // namespace
+
+
+namespace ncstreamer_remote_test {
+bool TestBlockedPushOnClose() {
+  RequestQueue queue{
+      1, RequestQueue::OverflowPolicy::kBlock, kBlockTimeoutMs};
+  if (Expect(Push(&queue, MessageType::kStreamingStatusRequest) ==
+                 Error::Connection::kNoError,
+             "first push failed") == false) {
+    return false;
+  }
+
+  std::atomic_bool pushed{false};
+  Error::Connection blocked_result{Error::Connection::kNoError};
+  std::thread pusher{[&queue, &pushed, &blocked_result]() {
+    blocked_result = Push(&queue, MessageType::kStreamingStartRequest);
+    pushed = true;
+  }};
+  std::this_thread::sleep_for(std::chrono::milliseconds{kSettleMs});
+  bool waited = (pushed == false);
+
+  // as a close does: refuses the pushes, and then fails the queued ones.
+  auto closed_at = Chrono::steady_clock::now();
+  queue.Close();
+  QueuedRequest failed{};
+  while (queue.PopLeastUrgent(&failed, false) == true) {
+    failed = QueuedRequest{};
+  }
+  pusher.join();
+  auto waited_ms = Chrono::duration_cast<Chrono::milliseconds>(
+      Chrono::steady_clock::now() - closed_at).count();
+
+  return Expect(waited, "push didn't wait for room") == true &&
+         Expect(blocked_result == Error::Connection::kShutDown,
+                "blocked push not shut down") == true &&
+         Expect(waited_ms < static_cast<std::int64_t>(kBlockTimeoutMs / 2),
+                "blocked push waited out its timeout") == true &&
+         Expect(queue.size() == 0, "pushed after the close") == true &&
+         Expect(Push(&queue, MessageType::kStreamingStopRequest) ==
+                    Error::Connection::kShutDown,
+                "push after the close not shut down") == true;
+}
+}  // namespace ncstreamer_remote_test
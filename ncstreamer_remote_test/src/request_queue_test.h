@@ -0,0 +1,19 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_TEST_SRC_REQUEST_QUEUE_TEST_H_
+#define NCSTREAMER_REMOTE_TEST_SRC_REQUEST_QUEUE_TEST_H_
+
+
+namespace ncstreamer_remote_test {
+/// Blocks a push on a full queue of OverflowPolicy::kBlock, closes the
+/// queue and frees room as a close does, and checks that the push fails
+/// with Error::Connection::kShutDown rather than taking the room.
+/// @return Whether it passes.
+bool TestBlockedPushOnClose();
+}  // namespace ncstreamer_remote_test
+
+
+#endif  // NCSTREAMER_REMOTE_TEST_SRC_REQUEST_QUEUE_TEST_H_
@@ -0,0 +1,185 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#include "ncstreamer_remote_test/src/shutdown_test.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "boost/asio.hpp"
+
+#include "Windows.h"  // NOLINT
+
+#include "ncstreamer_remote/io_pool.h"
+#include "ncstreamer_remote/ncstreamer_remote.h"
+#include "ncstreamer_remote/port_discovery.h"
+#include "ncstreamer_remote/remote_future.h"
+
+#include "ncstreamer_remote_dll/src/ncstreamer_remote_message_types.h"
+
+#if _MSC_VER >= 1900
+namespace Chrono = std::chrono;
+#else
+#include "boost/chrono/include.hpp"
+namespace Chrono = boost::chrono;
+#endif  // _MSC_VER >= 1900
+
+
+namespace {
+using ncstreamer_remote::Error;
+using ncstreamer_remote::ErrorCategory;
+using ncstreamer_remote::IoPool;
+using ncstreamer_remote::NcStreamerRemote;
+using ncstreamer_remote::PortDiscovery;
+using ncstreamer_remote::RemoteError;
+using ncstreamer_remote::RemoteFuture;
+
+
+/// Accepts connections into its backlog, and never answers a handshake.
+const std::uint16_t kSilentPort{59004};
+
+/// Far beyond the waits below, so that only a shutdown ends the discovery.
+const std::uint32_t kProbeTimeoutMs{60000};
+
+const std::uint32_t kCloseDeadlineMs{2000};
+const std::uint32_t kWaitTimeoutMs{5000};
+
+
+/// @return The condition, telling what is wrong if false.
+bool Expect(bool condition, const char *what) {
+  if (condition == false) {
+    std::cerr << "shutdown: " << what << std::endl;
+  }
+  return condition;
+}
+
+
+/// @return Whether the instance has started a discovery in time.
+bool WaitForDiscovery(const NcStreamerRemote &remote) {
+  auto deadline = Chrono::steady_clock::now() +
+      Chrono::milliseconds{kWaitTimeoutMs};
+  while (remote.GetStats().port_discoveries == 0) {
+    if (Chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+
+/// Deletes the instance on another thread, which is left behind
+/// if the destructor hangs, keeping the io pool of the instance.
+/// @return Whether the instance is deleted in time.
+bool DestroyInTime(
+    std::unique_ptr<NcStreamerRemote> &&remote,
+    const std::shared_ptr<IoPool> &io_pool) {
+  std::shared_ptr<std::atomic_bool> destroyed{
+      std::make_shared<std::atomic_bool>(false)};
+  NcStreamerRemote *raw = remote.release();
+  std::thread destroyer{[raw, io_pool, destroyed]() {
+    delete raw;
+    *destroyed = true;
+  }};
+
+  auto deadline = Chrono::steady_clock::now() +
+      Chrono::milliseconds{kWaitTimeoutMs};
+  while (*destroyed == false) {
+    if (Chrono::steady_clock::now() > deadline) {
+      destroyer.detach();
+      return false;
+    }
+    std::this_thread::yield();
+  }
+  destroyer.join();
+  return true;
+}
+
+
+bool IsShutDown(const RemoteError &error) {
+  return error.category == ErrorCategory::kConnection &&
+         error.err_code == static_cast<int>(Error::Connection::kShutDown);
+}
+}  // namespace
+
+
+namespace ncstreamer_remote_test {
+bool TestShutdownDuringDiscovery() {
+  // the instances look for the window before discovering.
+  HWND window = ::CreateWindowEx(
+      0,
+      L"STATIC",
+      ncstreamer::kNcStreamerWindowTitle,
+      0,  // never shown.
+      0,
+      0,
+      0,
+      0,
+      NULL,
+      NULL,
+      ::GetModuleHandle(NULL),
+      NULL);
+  if (Expect(window != NULL, "no window") == false) {
+    return false;
+  }
+
+  boost::asio::io_service silent_service{};
+  boost::asio::ip::tcp::acceptor silent_acceptor{
+      silent_service,
+      boost::asio::ip::tcp::endpoint{
+          boost::asio::ip::address_v4::loopback(), kSilentPort}};
+
+  PortDiscovery discovery{};
+  discovery.candidate_ports.emplace_back(kSilentPort);
+  discovery.candidate_ports.emplace_back(kSilentPort + 1);
+  discovery.probe_timeout_ms = kProbeTimeoutMs;
+  std::shared_ptr<IoPool> io_pool{IoPool::Create(1)};
+
+  bool passed{true};
+
+  // closed, with a request waiting for the connection.
+  {
+    std::unique_ptr<NcStreamerRemote> remote{
+        NcStreamerRemote::Create(discovery, io_pool)};
+    if (Expect(WaitForDiscovery(*remote), "no discovery") == false) {
+      passed = false;
+    } else {
+      RemoteFuture<bool> start{remote->RequestStart(L"shutdown test")};
+      if (Expect(remote->Close(kCloseDeadlineMs, false),
+                 "close waited out its deadline") == false ||
+          Expect(start.IsReady(), "pending start not failed") == false ||
+          Expect(IsShutDown(start.Get().error),
+                 "pending start not shut down") == false) {
+        passed = false;
+      }
+    }
+    if (Expect(DestroyInTime(std::move(remote), io_pool),
+               "closed instance not destroyed") == false) {
+      passed = false;
+    }
+  }
+
+  // destroyed without a close.
+  {
+    std::unique_ptr<NcStreamerRemote> remote{
+        NcStreamerRemote::Create(discovery, io_pool)};
+    if (Expect(WaitForDiscovery(*remote), "no discovery") == false) {
+      passed = false;
+    }
+    if (Expect(DestroyInTime(std::move(remote), io_pool),
+               "instance not destroyed") == false) {
+      passed = false;
+    }
+  }
+
+  ::DestroyWindow(window);
+  return passed;
+}
+}  // namespace ncstreamer_remote_test
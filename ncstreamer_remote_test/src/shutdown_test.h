@@ -0,0 +1,19 @@
+/**
+ * Copyright (C) 2017 NCSOFT Corporation
+ */
+
+
+#ifndef NCSTREAMER_REMOTE_TEST_SRC_SHUTDOWN_TEST_H_
+#define NCSTREAMER_REMOTE_TEST_SRC_SHUTDOWN_TEST_H_
+
+
+namespace ncstreamer_remote_test {
+/// Closes and destroys instances on a shared io pool while they are
+/// still discovering the port of NCStreamer, whose probes never get
+/// an answer, and checks that neither waits for the probe timeout.
+/// @return Whether it passes.
+bool TestShutdownDuringDiscovery();
+}  // namespace ncstreamer_remote_test
+
+
+#endif  // NCSTREAMER_REMOTE_TEST_SRC_SHUTDOWN_TEST_H_